@@ -0,0 +1,9 @@
+// Host-side stand-in for AkWwiseSDKVersion.h.
+
+#pragma once
+
+#define AK_WWISESDK_VERSION_MAJOR       2023
+#define AK_WWISESDK_VERSION_MINOR       1
+#define AK_WWISESDK_VERSION_SUBMINOR    0
+#define AK_WWISESDK_VERSION_BUILD       0
+#define AK_WWISESDK_VERSION_COMBINED    ((AK_WWISESDK_VERSION_MAJOR << 8) | AK_WWISESDK_VERSION_MINOR)
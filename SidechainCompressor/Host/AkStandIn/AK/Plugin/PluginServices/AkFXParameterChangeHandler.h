@@ -0,0 +1,54 @@
+// Host-side stand-in for AkFXParameterChangeHandler.h.
+
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+namespace AK
+{
+    template <AkUInt32 T_MAXNUMPARAMS>
+    class AkFXParameterChangeHandler
+    {
+    public:
+        AkFXParameterChangeHandler() { ResetAllParamChanges(); }
+
+        void SetParamChange(AkPluginParamID in_ID)
+        {
+            m_uParamBitArray[in_ID / 32] |= (1u << (in_ID % 32));
+        }
+
+        bool HasChanged(AkPluginParamID in_ID) const
+        {
+            return (m_uParamBitArray[in_ID / 32] & (1u << (in_ID % 32))) != 0;
+        }
+
+        bool HasAnyChanged() const
+        {
+            for (AkUInt32 i = 0; i < kNumWords; ++i)
+                if (m_uParamBitArray[i])
+                    return true;
+            return false;
+        }
+
+        void ResetParamChange(AkPluginParamID in_ID)
+        {
+            m_uParamBitArray[in_ID / 32] &= ~(1u << (in_ID % 32));
+        }
+
+        void ResetAllParamChanges()
+        {
+            for (AkUInt32 i = 0; i < kNumWords; ++i)
+                m_uParamBitArray[i] = 0;
+        }
+
+        void SetAllParamChanges()
+        {
+            for (AkUInt32 i = 0; i < kNumWords; ++i)
+                m_uParamBitArray[i] = 0xFFFFFFFF;
+        }
+
+    private:
+        static const AkUInt32 kNumWords = (T_MAXNUMPARAMS + 31) / 32;
+        AkUInt32 m_uParamBitArray[kNumWords];
+    };
+}
@@ -0,0 +1,5 @@
+// Host-side stand-in for AkCallback.h.
+
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
@@ -0,0 +1,148 @@
+// Host-side stand-in for AkCommonDefs.h: channel configuration, audio format and
+// the deinterleaved AkAudioBuffer the plug-in reads and writes.
+
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <cmath>
+
+#define AK_DBTOLIN( __db__ ) (powf(10.f, (__db__) * 0.05f))
+
+#define AK_SPEAKER_FRONT_LEFT       0x1
+#define AK_SPEAKER_FRONT_RIGHT      0x2
+#define AK_SPEAKER_FRONT_CENTER     0x4
+#define AK_SPEAKER_LOW_FREQUENCY    0x8
+#define AK_SPEAKER_BACK_LEFT        0x10
+#define AK_SPEAKER_BACK_RIGHT       0x20
+#define AK_SPEAKER_SIDE_LEFT        0x200
+#define AK_SPEAKER_SIDE_RIGHT       0x400
+#define AK_SPEAKER_TOP_FRONT_LEFT   0x1000
+#define AK_SPEAKER_TOP_FRONT_RIGHT  0x4000
+#define AK_SPEAKER_TOP_BACK_LEFT    0x8000
+#define AK_SPEAKER_TOP_BACK_RIGHT   0x20000
+
+#define AK_SPEAKER_SETUP_MONO       AK_SPEAKER_FRONT_CENTER
+#define AK_SPEAKER_SETUP_STEREO     (AK_SPEAKER_FRONT_LEFT | AK_SPEAKER_FRONT_RIGHT)
+#define AK_SPEAKER_SETUP_5_1        (AK_SPEAKER_SETUP_STEREO | AK_SPEAKER_FRONT_CENTER | AK_SPEAKER_LOW_FREQUENCY | AK_SPEAKER_SIDE_LEFT | AK_SPEAKER_SIDE_RIGHT)
+#define AK_SPEAKER_SETUP_7_1        (AK_SPEAKER_SETUP_5_1 | AK_SPEAKER_BACK_LEFT | AK_SPEAKER_BACK_RIGHT)
+#define AK_SPEAKER_SETUP_DOLBY_7_1_4 (AK_SPEAKER_SETUP_7_1 | AK_SPEAKER_TOP_FRONT_LEFT | AK_SPEAKER_TOP_FRONT_RIGHT | AK_SPEAKER_TOP_BACK_LEFT | AK_SPEAKER_TOP_BACK_RIGHT)
+
+enum AkChannelConfigType
+{
+    AK_ChannelConfigType_Anonymous = 0x0,
+    AK_ChannelConfigType_Standard = 0x1,
+    AK_ChannelConfigType_Ambisonic = 0x2,
+};
+
+struct AkChannelConfig
+{
+    AkUInt32 uNumChannels : 8;
+    AkUInt32 eConfigType : 4;
+    AkUInt32 uChannelMask : 20;
+
+    AkChannelConfig() : uNumChannels(0), eConfigType(0), uChannelMask(0) {}
+
+    AkChannelConfig(AkUInt32 in_uNumChannels, AkUInt32 in_uChannelMask)
+        : uNumChannels(in_uNumChannels)
+        , eConfigType(in_uChannelMask ? AK_ChannelConfigType_Standard : AK_ChannelConfigType_Anonymous)
+        , uChannelMask(in_uChannelMask)
+    {
+    }
+
+    void SetStandard(AkUInt32 in_uChannelMask)
+    {
+        uNumChannels = 0;
+        for (AkUInt32 mask = in_uChannelMask; mask; mask &= mask - 1)
+            ++uNumChannels;
+        eConfigType = AK_ChannelConfigType_Standard;
+        uChannelMask = in_uChannelMask;
+    }
+
+    void SetAnonymous(AkUInt32 in_uNumChannels)
+    {
+        uNumChannels = in_uNumChannels;
+        eConfigType = AK_ChannelConfigType_Anonymous;
+        uChannelMask = 0;
+    }
+
+    void SetAmbisonic(AkUInt32 in_uNumChannels)
+    {
+        uNumChannels = in_uNumChannels;
+        eConfigType = AK_ChannelConfigType_Ambisonic;
+        uChannelMask = 0;
+    }
+
+    bool IsValid() const { return uNumChannels != 0; }
+};
+
+struct AkAudioFormat
+{
+    AkUInt32 uSampleRate = 48000;
+    AkChannelConfig channelConfig;
+    AkUInt32 uBitsPerSample = 32;
+    AkUInt32 uBlockAlign = 4;
+    AkUInt32 uTypeID = 1;
+    AkUInt32 uInterleaveID = 0;
+
+    AkUInt32 GetNumChannels() const { return channelConfig.uNumChannels; }
+};
+
+/// Deinterleaved float buffer. Channels are stored back to back, MaxFrames() apart.
+class AkAudioBuffer
+{
+public:
+    AkAudioBuffer() { Clear(); }
+
+    void Clear()
+    {
+        pData = nullptr;
+        uValidFrames = 0;
+        uMaxFrames = 0;
+        eState = AK_DataNeeded;
+        channelConfig = AkChannelConfig();
+    }
+
+    AkUInt32 NumChannels() const { return channelConfig.uNumChannels; }
+    AkChannelConfig GetChannelConfig() const { return channelConfig; }
+    AkUInt16 MaxFrames() const { return uMaxFrames; }
+    bool HasLFE() const { return (channelConfig.uChannelMask & AK_SPEAKER_LOW_FREQUENCY) != 0; }
+
+    AkReal32* GetChannel(AkUInt32 in_uIndex)
+    {
+        return (AkReal32*)pData + (size_t)in_uIndex * uMaxFrames;
+    }
+
+    void AttachContiguousDeinterleavedData(void* in_pData, AkUInt16 in_uMaxFrames, AkUInt16 in_uValidFrames, AkChannelConfig in_channelConfig)
+    {
+        pData = in_pData;
+        uMaxFrames = in_uMaxFrames;
+        uValidFrames = in_uValidFrames;
+        channelConfig = in_channelConfig;
+    }
+
+    void* DetachContiguousDeinterleavedData()
+    {
+        void* pDetached = pData;
+        Clear();
+        return pDetached;
+    }
+
+    void ZeroPadToMaxFrames()
+    {
+        for (AkUInt32 i = 0; i < NumChannels(); ++i)
+        {
+            AkReal32* pChannel = GetChannel(i);
+            for (AkUInt32 frame = uValidFrames; frame < uMaxFrames; ++frame)
+                pChannel[frame] = 0.0f;
+        }
+        uValidFrames = uMaxFrames;
+    }
+
+    AKRESULT eState;
+    AkUInt16 uValidFrames;
+
+protected:
+    void* pData;
+    AkChannelConfig channelConfig;
+    AkUInt16 uMaxFrames;
+};
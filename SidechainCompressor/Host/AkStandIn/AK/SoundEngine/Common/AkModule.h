@@ -0,0 +1,5 @@
+// Host-side stand-in for AkModule.h.
+
+#pragma once
+
+#include <AK/SoundEngine/Common/IAkPlugin.h>
@@ -0,0 +1,6 @@
+// Host-side stand-in for AkSoundEngine.h.
+
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <AK/SoundEngine/Common/IAkPlugin.h>
@@ -0,0 +1,76 @@
+// Host-side stand-in for the subset of the Wwise SDK used by the SoundEnginePlugin.
+// Only what the plug-in actually touches is declared here; names and signatures
+// follow the real SDK so the plug-in sources compile unchanged against either.
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+typedef uint8_t     AkUInt8;
+typedef uint16_t    AkUInt16;
+typedef uint32_t    AkUInt32;
+typedef uint64_t    AkUInt64;
+typedef int8_t      AkInt8;
+typedef int16_t     AkInt16;
+typedef int32_t     AkInt32;
+typedef int64_t     AkInt64;
+typedef float       AkReal32;
+typedef double      AkReal64;
+
+typedef AkUInt32    AkUniqueID;
+typedef AkUInt32    AkPluginID;
+typedef AkInt16     AkPluginParamID;
+typedef AkInt32     AkTimeMs;
+typedef AkUInt64    AkGameObjectID;
+
+#define AK_RESTRICT __restrict
+#define AKSOUNDENGINE_CALL
+#define AK_ALIGN_SIMD(...) alignas(16) __VA_ARGS__
+
+#define AkMin(x1, x2) (((x1) < (x2)) ? (x1) : (x2))
+#define AkMax(x1, x2) (((x1) > (x2)) ? (x1) : (x2))
+
+enum AKRESULT
+{
+    AK_NotImplemented = 0,
+    AK_Success = 1,
+    AK_Fail = 2,
+    AK_PartialSuccess = 3,
+    AK_NotCompatible = 4,
+    AK_AlreadyConnected = 5,
+    AK_NoMoreData = 17,
+    AK_InvalidParameter = 31,
+    AK_InsufficientMemory = 52,
+    AK_DataNeeded = 43,
+    AK_DataReady = 45,
+};
+
+enum AkPluginType
+{
+    AkPluginTypeNone = 0,
+    AkPluginTypeCodec = 1,
+    AkPluginTypeSource = 2,
+    AkPluginTypeEffect = 3,
+    AkPluginTypeMixer = 6,
+    AkPluginTypeSink = 7,
+    AkPluginTypeGlobalExtension = 8,
+    AkPluginTypeMetadata = 9,
+};
+
+enum AkGlobalCallbackLocation
+{
+    AkGlobalCallbackLocation_Register = (1 << 0),
+    AkGlobalCallbackLocation_Begin = (1 << 1),
+    AkGlobalCallbackLocation_PreProcessMessageQueueForRender = (1 << 2),
+    AkGlobalCallbackLocation_PostMessagesProcessed = (1 << 3),
+    AkGlobalCallbackLocation_BeginRender = (1 << 4),
+    AkGlobalCallbackLocation_EndRender = (1 << 5),
+    AkGlobalCallbackLocation_End = (1 << 6),
+    AkGlobalCallbackLocation_Term = (1 << 7),
+    AkGlobalCallbackLocation_Monitor = (1 << 8),
+    AkGlobalCallbackLocation_MonitorRecap = (1 << 9),
+    AkGlobalCallbackLocation_Init = (1 << 10),
+    AkGlobalCallbackLocation_Suspend = (1 << 11),
+    AkGlobalCallbackLocation_WakeupFromSuspend = (1 << 12),
+};
@@ -0,0 +1,186 @@
+// Host-side stand-in for IAkPlugin.h: allocator, parameter node, effect plug-in
+// and context interfaces, plus the registration macros the plug-in expands.
+
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+#include <new>
+
+namespace AK
+{
+    class IAkGlobalPluginContext;
+    class IAkPluginParam;
+    class IAkPlugin;
+}
+
+typedef void(AKSOUNDENGINE_CALL* AkGlobalCallbackFunc)(
+    AK::IAkGlobalPluginContext* in_pContext,
+    AkGlobalCallbackLocation in_eLocation,
+    void* in_pCookie);
+
+struct AkPluginInfo
+{
+    AkPluginType eType = AkPluginTypeNone;
+    bool bIsInPlace = true;
+    bool bCanChangeRate = false;
+    bool bReserved = false;
+    bool bIsDeviceEffect = false;
+    bool bCanProcessObjects = false;
+    bool bCanRunOnObjectConfig = true;
+    bool bUsesGainAttribute = false;
+    AkUInt32 uBuildVersion = 0;
+};
+
+namespace AK
+{
+    class IAkPluginMemAlloc
+    {
+    protected:
+        virtual ~IAkPluginMemAlloc() {}
+
+    public:
+        virtual void* Malloc(size_t in_uSize, const char* in_pszFile, AkUInt32 in_uLine) = 0;
+        virtual void Free(void* in_pMemAddress) = 0;
+        virtual void* Malign(size_t in_uSize, size_t in_uAlignment, const char* in_pszFile, AkUInt32 in_uLine) = 0;
+        virtual void FreeAligned(void* in_pMemAddress) = 0;
+    };
+
+    class IAkGlobalPluginContext
+    {
+    protected:
+        virtual ~IAkGlobalPluginContext() {}
+
+    public:
+        virtual AKRESULT RegisterGlobalCallback(
+            AkPluginType in_eType,
+            AkUInt32 in_ulCompanyID,
+            AkUInt32 in_ulPluginID,
+            AkGlobalCallbackFunc in_pCallback,
+            AkUInt32 in_eLocation = AkGlobalCallbackLocation_BeginRender,
+            void* in_pCookie = nullptr) = 0;
+
+        virtual AKRESULT UnregisterGlobalCallback(
+            AkGlobalCallbackFunc in_pCallback,
+            AkUInt32 in_eLocation = AkGlobalCallbackLocation_BeginRender) = 0;
+
+        virtual IAkPluginMemAlloc* GetAllocator() = 0;
+        virtual AkUInt16 GetMaxBufferLength() const = 0;
+        virtual AkUInt32 GetSampleRate() const = 0;
+    };
+
+    class IAkPluginContextBase
+    {
+    protected:
+        virtual ~IAkPluginContextBase() {}
+
+    public:
+        virtual IAkGlobalPluginContext* GlobalContext() const = 0;
+        virtual AkUniqueID GetAudioNodeID() const = 0;
+        virtual AkUInt16 GetMaxBufferLength() const = 0;
+        virtual bool CanPostMonitorData() = 0;
+        virtual AKRESULT PostMonitorData(void* in_pData, AkUInt32 in_uDataSize) = 0;
+    };
+
+    class IAkEffectPluginContext : public IAkPluginContextBase
+    {
+    protected:
+        virtual ~IAkEffectPluginContext() {}
+
+    public:
+        virtual bool IsSendModeEffect() const = 0;
+    };
+
+    class IAkPluginParam
+    {
+    protected:
+        virtual ~IAkPluginParam() {}
+
+    public:
+        virtual IAkPluginParam* Clone(IAkPluginMemAlloc* in_pAllocator) = 0;
+        virtual AKRESULT Init(IAkPluginMemAlloc* in_pAllocator, const void* in_pParamsBlock, AkUInt32 in_uBlockSize) = 0;
+        virtual AKRESULT Term(IAkPluginMemAlloc* in_pAllocator) = 0;
+        virtual AKRESULT SetParamsBlock(const void* in_pParamsBlock, AkUInt32 in_uBlockSize) = 0;
+        virtual AKRESULT SetParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_uParamSize) = 0;
+    };
+
+    class IAkPlugin
+    {
+    protected:
+        virtual ~IAkPlugin() {}
+
+    public:
+        virtual AKRESULT Term(IAkPluginMemAlloc* in_pAllocator) = 0;
+        virtual AKRESULT Reset() = 0;
+        virtual AKRESULT GetPluginInfo(AkPluginInfo& out_rPluginInfo) = 0;
+    };
+
+    class IAkEffectPlugin : public IAkPlugin
+    {
+    public:
+        virtual AKRESULT Init(IAkPluginMemAlloc* in_pAllocator, IAkEffectPluginContext* in_pEffectPluginContext, IAkPluginParam* in_pParams, AkAudioFormat& io_rFormat) = 0;
+    };
+
+    class IAkOutOfPlaceEffectPlugin : public IAkEffectPlugin
+    {
+    public:
+        virtual void Execute(AkAudioBuffer* in_pBuffer, AkUInt32 in_uInOffset, AkAudioBuffer* out_pBuffer) = 0;
+        virtual AKRESULT TimeSkip(AkUInt32& io_uFrames) = 0;
+    };
+
+    typedef IAkPlugin* (*AkCreatePluginCallback)(IAkPluginMemAlloc* in_pAllocator);
+    typedef IAkPluginParam* (*AkCreateParamCallback)(IAkPluginMemAlloc* in_pAllocator);
+
+    struct PluginRegistration
+    {
+        PluginRegistration(AkPluginType in_eType, AkUInt32 in_ulCompanyID, AkUInt32 in_ulPluginID,
+            AkCreatePluginCallback in_pCreateFunc, AkCreateParamCallback in_pCreateParamFunc)
+            : eType(in_eType), ulCompanyID(in_ulCompanyID), ulPluginID(in_ulPluginID)
+            , pCreateFunc(in_pCreateFunc), pCreateParamFunc(in_pCreateParamFunc)
+        {
+        }
+
+        AkPluginType eType;
+        AkUInt32 ulCompanyID;
+        AkUInt32 ulPluginID;
+        AkCreatePluginCallback pCreateFunc;
+        AkCreateParamCallback pCreateParamFunc;
+    };
+
+    template <class T>
+    inline void AkPluginDelete(IAkPluginMemAlloc* in_pAllocator, T* in_pObject)
+    {
+        if (in_pObject)
+        {
+            in_pObject->~T();
+            in_pAllocator->Free(in_pObject);
+        }
+    }
+}
+
+inline void* operator new(size_t in_uSize, AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    return in_pAllocator->Malloc(in_uSize, __FILE__, __LINE__);
+}
+
+inline void operator delete(void*, AK::IAkPluginMemAlloc*)
+{
+}
+
+#define AK_PLUGIN_NEW(_allocator, _what) new(_allocator) _what
+#define AK_PLUGIN_DELETE(_allocator, _what) AK::AkPluginDelete((_allocator), (_what))
+#define AK_PLUGIN_ALLOC(_allocator, _size) (_allocator)->Malloc((_size), __FILE__, __LINE__)
+#define AK_PLUGIN_ALLOC_ALIGN(_allocator, _size, _align) (_allocator)->Malign((_size), (_align), __FILE__, __LINE__)
+#define AK_PLUGIN_FREE(_allocator, _pvmem) (_allocator)->Free((_pvmem))
+#define AK_PLUGIN_FREE_ALIGN(_allocator, _pvmem) (_allocator)->FreeAligned((_pvmem))
+
+#define AK_IMPLEMENT_PLUGIN_FACTORY(_pluginName_, _plugintype_, _companyid_, _pluginid_) \
+    AK::IAkPlugin* Create##_pluginName_(AK::IAkPluginMemAlloc* in_pAllocator); \
+    AK::IAkPluginParam* Create##_pluginName_##Params(AK::IAkPluginMemAlloc* in_pAllocator); \
+    AK::PluginRegistration _pluginName_##Registration(_plugintype_, _companyid_, _pluginid_, Create##_pluginName_, Create##_pluginName_##Params);
+
+#define AK_STATIC_LINK_PLUGIN(_pluginName_) \
+    extern AK::PluginRegistration _pluginName_##Registration; \
+    inline void* _pluginName_##_linkonceonly = (void*)&_pluginName_##Registration;
+
+#define DEFINE_PLUGIN_REGISTER_HOOK
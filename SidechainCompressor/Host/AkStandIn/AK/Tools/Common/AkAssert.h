@@ -0,0 +1,9 @@
+// Host-side stand-in for AkAssert.h.
+
+#pragma once
+
+#include <cassert>
+
+#define AKASSERT(Condition) assert(Condition)
+#define AKVERIFY(x) ((void)(x))
+#define DEFINEDUMMYASSERTHOOK
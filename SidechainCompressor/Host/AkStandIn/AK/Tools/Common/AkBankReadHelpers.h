@@ -0,0 +1,27 @@
+// Host-side stand-in for AkBankReadHelpers.h.
+
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <cstring>
+
+namespace AK
+{
+    template <typename T>
+    inline T ReadBankData(AkUInt8*& io_rptr, AkUInt32& io_rSize)
+    {
+        T value;
+        memcpy(&value, io_rptr, sizeof(T));
+        io_rptr += sizeof(T);
+        io_rSize -= sizeof(T);
+        return value;
+    }
+}
+
+#define READBANKDATA(_Type, _Ptr, _Size) AK::ReadBankData<_Type>(_Ptr, _Size)
+
+#define CHECKBANKDATASIZE(_DATASIZE_, _RESULT_) \
+    if ((_DATASIZE_) != 0) \
+    { \
+        (_RESULT_) = AK_Fail; \
+    }
@@ -0,0 +1,2183 @@
+// Host-side microbenchmarks for the SoundEnginePlugin hot paths.
+//
+// Drives SidechainCompressorFX::Execute for N instances sharing one sidechain bus,
+// then times the shared buffer entry points on their own. Heap allocations are counted
+// (operator new and the plug-in allocator) to check the render path never allocates. Usage:
+//
+//   SidechainCompressorBenchmark [--instances 1,8,64] [--frames 256,1024] [--min-time 0.25] [--control-rate 1]
+
+#include "SidechainCompressorHostContext.h"
+#include "SidechainCompressorHostWav.h"
+#include "SidechainCompressorReference.h"
+#include "../SoundEnginePlugin/SidechainCompressorFX.h"
+#include "../SoundEnginePlugin/SidechainCompressorDetector.h"
+#include "../SoundEnginePlugin/SidechainCompressorGainKernel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every global heap allocation in the process goes through here: each form of operator new
+// is replaced, so none of them reaches the default allocator uncounted, and each form of
+// operator delete releases through the same function.
+static std::atomic<AkUInt64> g_uNumHeapAllocs(0);
+
+static void* countedAlloc(size_t in_uSize, size_t in_uAlignment) noexcept
+{
+    g_uNumHeapAllocs.fetch_add(1, std::memory_order_relaxed);
+    in_uSize = in_uSize ? in_uSize : 1;
+    if (in_uAlignment <= alignof(std::max_align_t))
+        return malloc(in_uSize);
+    // aligned_alloc wants a whole number of alignments
+    return aligned_alloc(in_uAlignment, (in_uSize + in_uAlignment - 1) / in_uAlignment * in_uAlignment);
+}
+
+static void* countedAllocOrThrow(size_t in_uSize, size_t in_uAlignment)
+{
+    if (void* p = countedAlloc(in_uSize, in_uAlignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+static void countedFree(void* in_p) noexcept
+{
+    free(in_p);
+}
+
+void* operator new(size_t in_uSize) { return countedAllocOrThrow(in_uSize, 0); }
+void* operator new[](size_t in_uSize) { return countedAllocOrThrow(in_uSize, 0); }
+void* operator new(size_t in_uSize, std::align_val_t in_alignment) { return countedAllocOrThrow(in_uSize, (size_t)in_alignment); }
+void* operator new[](size_t in_uSize, std::align_val_t in_alignment) { return countedAllocOrThrow(in_uSize, (size_t)in_alignment); }
+void* operator new(size_t in_uSize, const std::nothrow_t&) noexcept { return countedAlloc(in_uSize, 0); }
+void* operator new[](size_t in_uSize, const std::nothrow_t&) noexcept { return countedAlloc(in_uSize, 0); }
+void* operator new(size_t in_uSize, std::align_val_t in_alignment, const std::nothrow_t&) noexcept { return countedAlloc(in_uSize, (size_t)in_alignment); }
+void* operator new[](size_t in_uSize, std::align_val_t in_alignment, const std::nothrow_t&) noexcept { return countedAlloc(in_uSize, (size_t)in_alignment); }
+
+void operator delete(void* in_p) noexcept { countedFree(in_p); }
+void operator delete[](void* in_p) noexcept { countedFree(in_p); }
+void operator delete(void* in_p, size_t) noexcept { countedFree(in_p); }
+void operator delete[](void* in_p, size_t) noexcept { countedFree(in_p); }
+void operator delete(void* in_p, std::align_val_t) noexcept { countedFree(in_p); }
+void operator delete[](void* in_p, std::align_val_t) noexcept { countedFree(in_p); }
+void operator delete(void* in_p, size_t, std::align_val_t) noexcept { countedFree(in_p); }
+void operator delete[](void* in_p, size_t, std::align_val_t) noexcept { countedFree(in_p); }
+void operator delete(void* in_p, const std::nothrow_t&) noexcept { countedFree(in_p); }
+void operator delete[](void* in_p, const std::nothrow_t&) noexcept { countedFree(in_p); }
+void operator delete(void* in_p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(in_p); }
+void operator delete[](void* in_p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(in_p); }
+
+AK::IAkPlugin* CreateSidechainCompressorFX(AK::IAkPluginMemAlloc* in_pAllocator);
+AK::IAkPluginParam* CreateSidechainCompressorFXParams(AK::IAkPluginMemAlloc* in_pAllocator);
+
+namespace
+{
+    const AkUInt32 kSampleRate = 48000;
+    const AkUInt32 kNumChannels = 2;
+
+    struct Options
+    {
+        std::vector<AkUInt32> instances = { 1, 8, 64, 256, 1024 };
+        std::vector<AkUInt32> frames = { 256, 1024 };
+        double minTime = 0.25;
+        AkInt32 controlRate = 1;
+    };
+
+    std::vector<AkUInt32> parseList(const char* in_pszList)
+    {
+        std::vector<AkUInt32> values;
+        std::string list(in_pszList);
+        size_t pos = 0;
+        while (pos < list.size())
+        {
+            size_t next = list.find(',', pos);
+            if (next == std::string::npos)
+                next = list.size();
+            values.push_back((AkUInt32)strtoul(list.substr(pos, next - pos).c_str(), nullptr, 10));
+            pos = next + 1;
+        }
+        return values;
+    }
+
+    bool parseOptions(int argc, char** argv, Options& out_options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (i + 1 < argc && strcmp(argv[i], "--instances") == 0)
+                out_options.instances = parseList(argv[++i]);
+            else if (i + 1 < argc && strcmp(argv[i], "--frames") == 0)
+                out_options.frames = parseList(argv[++i]);
+            else if (i + 1 < argc && strcmp(argv[i], "--min-time") == 0)
+                out_options.minTime = atof(argv[++i]);
+            else if (i + 1 < argc && strcmp(argv[i], "--control-rate") == 0)
+                out_options.controlRate = atoi(argv[++i]);
+            else
+            {
+                fprintf(stderr, "usage: %s [--instances 1,8,64] [--frames 256,1024] [--min-time seconds] [--control-rate 1|8|16|32|64]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Deterministic test signal: a different tone per instance plus a little noise.
+    void fillSignal(AkAudioBuffer& io_buffer, AkUInt32 in_uInstance, AkUInt32 in_uFrames, AkReal32 in_fLevel = 1.0f)
+    {
+        AkUInt32 seed = 0x9E3779B9u * (in_uInstance + 1);
+        AkReal32 freq = 110.0f * (1.0f + (in_uInstance % 16));
+        for (AkUInt32 channel = 0; channel < io_buffer.NumChannels(); ++channel)
+        {
+            AkReal32* pChannel = io_buffer.GetChannel(channel);
+            for (AkUInt32 frame = 0; frame < in_uFrames; ++frame)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                AkReal32 noise = ((seed >> 8) / 16777216.0f - 0.5f) * 0.05f;
+                pChannel[frame] = in_fLevel * (0.25f * sinf(6.2831853f * freq * frame / kSampleRate) + noise);
+            }
+        }
+    }
+
+    class Timer
+    {
+    public:
+        Timer() : start(std::chrono::steady_clock::now()) {}
+
+        double Seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// N plug-in instances on one global context, each with its own input and output buffer.
+    /// Instance i feeds and listens to sidechain group i % in_uNumGroups.
+    /// in_configure, when set, adjusts each instance's parameters before its Init.
+    /// The engine runs at in_uSampleRate, kSampleRate unless given.
+    class InstanceSet
+    {
+    public:
+        InstanceSet(AkUInt32 in_uNumInstances, AkUInt16 in_uFrames, AkInt32 in_iControlRate = 1,
+            AkChannelConfig in_channelConfig = AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), AkInt32 in_iChannelLink = SidechainChannelLink_Unlinked,
+            AkUInt32 in_uNumGroups = 1, std::function<void(SidechainCompressorFXParams&, AkUInt32)> in_configure = nullptr,
+            AkUInt32 in_uSampleRate = kSampleRate)
+            : global(in_uSampleRate, in_uFrames)
+            , uFrames(in_uFrames)
+        {
+            AkAudioFormat format;
+            format.uSampleRate = in_uSampleRate;
+            format.channelConfig = in_channelConfig;
+
+            for (AkUInt32 i = 0; i < in_uNumInstances; ++i)
+            {
+                contexts.emplace_back(new HostEffectContext(&global, 1000 + i));
+                inputs.emplace_back(new HostAudioBuffer(in_channelConfig, in_uFrames));
+                outputs.emplace_back(new HostAudioBuffer(in_channelConfig, in_uFrames));
+                fillSignal(*inputs.back(), i, in_uFrames);
+
+                auto* pParams = (SidechainCompressorFXParams*)CreateSidechainCompressorFXParams(&global.allocator);
+                pParams->Init(&global.allocator, nullptr, 0);
+                pParams->RTPC.fThreshold = -24.0f;
+                pParams->RTPC.fMaxRatio = 4.0f;
+                pParams->RTPC.fPriorityRank = 1.0f + (i % 10);
+                pParams->NonRTPC.iControlRate = in_iControlRate;
+                pParams->NonRTPC.iChannelLink = in_iChannelLink;
+                pParams->NonRTPC.iFeedGroups = pParams->NonRTPC.iListenGroups = 1 << (i % in_uNumGroups);
+                if (in_configure)
+                    in_configure(*pParams, i);
+                params.push_back(pParams);
+
+                auto* pFX = (SidechainCompressorFX*)CreateSidechainCompressorFX(&global.allocator);
+                pFX->Init(&global.allocator, contexts.back().get(), pParams, format);
+                effects.push_back(pFX);
+            }
+        }
+
+        ~InstanceSet()
+        {
+            for (SidechainCompressorFX* pFX : effects)
+                pFX->Term(&global.allocator);
+            for (SidechainCompressorFXParams* pParams : params)
+                pParams->Term(&global.allocator);
+        }
+
+        /// Execute consumes the input and fills the output; rewind both for the next frame.
+        void RewindBuffers(size_t in_uIndex)
+        {
+            inputs[in_uIndex]->uValidFrames = uFrames;
+            inputs[in_uIndex]->eState = AK_DataReady;
+            outputs[in_uIndex]->uValidFrames = 0;
+            outputs[in_uIndex]->eState = AK_DataNeeded;
+        }
+
+        /// One audio frame: every instance executes once between the render callbacks.
+        void Render()
+        {
+            global.BeginRender();
+            for (size_t i = 0; i < effects.size(); ++i)
+            {
+                RewindBuffers(i);
+                effects[i]->Execute(inputs[i].get(), 0, outputs[i].get());
+            }
+            global.EndRender();
+        }
+
+        HostGlobalContext global;
+        std::vector<std::unique_ptr<HostEffectContext>> contexts;
+        std::vector<std::unique_ptr<HostAudioBuffer>> inputs;
+        std::vector<std::unique_ptr<HostAudioBuffer>> outputs;
+        std::vector<SidechainCompressorFXParams*> params;
+        std::vector<SidechainCompressorFX*> effects;
+        AkUInt16 uFrames;
+    };
+
+    /// Runs in_func until in_minTime has elapsed (at least once, after one warm-up call).
+    /// Returns seconds per call.
+    template <typename Func>
+    double timeLoop(double in_minTime, Func in_func)
+    {
+        in_func();
+        AkUInt64 uCalls = 0;
+        Timer timer;
+        double elapsed = 0.0;
+        do
+        {
+            in_func();
+            ++uCalls;
+            elapsed = timer.Seconds();
+        } while (elapsed < in_minTime);
+        return elapsed / uCalls;
+    }
+
+    void benchExecute(const Options& in_options)
+    {
+        printf("\nSidechainCompressorFX::Execute, %u Hz, %u channels, control rate %d\n", kSampleRate, kNumChannels, in_options.controlRate);
+        printf("%10s %8s %14s %14s %14s %10s\n", "instances", "frames", "ns/buffer", "ns/frame", "ns/instance", "%realtime");
+
+        for (AkUInt32 uFrames : in_options.frames)
+        {
+            for (AkUInt32 uInstances : in_options.instances)
+            {
+                InstanceSet set(uInstances, (AkUInt16)uFrames, in_options.controlRate);
+                double secondsPerBuffer = timeLoop(in_options.minTime, [&]() { set.Render(); });
+                double nsPerBuffer = secondsPerBuffer * 1e9;
+                double bufferDuration = (double)uFrames / kSampleRate;
+                printf("%10u %8u %14.0f %14.2f %14.1f %9.3f%%\n",
+                    uInstances, uFrames, nsPerBuffer, nsPerBuffer / uFrames, nsPerBuffer / uInstances,
+                    100.0 * secondsPerBuffer / bufferDuration);
+            }
+        }
+    }
+
+    // Wide buses: Execute cost per channel layout and link mode, and the heap allocations made
+    // while rendering (there must be none once the instances are initialized).
+    void benchChannelLayouts(const Options& in_options)
+    {
+        struct Layout
+        {
+            const char* name;
+            AkChannelConfig config;
+        };
+
+        AkChannelConfig ambisonic3;
+        ambisonic3.SetAmbisonic(16);
+        AkChannelConfig ambisonic5;
+        ambisonic5.SetAmbisonic(36);
+        const Layout layouts[] = {
+            { "stereo", AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO) },
+            { "5.1", AkChannelConfig(6, AK_SPEAKER_SETUP_5_1) },
+            { "7.1.4", AkChannelConfig(12, AK_SPEAKER_SETUP_DOLBY_7_1_4) },
+            { "ambisonic 3rd", ambisonic3 },
+            { "ambisonic 5th", ambisonic5 },
+        };
+        const char* linkNames[] = { "unlinked", "max", "sum" };
+
+        const AkUInt32 uInstances = 16;
+        const AkUInt16 uFrames = 512;
+        printf("\nChannel layouts, %u instances, %u frames\n", uInstances, uFrames);
+        printf("%14s %9s %10s %14s %16s %14s\n", "layout", "link", "channels", "ns/instance", "ns/channel", "allocs/frame");
+
+        for (const Layout& layout : layouts)
+        {
+            for (AkInt32 link = SidechainChannelLink_Unlinked; link <= SidechainChannelLink_Sum; ++link)
+            {
+                InstanceSet set(uInstances, uFrames, in_options.controlRate, layout.config, link);
+                set.Render();
+
+                const AkUInt64 uHeapBefore = g_uNumHeapAllocs.load();
+                const AkUInt64 uPluginBefore = set.global.allocator.uNumAllocs;
+                AkUInt64 uRendered = 0;
+                double seconds = timeLoop(in_options.minTime, [&]() { set.Render(); ++uRendered; });
+                const AkUInt64 uAllocs = (g_uNumHeapAllocs.load() - uHeapBefore) + (set.global.allocator.uNumAllocs - uPluginBefore);
+
+                printf("%14s %9s %10u %14.1f %16.2f %14.3f\n", layout.name, linkNames[link], (AkUInt32)layout.config.uNumChannels,
+                    seconds * 1e9 / uInstances, seconds * 1e9 / (uInstances * layout.config.uNumChannels), (double)uAllocs / uRendered);
+            }
+        }
+    }
+
+    // Lookahead: the output must be the input delayed by exactly GetLatencyFrames(), through
+    // block boundaries and the flush after the input ends; and a ducked instance should
+    // already be reduced when a transient on the sidechain reaches its output.
+    bool checkLookahead(const Options& in_options)
+    {
+        const AkUInt16 uFrames = 128;
+        bool bOk = true;
+
+        printf("\nLookahead, %u frames, 1 ms detector window\n", uFrames);
+        printf("%10s %10s %16s %18s %18s %14s\n", "ms", "latency", "max delay error", "gain at onset dB", "frames to -3 dB", "ns/instance");
+
+        for (AkReal32 fLookahead : { 0.0f, 2.5f, 5.0f, 10.0f })
+        {
+            // Unity gain (ratio 1), so the output is the input, delayed
+            InstanceSet unity(1, uFrames, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                [&](SidechainCompressorFXParams& params, AkUInt32) { params.RTPC.fMaxRatio = 1.0f; params.NonRTPC.fLookahead = fLookahead; });
+            const AkUInt32 uLatency = unity.effects[0]->GetLatencyFrames();
+            const AkUInt32 uBlocks = 20;
+            std::vector<AkReal32> input, output;
+            AkUInt32 uDrainCalls = 0;
+            for (AkUInt32 block = 0; block < uBlocks + 10 && uDrainCalls < 10; ++block)
+            {
+                HostAudioBuffer& in = *unity.inputs[0];
+                HostAudioBuffer& out = *unity.outputs[0];
+                const bool bLast = block >= uBlocks;
+                fillSignal(in, block, uFrames);
+                unity.global.BeginRender();
+                in.uValidFrames = bLast ? 0 : uFrames;
+                in.eState = block + 1 >= uBlocks ? AK_NoMoreData : AK_DataReady;
+                out.uValidFrames = 0;
+                out.eState = AK_DataNeeded;
+                if (!bLast)
+                    input.insert(input.end(), in.GetChannel(1), in.GetChannel(1) + uFrames);
+                unity.effects[0]->Execute(&in, 0, &out);
+                unity.global.EndRender();
+                output.insert(output.end(), out.GetChannel(1), out.GetChannel(1) + out.uValidFrames);
+                if (out.eState == AK_NoMoreData)
+                    break;
+                uDrainCalls += bLast;
+            }
+            double maxError = output.size() == input.size() + uLatency ? 0.0 : 1.0;
+            for (size_t frame = 0; frame < output.size(); ++frame)
+            {
+                const AkReal32 expected = frame >= uLatency && frame - uLatency < input.size() ? input[frame - uLatency] : 0.0f;
+                maxError = AkMax(maxError, (double)fabsf(output[frame] - expected));
+            }
+            bOk = bOk && maxError < 1.0e-6;
+
+            // Instance 0 is ducked (rank 1) and does not feed; instance 1 feeds a hard onset at kOnset
+            const AkUInt32 kOnset = 20 * uFrames + 37;
+            InstanceSet ducking(2, uFrames, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                {
+                    params.RTPC.fMaxRatio = 8.0f;
+                    params.RTPC.fPriorityRank = i == 0 ? 1.0f : 10.0f;
+                    params.NonRTPC.fRMSWindow = 1.0f;
+                    params.NonRTPC.fLookahead = fLookahead;
+                    params.NonRTPC.iFeedGroups = i == 0 ? 0 : 1;
+                });
+            AkReal32 gainAtOnset = 0.0f;
+            AkInt32 framesTo3dB = -1;
+            for (AkUInt32 block = 0; block < 40; ++block)
+            {
+                for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                {
+                    const AkUInt32 t = block * uFrames + frame;
+                    for (AkUInt32 channel = 0; channel < 2; ++channel)
+                    {
+                        ducking.inputs[0]->GetChannel(channel)[frame] = 0.25f;
+                        ducking.inputs[1]->GetChannel(channel)[frame] = t >= kOnset ? sinf(0.05f * t) : 0.0f;
+                    }
+                }
+                ducking.Render();
+                for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                {
+                    // Output frame t carries the input of t - latency
+                    const AkInt32 source = (AkInt32)(block * uFrames + frame) - (AkInt32)uLatency;
+                    const AkReal32 gainDB = 20.0f * log10f(AkMax(ducking.outputs[0]->GetChannel(0)[frame] / 0.25f, 1.0e-6f));
+                    if (source == (AkInt32)kOnset)
+                        gainAtOnset = gainDB;
+                    if (source >= (AkInt32)kOnset - (AkInt32)uLatency && framesTo3dB < 0 && gainDB <= -3.0f)
+                        framesTo3dB = source - (AkInt32)kOnset;
+                }
+            }
+
+            InstanceSet cost(64, 256, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                [&](SidechainCompressorFXParams& params, AkUInt32) { params.NonRTPC.fLookahead = fLookahead; });
+            const double seconds = timeLoop(in_options.minTime, [&]() { cost.Render(); });
+
+            printf("%10.1f %10u %16.2e %18.2f %18d %14.1f\n", fLookahead, uLatency, maxError, gainAtOnset, framesTo3dB, seconds * 1e9 / 64);
+        }
+        return bOk;
+    }
+
+    // The same instances split into independent sidechain groups: each bus sums and ranks only
+    // its own members, so the per-frame cost stays flat while the work per bus shrinks.
+    void benchGroups(const Options& in_options)
+    {
+        const AkUInt32 uInstances = 256;
+        const AkUInt16 uFrames = 512;
+        printf("\nSidechain groups, %u instances, %u frames\n", uInstances, uFrames);
+        printf("%8s %18s %14s %14s\n", "groups", "instances/group", "ns/frame", "ns/instance");
+
+        for (AkUInt32 uGroups : { 1u, 4u, 16u })
+        {
+            InstanceSet set(uInstances, uFrames, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, uGroups);
+            double seconds = timeLoop(in_options.minTime, [&]() { set.Render(); });
+            printf("%8u %18u %14.0f %14.1f\n", uGroups, uInstances / uGroups, seconds * 1e9, seconds * 1e9 / uInstances);
+        }
+    }
+
+    // The instance table at scale: registering, moving a rank, and the reduction with the ranks
+    // unchanged or after one moved (a rescan), with the table churned so live handles are scattered. The published spread must match
+    // what was registered.
+    bool checkInstanceTable(const Options& in_options)
+    {
+        printf("\nInstance table, listeners only\n");
+        printf("%10s %14s %14s %14s %16s %8s\n", "instances", "register ns", "setRank ns", "reduction ns", "rescan ns/inst", "spread");
+
+        bool bOk = true;
+        for (AkUInt32 uInstances : { 1000u, 10000u })
+        {
+            HostGlobalContext global(kSampleRate, 1024);
+            auto sharedBuffer = GlobalManager::acquireBuffer(&global, 0);
+
+            // Half as many again handed out and every third released, then half of the rest
+            // released too, so the live handles are scattered and half of them reused
+            std::vector<AkInt32> slots;
+            for (AkUInt32 i = 0; i < uInstances * 3 / 2; ++i)
+                slots.push_back(sharedBuffer->acquireSlot(0, 0));
+            std::vector<AkInt32> live;
+            for (AkUInt32 i = 0; i < slots.size(); ++i)
+            {
+                if (i % 3 == 2)
+                    sharedBuffer->releaseSlot(slots[i]);
+                else
+                    live.push_back(slots[i]);
+            }
+            for (AkUInt32 i = 0; i < uInstances / 2; ++i)
+                sharedBuffer->releaseSlot(live[i]);
+            live.erase(live.begin(), live.begin() + uInstances / 2);
+
+            Timer registerTimer;
+            for (AkUInt32 i = 0; i < uInstances / 2; ++i)
+            {
+                live.push_back(sharedBuffer->acquireSlot(0, 0));
+                sharedBuffer->setRank(live.back(), 1.0f);
+            }
+            const double registerSeconds = registerTimer.Seconds() / (uInstances / 2);
+            for (AkUInt32 i = 0; i < live.size(); ++i)
+                sharedBuffer->setRank(live[i], 1.0f + (AkReal32)(i % 100));
+
+            AkUInt32 uUpdate = 0;
+            const double updateSeconds = timeLoop(in_options.minTime, [&]()
+            {
+                sharedBuffer->setRank(live[uUpdate % live.size()], 1.0f + (AkReal32)(uUpdate % 100));
+                ++uUpdate;
+            });
+            for (AkUInt32 i = 0; i < live.size(); ++i)
+                sharedBuffer->setRank(live[i], 1.0f + (AkReal32)(i % 100));
+
+            const double reduceSeconds = timeLoop(in_options.minTime, [&]() { sharedBuffer->calculatedmRMS(); });
+            const double rescanSeconds = timeLoop(in_options.minTime, [&]()
+            {
+                sharedBuffer->setRank(live[0], 1.0f);
+                sharedBuffer->calculatedmRMS();
+            });
+
+            const SidechainRanks ranks = sharedBuffer->getSnapshot().ranks;
+            const bool bSpread = ranks.numRanked == uInstances && ranks.minRank == 1.0f && ranks.maxRank == 100.0f;
+            bOk = bOk && bSpread && live.size() == uInstances;
+            printf("%10u %14.1f %14.1f %14.0f %16.2f %8s\n", uInstances, registerSeconds * 1e9, updateSeconds * 1e9,
+                reduceSeconds * 1e9, rescanSeconds * 1e9 / uInstances, bSpread ? "ok" : "WRONG");
+
+            for (AkInt32 slot : live)
+                sharedBuffer->releaseSlot(slot);
+            sharedBuffer.reset();
+            GlobalManager::releaseBuffer(&global, 0);
+        }
+        return bOk;
+    }
+
+    // What one bus asks the allocator for, by what registers on it: the storage sized by the
+    // slots must follow the widest and longest slot, not the bus maximums.
+    bool checkBusMemory(const Options&)
+    {
+        struct Case
+        {
+            const char* name;
+            AkUInt32 uInstances;
+            AkUInt32 uChannels;
+            AkUInt32 uFrames;
+            AkUInt64 uBudget;               // Bytes
+        };
+        const Case cases[] = {
+            { "listeners", 64, 0, 1024, 64 * 1024 },
+            { "stereo", 64, 2, 256, 512 * 1024 },
+            { "5.1", 64, 6, 1024, 4 * 1024 * 1024 },
+            { "16 channels", 1, 16, 4096, 16 * 1024 * 1024 },
+        };
+
+        printf("\nBus memory, bytes requested from the allocator\n");
+        printf("%12s %10s %10s %8s %14s %14s %10s\n", "slots", "instances", "channels", "frames", "bytes", "budget", "result");
+
+        bool bOk = true;
+        for (const Case& test : cases)
+        {
+            HostGlobalContext global(kSampleRate, (AkUInt16)test.uFrames);
+            auto sharedBuffer = GlobalManager::acquireBuffer(&global, 0);
+            std::vector<AkInt32> slots;
+            for (AkUInt32 i = 0; i < test.uInstances; ++i)
+                slots.push_back(sharedBuffer->acquireSlot(test.uChannels, test.uFrames));
+            const AkUInt64 uBytes = global.allocator.uNumBytes;
+            const bool bFits = uBytes <= test.uBudget && std::find(slots.begin(), slots.end(), SidechainCompressorSharedBuffer::kInvalidSlot) == slots.end();
+            bOk = bOk && bFits;
+            printf("%12s %10u %10u %8u %14llu %14llu %10s\n", test.name, test.uInstances, test.uChannels, test.uFrames,
+                (unsigned long long)uBytes, (unsigned long long)test.uBudget, bFits ? "ok" : "TOO BIG");
+
+            for (AkInt32 slot : slots)
+                sharedBuffer->releaseSlot(slot);
+            sharedBuffer.reset();
+            GlobalManager::releaseBuffer(&global, 0);
+        }
+        return bOk;
+    }
+
+    void benchSharedBuffer(const Options& in_options)
+    {
+        printf("\nSidechainCompressorSharedBuffer entry points\n");
+        printf("%10s %8s %20s %20s %20s %20s\n", "instances", "frames", "AddToSharedBuffer ns", "calculatedmRMS ns", "getPercentile ns", "setRank ns");
+
+        HostGlobalContext global(kSampleRate, 1024);
+        auto sharedBuffer = GlobalManager::acquireBuffer(&global, 0);
+
+        for (AkUInt32 uFrames : in_options.frames)
+        {
+            for (AkUInt32 uInstances : in_options.instances)
+            {
+                // Register on the bus directly, the way Init does, without the effect around it.
+                std::vector<std::unique_ptr<HostAudioBuffer>> inputs;
+                std::vector<AkInt32> slots;
+                for (AkUInt32 i = 0; i < uInstances; ++i)
+                {
+                    inputs.emplace_back(new HostAudioBuffer(kNumChannels, (AkUInt16)uFrames));
+                    inputs.back()->uValidFrames = (AkUInt16)uFrames;
+                    fillSignal(*inputs.back(), i, uFrames);
+                    slots.push_back(sharedBuffer->acquireSlot(kNumChannels, uFrames));
+                    sharedBuffer->setRank(slots.back(), 1.0f + (i % 10));
+                }
+
+                auto addAll = [&]()
+                {
+                    const AkUInt32 epoch = sharedBuffer->getWriteEpoch();
+                    for (AkUInt32 i = 0; i < uInstances; ++i)
+                        sharedBuffer->AddToSharedBuffer(slots[i], epoch, inputs[i].get(), 0, uFrames, 0);
+                };
+
+                double addSeconds = timeLoop(in_options.minTime, addAll);
+
+                // The reduction only merges what was contributed to the current epoch, so refill
+                // it each pass; only the reduction itself is timed.
+                double reduceSeconds = 0.0;
+                AkUInt64 uReductions = 0;
+                timeLoop(in_options.minTime, [&]()
+                {
+                    addAll();
+                    Timer timer;
+                    sharedBuffer->calculatedmRMS();
+                    reduceSeconds += timer.Seconds();
+                    ++uReductions;
+                });
+
+                volatile AkReal32 sink = 0.0f;
+                double percentileSeconds = timeLoop(in_options.minTime, [&]()
+                {
+                    for (AkUInt32 i = 0; i < uInstances; ++i)
+                        sink = sink + sharedBuffer->getSnapshot().getPercentile(1.0f + (i % 10));
+                });
+
+                // Moves one rank from one end of the spread to the other and back
+                AkUInt32 uUpdate = 0;
+                double updateSeconds = timeLoop(in_options.minTime, [&]()
+                {
+                    sharedBuffer->setRank(slots[0], (uUpdate++ & 1) ? 1.0f : 10.0f);
+                });
+
+                printf("%10u %8u %20.1f %20.1f %20.1f %20.1f\n", uInstances, uFrames,
+                    addSeconds * 1e9 / uInstances, reduceSeconds * 1e9 / uReductions, percentileSeconds * 1e9 / uInstances, updateSeconds * 1e9);
+
+                for (AkUInt32 i = 0; i < uInstances; ++i)
+                    sharedBuffer->releaseSlot(slots[i]);
+            }
+        }
+
+        GlobalManager::releaseBuffer(&global, 0);
+    }
+
+    // Analytic soft-knee curve in double precision, as Execute evaluated it before the block kernel.
+    double referenceGainDB(double level, double threshold, double ratio, double knee)
+    {
+        double x = 20.0 * log10(AkMax(level, 1.0e-12));
+        double y = x;
+        if (x > threshold + knee / 2)
+            y = ((x - threshold) / ratio) + threshold;
+        else if (x > threshold - knee / 2)
+            y = x + (((1 / ratio) - 1) / (2 * knee)) * pow(x - (threshold - knee / 2), 2);
+        return y - x;
+    }
+
+    void benchGainKernel(const Options& in_options)
+    {
+        printf("\nSidechainGainKernel, levels -240..+24 dB (detected: %s)\n",
+            SidechainGainKernel::getIsaName(SidechainGainKernel::detectIsa()));
+        printf("%10s %14s %18s\n", "isa", "ns/sample", "max error dB");
+
+        const AkUInt32 uFrames = 4096;
+        std::vector<AkReal32> levels(uFrames), gains(uFrames);
+        for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+            levels[frame] = powf(10.0f, (-240.0f + 264.0f * frame / (uFrames - 1)) / 20.0f);
+
+        const AkReal32 curves[][3] = { { -24.0f, 4.0f, 1.0f }, { -6.0f, 15.0f, 6.0f }, { -60.0f, 1.5f, 0.0f }, { 0.0f, 1.0f, 1.0f } };
+
+        for (AkInt32 isa = 0; isa < SidechainGainKernel::Isa_Count; ++isa)
+        {
+            SidechainGainKernel::ComputeFunc compute = SidechainGainKernel::getCompute((SidechainGainKernel::Isa)isa);
+            if (compute == nullptr || isa > SidechainGainKernel::detectIsa())
+                continue;
+
+            double maxError = 0.0;
+            for (const auto& params : curves)
+            {
+                SidechainGainCurve curve = SidechainGainCurve::make(params[0], params[1], params[2]);
+                compute(levels.data(), gains.data(), uFrames, curve);
+                for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                {
+                    double reference = referenceGainDB(levels[frame], params[0], params[1], params[2]);
+                    maxError = AkMax(maxError, fabs(20.0 * log10((double)gains[frame]) - reference));
+                }
+            }
+
+            SidechainGainCurve curve = SidechainGainCurve::make(-24.0f, 4.0f, 1.0f);
+            double seconds = timeLoop(in_options.minTime, [&]() { compute(levels.data(), gains.data(), uFrames, curve); });
+            printf("%10s %14.3f %18.6f\n", SidechainGainKernel::getIsaName((SidechainGainKernel::Isa)isa), seconds * 1e9 / uFrames, maxError);
+        }
+    }
+
+    // Tabulated curve against the analytic reference over the table's range, per step and
+    // lookup variant, then the same instance rendered with and without a table. The finest
+    // step must stay within kTableBudgetDB of the reference.
+    bool checkGainTable(const Options& in_options)
+    {
+        const AkReal32 kTableBudgetDB = 0.02f;
+        printf("\nSidechainGainTable, levels %.0f..%+.0f dB\n", SidechainGainTable::kMinDb, SidechainGainTable::kMaxDb);
+        printf("%10s %10s %10s %14s %18s %10s\n", "step dB", "entries", "isa", "ns/sample", "max error dB", "result");
+
+        const AkUInt32 uFrames = 4096;
+        std::vector<AkReal32> levels(uFrames), gains(uFrames);
+        for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+            levels[frame] = powf(10.0f, (SidechainGainTable::kMinDb + (SidechainGainTable::kMaxDb - SidechainGainTable::kMinDb) * frame / (uFrames - 1)) / 20.0f);
+
+        const AkReal32 curves[][3] = { { -24.0f, 4.0f, 1.0f }, { -6.0f, 15.0f, 6.0f }, { -60.0f, 1.5f, 0.0f }, { 0.0f, 1.0f, 1.0f } };
+
+        bool bOk = true;
+        for (AkReal32 fStep : { 0.1f, 0.5f, 1.0f })
+        {
+            const AkUInt32 uEntries = SidechainGainTable::getNumEntries(fStep);
+            std::vector<AkReal32> tableLevels(uEntries + 1), tableGains(uEntries + 1);
+            SidechainGainTable::fillLevels(tableLevels.data(), uEntries);
+            SidechainGainTable table;
+            table.init(tableLevels.data(), tableGains.data(), uEntries);
+
+            for (AkInt32 isa = 0; isa < SidechainGainKernel::Isa_Count; ++isa)
+            {
+                SidechainGainKernel::LookupFunc lookup = SidechainGainKernel::getLookup((SidechainGainKernel::Isa)isa);
+                if (lookup == nullptr || isa > SidechainGainKernel::detectIsa())
+                    continue;
+
+                double maxError = 0.0;
+                for (const auto& params : curves)
+                {
+                    table.build(SidechainGainCurve::make(params[0], params[1], params[2]), SidechainGainKernel::getBestCompute());
+                    lookup(levels.data(), gains.data(), uFrames, table);
+                    for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                    {
+                        double reference = referenceGainDB(levels[frame], params[0], params[1], params[2]);
+                        maxError = AkMax(maxError, fabs(20.0 * log10((double)gains[frame]) - reference));
+                    }
+                }
+
+                table.build(SidechainGainCurve::make(-24.0f, 4.0f, 1.0f), SidechainGainKernel::getBestCompute());
+                double seconds = timeLoop(in_options.minTime, [&]() { lookup(levels.data(), gains.data(), uFrames, table); });
+                const bool bCaseOk = fStep > 0.1f || maxError < kTableBudgetDB;
+                bOk = bOk && bCaseOk;
+                printf("%10.2f %10u %10s %14.3f %18.6f %10s\n", fStep, uEntries, SidechainGainKernel::getIsaName((SidechainGainKernel::Isa)isa),
+                    seconds * 1e9 / uFrames, maxError, bCaseOk ? "ok" : "FAILED");
+            }
+        }
+
+        // End to end: one ducked instance, its curve computed or tabulated, under a swelling sidechain
+        printf("%10s %10s %14s %18s %10s\n", "step dB", "", "ns/execute", "max diff dB", "result");
+        std::vector<std::vector<AkReal32>> rendered;
+        for (AkReal32 fStep : { 0.0f, 0.1f })
+        {
+            InstanceSet set(2, 256, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                {
+                    params.RTPC.fMaxRatio = 8.0f;
+                    params.RTPC.fPriorityRank = i == 0 ? 10.0f : 1.0f;
+                    params.NonRTPC.iFeedGroups = i == 0 ? 1 : 0;
+                    params.NonRTPC.iListenGroups = 1;
+                    params.NonRTPC.fCurveTableStep = fStep;
+                });
+            rendered.emplace_back();
+            double seconds = 0.0;
+            for (AkUInt32 block = 0; block < 200; ++block)
+            {
+                const AkReal32 level = 0.5f + 0.45f * sinf(6.2831853f * block / 150.0f);
+                for (AkUInt32 frame = 0; frame < 256; ++frame)
+                {
+                    for (AkUInt32 channel = 0; channel < 2; ++channel)
+                    {
+                        set.inputs[0]->GetChannel(channel)[frame] = level * sinf(0.05f * (block * 256 + frame));
+                        set.inputs[1]->GetChannel(channel)[frame] = 0.25f;
+                    }
+                }
+                set.global.BeginRender();
+                for (AkUInt32 i = 0; i < 2; ++i)
+                {
+                    set.RewindBuffers(i);
+                    Timer timer;
+                    set.effects[i]->Execute(set.inputs[i].get(), 0, set.outputs[i].get());
+                    if (i == 1)
+                        seconds += timer.Seconds();
+                }
+                set.global.EndRender();
+                rendered.back().insert(rendered.back().end(), set.outputs[1]->GetChannel(0), set.outputs[1]->GetChannel(0) + 256);
+            }
+
+            double maxDiff = 0.0;
+            for (size_t frame = 0; frame < rendered.back().size(); ++frame)
+                maxDiff = AkMax(maxDiff, fabs(20.0 * log10((double)rendered.back()[frame] / (double)rendered[0][frame])));
+            const bool bCaseOk = maxDiff < kTableBudgetDB;
+            bOk = bOk && bCaseOk;
+            printf("%10.2f %10s %14.1f %18.6f %10s\n", fStep, "", seconds * 1e9 / 200, maxDiff, bCaseOk ? "ok" : "FAILED");
+        }
+        return bOk;
+    }
+
+    // The moving RMS calculatedmRMS ran before SidechainDetector, kept for comparison.
+    void legacyMovingRMS(const AkReal32* in_pFrames, AkUInt32 in_uFrames, AkUInt32 in_uWindow, AkReal32* io_pRMS)
+    {
+        for (AkUInt32 channel = 0; channel < kNumChannels; ++channel)
+        {
+            for (AkUInt32 frame = 0; frame < in_uFrames; ++frame)
+            {
+                const AkReal32 sample = in_pFrames[frame * kNumChannels + channel];
+                io_pRMS[channel] = sqrtf(((powf(io_pRMS[channel], 2) * ((in_uWindow * kNumChannels) - 1)) + powf(sample, 2)) / (in_uWindow * kNumChannels));
+            }
+        }
+    }
+
+    // Times the detector per sample and, for the sliding window, checks the running sum against
+    // the mean square of the window recomputed in double precision after every block.
+    void benchDetector(const Options& in_options)
+    {
+        const AkUInt32 uFrames = 1024;
+        const AkUInt32 uBlocks = 2000;  // ~43 s at 48 kHz, long enough for a running sum to drift
+
+        printf("\nSidechainDetector, %u channels, %u-frame blocks\n", kNumChannels, uFrames);
+        printf("%16s %10s %12s %20s\n", "mode", "window ms", "ns/sample", "max rel. error");
+
+        // A level that swings over 60 dB, so the running sum sees loud and quiet passages. Frame-major.
+        std::vector<AkReal32> signal((size_t)uBlocks * uFrames * kNumChannels);
+        for (size_t i = 0; i < signal.size() / kNumChannels; ++i)
+        {
+            AkReal32 level = powf(10.0f, -1.5f + 1.5f * sinf(i * 2.0e-5f));
+            for (AkUInt32 channel = 0; channel < kNumChannels; ++channel)
+                signal[i * kNumChannels + channel] = level * sinf(i * (0.01f + 0.003f * channel));
+        }
+
+        for (AkReal32 windowMs : { 1.0f, 10.0f, 100.0f })
+        {
+            const AkUInt32 uWindow = (AkUInt32)(windowMs * 0.001f * kSampleRate + 0.5f);
+
+            for (SidechainDetector::Mode mode : { SidechainDetector::Mode_SlidingWindow, SidechainDetector::Mode_OnePole })
+            {
+                HostAllocator allocator;
+                SidechainDetector detector;
+                detector.init(&allocator, kNumChannels, kSampleRate);
+                detector.setWindow(windowMs, mode);
+
+                double maxError = 0.0;
+                for (AkUInt32 block = 0; block < uBlocks; ++block)
+                {
+                    detector.process(signal.data() + (size_t)block * uFrames * kNumChannels, kNumChannels, uFrames);
+                    if (mode != SidechainDetector::Mode_SlidingWindow)
+                        continue;
+
+                    const size_t end = (size_t)(block + 1) * uFrames;
+                    for (AkUInt32 channel = 0; channel < kNumChannels; ++channel)
+                    {
+                        double sum = 0.0;
+                        for (size_t i = end - AkMin((size_t)uWindow, end); i < end; ++i)
+                            sum += (double)signal[i * kNumChannels + channel] * signal[i * kNumChannels + channel];
+                        double exact = sum / uWindow;
+                        if (exact > 1.0e-12)
+                            maxError = AkMax(maxError, fabs(detector.getMeanSquare(channel) - exact) / exact);
+                    }
+                }
+
+                AkUInt32 block = 0;
+                double seconds = timeLoop(in_options.minTime, [&]()
+                {
+                    detector.process(signal.data() + (size_t)block * uFrames * kNumChannels, kNumChannels, uFrames);
+                    block = (block + 1) % uBlocks;
+                });
+
+                if (mode == SidechainDetector::Mode_SlidingWindow)
+                    printf("%16s %10.0f %12.3f %20.2e\n", "sliding window", windowMs, seconds * 1e9 / (uFrames * kNumChannels), maxError);
+                else
+                    printf("%16s %10.0f %12.3f %20s\n", "one-pole", windowMs, seconds * 1e9 / (uFrames * kNumChannels), "-");
+            }
+
+            AkReal32 rms[kNumChannels] = { 0.0f, 0.0f };
+            AkUInt32 block = 0;
+            double seconds = timeLoop(in_options.minTime, [&]()
+            {
+                legacyMovingRMS(signal.data() + (size_t)block * uFrames * kNumChannels, uFrames, uWindow, rms);
+                block = (block + 1) % uBlocks;
+            });
+            printf("%16s %10.0f %12.3f %20s\n", "legacy sqrt/pow", windowMs, seconds * 1e9 / (uFrames * kNumChannels), "-");
+        }
+    }
+
+    // Renders the same moving sidechain at full rate and at each control rate and compares
+    // the ducked outputs of the most compressed instance. Each rate has a gain budget of about
+    // twice what it measures; what is left is the interpolation between points, worst where
+    // the envelope crosses the knee inside one step.
+    bool checkControlRate(const Options& in_options)
+    {
+        printf("\nControl-rate gain vs full rate, 8 instances, 500 buffers of 256 frames\n");
+        printf("%12s %14s %18s %18s %12s %10s\n", "control rate", "ns/instance", "max |sample| diff", "max gain diff dB", "budget dB", "result");
+
+        const AkUInt32 uInstances = 8;
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uBuffers = 500;
+
+        // Level envelope per buffer, so the shared detector keeps moving.
+        auto renderAll = [&](InstanceSet& io_set, std::vector<AkReal32>& out_rendered)
+        {
+            out_rendered.clear();
+            for (AkUInt32 buffer = 0; buffer < uBuffers; ++buffer)
+            {
+                AkReal32 level = 0.05f + 0.95f * (0.5f + 0.5f * sinf(buffer * 0.11f)) * (buffer % 40 < 20 ? 1.0f : 0.1f);
+                for (AkUInt32 i = 0; i < uInstances; ++i)
+                    fillSignal(*io_set.inputs[i], i, uFrames, i == 0 ? 1.0f : level);
+                io_set.Render();
+                const AkReal32* pOut = io_set.outputs[0]->GetChannel(0);
+                out_rendered.insert(out_rendered.end(), pOut, pOut + uFrames);
+            }
+        };
+
+        std::vector<AkReal32> reference, rendered;
+        {
+            InstanceSet set(uInstances, uFrames, 1);
+            renderAll(set, reference);
+        }
+        std::vector<AkReal32> input;
+        {
+            HostAudioBuffer buffer(kNumChannels, uFrames);
+            fillSignal(buffer, 0, uFrames);
+            input.assign(buffer.GetChannel(0), buffer.GetChannel(0) + uFrames);
+        }
+
+        struct Rate
+        {
+            AkInt32 iControlRate;
+            double maxGainDb;
+        };
+        const Rate rates[] = { { 1, 1.0e-6 }, { 8, 0.15 }, { 16, 0.4 }, { 32, 0.6 }, { 64, 0.8 } };
+
+        bool bOk = true;
+        for (const Rate& rate : rates)
+        {
+            const AkInt32 controlRate = rate.iControlRate;
+            InstanceSet set(uInstances, uFrames, controlRate);
+            renderAll(set, rendered);
+
+            double maxSampleDiff = 0.0;
+            double maxGainDiff = 0.0;
+            for (size_t frame = 0; frame < rendered.size(); ++frame)
+            {
+                maxSampleDiff = AkMax(maxSampleDiff, (double)fabsf(rendered[frame] - reference[frame]));
+                AkReal32 in = input[frame % uFrames];
+                if (fabsf(in) > 1.0e-3f && fabsf(reference[frame]) > 1.0e-9f)
+                {
+                    double gainDiff = 20.0 * log10(fabs((double)rendered[frame] / in)) - 20.0 * log10(fabs((double)reference[frame] / in));
+                    maxGainDiff = AkMax(maxGainDiff, fabs(gainDiff));
+                }
+            }
+
+            double seconds = timeLoop(in_options.minTime, [&]() { set.Render(); });
+            const bool bRateOk = maxGainDiff <= rate.maxGainDb;
+            printf("%12d %14.1f %18.6f %18.6f %12.2g %10s\n", controlRate, seconds * 1e9 / uInstances, maxSampleDiff, maxGainDiff, rate.maxGainDb, bRateOk ? "ok" : "DIFF");
+            bOk = bOk && bRateOk;
+        }
+        return bOk;
+    }
+
+    // Parallel rendering: instances executed from N worker threads at once, pulled from a
+    // shared counter so which thread renders which instance changes every frame. The output
+    // must be bit-identical to rendering on one thread, and throughput should scale.
+    bool checkParallelRender(const Options& in_options)
+    {
+        const AkUInt32 uInstances = 256;
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uRenderFrames = 200;
+
+        printf("\nParallel render, %u instances, %u frames of %u, %u hardware threads\n", uInstances, uRenderFrames, uFrames, std::thread::hardware_concurrency());
+        printf("%8s %14s %14s %10s %20s %10s\n", "threads", "ns/frame", "ns/instance", "speedup", "output hash", "result");
+
+        bool bOk = true;
+        AkUInt64 uReferenceHash = 0;
+        double singleSeconds = 0.0;
+        for (AkUInt32 uThreads : { 1u, 2u, 4u, 8u, 16u })
+        {
+            InstanceSet set(uInstances, uFrames, in_options.controlRate);
+            std::atomic<AkUInt32> uGeneration(0), uNext(0), uDone(0);
+            std::atomic<bool> bQuit(false);
+
+            auto renderShare = [&]()
+            {
+                AkUInt32 i;
+                while ((i = uNext.fetch_add(1, std::memory_order_acq_rel)) < uInstances)
+                {
+                    set.RewindBuffers(i);
+                    set.effects[i]->Execute(set.inputs[i].get(), 0, set.outputs[i].get());
+                }
+                uDone.fetch_add(1, std::memory_order_acq_rel);
+            };
+
+            // The calling thread is worker 0
+            std::vector<std::thread> workers;
+            for (AkUInt32 w = 1; w < uThreads; ++w)
+            {
+                workers.emplace_back([&]()
+                {
+                    AkUInt32 uSeen = 0;
+                    for (;;)
+                    {
+                        AkUInt32 uNow;
+                        while ((uNow = uGeneration.load(std::memory_order_acquire)) == uSeen && !bQuit.load(std::memory_order_acquire))
+                            std::this_thread::yield();
+                        if (bQuit.load(std::memory_order_acquire))
+                            return;
+                        uSeen = uNow;
+                        renderShare();
+                    }
+                });
+            }
+
+            AkUInt64 uHash = 1469598103934665603ull;
+            double seconds = 0.0;
+            for (AkUInt32 frame = 0; frame < uRenderFrames; ++frame)
+            {
+                Timer timer;
+                set.global.BeginRender();
+                uNext.store(0, std::memory_order_relaxed);
+                uDone.store(0, std::memory_order_relaxed);
+                uGeneration.fetch_add(1, std::memory_order_acq_rel);
+                renderShare();
+                while (uDone.load(std::memory_order_acquire) < uThreads)
+                    std::this_thread::yield();
+                set.global.EndRender();
+                seconds += timer.Seconds();
+
+                for (AkUInt32 i = 0; i < uInstances; ++i)
+                {
+                    for (AkUInt32 channel = 0; channel < kNumChannels; ++channel)
+                    {
+                        const AkReal32* pOut = set.outputs[i]->GetChannel(channel);
+                        for (AkUInt32 f = 0; f < uFrames; ++f)
+                        {
+                            AkUInt32 bits;
+                            memcpy(&bits, &pOut[f], sizeof(bits));
+                            uHash = (uHash ^ bits) * 1099511628211ull;
+                        }
+                    }
+                }
+            }
+            bQuit.store(true, std::memory_order_release);
+            for (std::thread& worker : workers)
+                worker.join();
+
+            if (uThreads == 1)
+            {
+                uReferenceHash = uHash;
+                singleSeconds = seconds;
+            }
+            const bool bSame = uHash == uReferenceHash;
+            bOk = bOk && bSame;
+            printf("%8u %14.0f %14.1f %9.2fx %20llx %10s\n", uThreads, seconds * 1e9 / uRenderFrames, seconds * 1e9 / ((double)uRenderFrames * uInstances),
+                singleSeconds / seconds, (unsigned long long)uHash, bSame ? "ok" : "DIFFERS");
+        }
+        return bOk;
+    }
+
+    // Wider and longer slots registered while other threads contribute: every partial moves to
+    // a new layout under the contributors, again and again, and each epoch must still sum
+    // exactly. Feeders hold a constant per channel and the detector window is shorter than the
+    // frame, so every snapshot is the frame's own sum.
+    bool checkPartialGrowth(const Options&)
+    {
+        const AkUInt32 uThreads = 4;
+        const AkUInt32 uSlotsPerThread = 8;
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uChunk = 16;
+        const AkUInt32 uBuses = 4;
+        const AkUInt32 uLongest = 2048;
+
+        printf("\nPartial growth under %u contributing threads, %u buses\n", uThreads, uBuses);
+        printf("%10s %10s %14s %10s\n", "growths", "epochs", "worst error", "result");
+
+        HostAudioBuffer input(kNumChannels, uFrames);
+        input.uValidFrames = uFrames;
+        for (AkUInt32 channel = 0; channel < kNumChannels; ++channel)
+        {
+            for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                input.GetChannel(channel)[frame] = 0.01f * (channel + 1);
+        }
+
+        AkUInt32 uGrowths = 0, uEpochs = 0;
+        double worst = 0.0;
+        for (AkUInt32 bus = 0; bus < uBuses; ++bus)
+        {
+            HostGlobalContext global(kSampleRate, uFrames);
+            auto sharedBuffer = GlobalManager::acquireBuffer(&global, 0);
+            sharedBuffer->setDetector(SidechainDetector::kMinWindowMs, SidechainDetector::Mode_SlidingWindow);
+            std::vector<AkInt32> slots;
+            for (AkUInt32 i = 0; i < uThreads * uSlotsPerThread; ++i)
+                slots.push_back(sharedBuffer->acquireSlot(kNumChannels, uFrames));
+
+            // Each registration asks for a longer frame, and every sixteenth for one more channel
+            AkUInt32 uMaxFrames = uFrames;
+            AkUInt32 uChannels = kNumChannels;
+            while (uMaxFrames < uLongest)
+            {
+                const AkUInt32 epoch = sharedBuffer->getWriteEpoch();
+                std::atomic<AkUInt32> uDone(0);
+                std::vector<std::thread> contributors;
+                for (AkUInt32 t = 0; t < uThreads; ++t)
+                {
+                    contributors.emplace_back([&, t]()
+                    {
+                        for (AkUInt32 position = 0; position < uFrames; position += uChunk)
+                        {
+                            for (AkUInt32 i = 0; i < uSlotsPerThread; ++i)
+                                sharedBuffer->AddToSharedBuffer(slots[t * uSlotsPerThread + i], epoch, &input, position, uChunk, position);
+                            std::this_thread::yield();
+                        }
+                        uDone.fetch_add(1, std::memory_order_acq_rel);
+                    });
+                }
+
+                while (uDone.load(std::memory_order_acquire) < uThreads && uMaxFrames < uLongest)
+                {
+                    uMaxFrames += 8;
+                    uChannels = AkMin(kNumChannels + 1 + uGrowths / 16, SidechainCompressorSharedBuffer::kMaxChannels);
+                    sharedBuffer->releaseSlot(sharedBuffer->acquireSlot(uChannels, uMaxFrames));
+                    ++uGrowths;
+                    std::this_thread::yield();
+                }
+                for (std::thread& contributor : contributors)
+                    contributor.join();
+
+                sharedBuffer->calculatedmRMS();
+                const SidechainSnapshot snapshot = sharedBuffer->getSnapshot();
+                for (AkUInt32 channel = 0; channel < SidechainSnapshot::kMaxChannels; ++channel)
+                {
+                    const double expected = channel < kNumChannels ? 0.01 * (channel + 1) * uThreads * uSlotsPerThread : 0.0;
+                    worst = std::max(worst, fabs(snapshot.newbuffer_mRMS[channel] - expected));
+                }
+                ++uEpochs;
+            }
+
+            for (AkInt32 slot : slots)
+                sharedBuffer->releaseSlot(slot);
+            sharedBuffer.reset();
+            GlobalManager::releaseBuffer(&global, 0);
+        }
+
+        // The sums are exact; what is left is the detector's float
+        const bool bOk = worst < 1.0e-4;
+        printf("%10u %10u %14.2e %10s\n", uGrowths, uEpochs, worst, bOk ? "ok" : "WRONG");
+        return bOk;
+    }
+
+    // Mixed buffers on one bus: a feeder that delivers its frame in two calls, the second from
+    // an input offset, must sum exactly as if it had delivered it whole, and a partial last
+    // buffer must not disturb the others. An instance at another sample rate is refused.
+    bool checkMixedBuffers(const Options& in_options)
+    {
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uBlocks = 200, uSplit = 100, uPartialBlock = 120, uPartialFrames = 180;
+        auto configure = [](SidechainCompressorFXParams& params, AkUInt32 i)
+        {
+            // Instance 0 is ducked, 1 and 2 feed
+            params.RTPC.fPriorityRank = i == 0 ? 1.0f : 10.0f;
+            params.NonRTPC.iFeedGroups = i == 0 ? 0 : 1;
+            params.NonRTPC.iListenGroups = i == 0 ? 1 : 0;
+        };
+        InstanceSet whole(3, uFrames, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1, configure);
+        InstanceSet split(3, uFrames, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1, configure);
+
+        AkUInt64 uAllocs = 0;
+        double maxDiff = 0.0;
+        for (AkUInt32 block = 0; block < uBlocks; ++block)
+        {
+            for (InstanceSet* pSet : { &whole, &split })
+            {
+                InstanceSet& set = *pSet;
+                for (AkUInt32 i = 0; i < 3; ++i)
+                    fillSignal(*set.inputs[i], block * 3 + i, uFrames, i == 0 ? 1.0f : 2.0f);
+
+                const AkUInt64 uAllocsBefore = g_uNumHeapAllocs.load() + set.global.allocator.uNumAllocs;
+                set.global.BeginRender();
+                for (AkUInt32 i = 0; i < 3; ++i)
+                {
+                    set.RewindBuffers(i);
+                    HostAudioBuffer& in = *set.inputs[i];
+                    HostAudioBuffer& out = *set.outputs[i];
+
+                    // Instance 2 ends early: a short buffer, then nothing
+                    if (i == 2 && block >= uPartialBlock)
+                    {
+                        in.uValidFrames = block == uPartialBlock ? uPartialFrames : 0;
+                        in.eState = AK_NoMoreData;
+                    }
+                    if (pSet == &split && i == 1)
+                    {
+                        in.uValidFrames = uSplit;
+                        set.effects[i]->Execute(&in, 0, &out);
+                        in.uValidFrames = uFrames - uSplit;
+                        set.effects[i]->Execute(&in, uSplit, &out);
+                    }
+                    else
+                    {
+                        set.effects[i]->Execute(&in, 0, &out);
+                    }
+                }
+                set.global.EndRender();
+                // Counted from the second frame on, like the other render checks
+                if (block > 0)
+                    uAllocs += g_uNumHeapAllocs.load() + set.global.allocator.uNumAllocs - uAllocsBefore;
+            }
+
+            // The ducked instance, and the split feeder's own output, match the whole-buffer run
+            for (AkUInt32 i = 0; i < 2; ++i)
+            {
+                for (AkUInt32 channel = 0; channel < 2; ++channel)
+                {
+                    for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                    {
+                        maxDiff = AkMax(maxDiff, (double)fabsf(whole.outputs[i]->GetChannel(channel)[frame] - split.outputs[i]->GetChannel(channel)[frame]));
+                    }
+                }
+            }
+        }
+
+        // A voice at 44.1 kHz on a 48 kHz engine
+        AkAudioFormat format;
+        format.uSampleRate = 44100;
+        format.channelConfig = AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO);
+        HostEffectContext context(&whole.global, 2000);
+        auto* pParams = (SidechainCompressorFXParams*)CreateSidechainCompressorFXParams(&whole.global.allocator);
+        pParams->Init(&whole.global.allocator, nullptr, 0);
+        auto* pFX = (SidechainCompressorFX*)CreateSidechainCompressorFX(&whole.global.allocator);
+        const AKRESULT eMismatched = pFX->Init(&whole.global.allocator, &context, pParams, format);
+        pFX->Term(&whole.global.allocator);
+        pParams->Term(&whole.global.allocator);
+        whole.Render();
+
+        const bool bOk = maxDiff < 1.0e-6 && uAllocs == 0 && eMismatched == AK_InvalidParameter;
+        printf("\nMixed buffers, %u frames split %u + %u from an offset, one feeder ending on %u frames\n", uFrames, uSplit, uFrames - uSplit, uPartialFrames);
+        printf("%22s %14s %22s %10s\n", "max diff vs whole", "allocations", "44.1 kHz voice Init", "result");
+        printf("%22.2e %14llu %22s %10s\n", maxDiff, (unsigned long long)uAllocs,
+            eMismatched == AK_InvalidParameter ? "refused" : "ACCEPTED", bOk ? "ok" : "FAILED");
+        return bOk;
+    }
+
+    // Virtual voices: TimeSkip must leave an instance where Execute would have, so a ducked
+    // voice that goes virtual and comes back matches one that rendered all along, and the
+    // sidechain holds its level while the voice feeding it is virtual.
+    bool checkTimeSkip(const Options& in_options)
+    {
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uBlocks = 450, uSkipFrom = 188, uSkipTo = 388;
+
+        printf("\nTimeSkip, %u frames, virtual from block %u to %u\n", uFrames, uSkipFrom, uSkipTo);
+        printf("%20s %22s %22s %14s %14s %10s\n", "virtual", "re-entry gain diff dB", "drift while virtual dB", "ns/skip", "ns/execute", "result");
+
+        bool bOk = true;
+        for (AkUInt32 uVirtual : { 0u, 2u })
+        {
+            // Instance 0 feeds a swelling tone; 1 and 2 are ducked by it and identical, except
+            // that instance uVirtual is skipped while virtual. Instance 1 is the reference.
+            InstanceSet set(3, uFrames, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                {
+                    params.RTPC.fMaxRatio = 8.0f;
+                    params.RTPC.fPriorityRank = i == 0 ? 10.0f : 1.0f;
+                    params.RTPC.fRelease = 200.0f;
+                    params.NonRTPC.iFeedGroups = i == 0 ? 1 : 0;
+                    params.NonRTPC.iListenGroups = i == 0 ? 0 : 1;
+                });
+            const bool bFeederVirtual = uVirtual == 0;
+            AkReal32 reentryDiff = 0.0f, drift = 0.0f, gainBefore = 1.0f;
+            double skipSeconds = 0.0, executeSeconds = 0.0;
+            AkUInt32 uSkips = 0, uExecutes = 0;
+            for (AkUInt32 block = 0; block < uBlocks; ++block)
+            {
+                const bool bVirtual = block >= uSkipFrom && block < uSkipTo;
+                // Swells and fades (peaks at block 187) so the follower has to attack and release across the skip
+                const AkReal32 level = 0.5f + 0.45f * sinf(6.2831853f * block / 150.0f);
+                for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                {
+                    const AkUInt32 t = block * uFrames + frame;
+                    for (AkUInt32 channel = 0; channel < 2; ++channel)
+                    {
+                        set.inputs[0]->GetChannel(channel)[frame] = bFeederVirtual && bVirtual ? 0.0f : level * sinf(0.05f * t);
+                        set.inputs[1]->GetChannel(channel)[frame] = set.inputs[2]->GetChannel(channel)[frame] = 0.25f;
+                    }
+                }
+
+                set.global.BeginRender();
+                for (AkUInt32 i = 0; i < 3; ++i)
+                {
+                    set.RewindBuffers(i);
+                    Timer timer;
+                    if (bVirtual && i == uVirtual)
+                    {
+                        AkUInt32 uSkip = uFrames;
+                        set.effects[i]->TimeSkip(uSkip);
+                        skipSeconds += timer.Seconds();
+                        ++uSkips;
+                    }
+                    else
+                    {
+                        set.effects[i]->Execute(set.inputs[i].get(), 0, set.outputs[i].get());
+                        if (i == 2)
+                        {
+                            executeSeconds += timer.Seconds();
+                            ++uExecutes;
+                        }
+                    }
+                }
+                set.global.EndRender();
+
+                const AkReal32 gain1 = set.outputs[1]->GetChannel(0)[uFrames - 1] / 0.25f;
+                if (!bFeederVirtual && block == uSkipTo)
+                {
+                    for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                    {
+                        const AkReal32 diff = 20.0f * log10f(set.outputs[2]->GetChannel(0)[frame] / set.outputs[1]->GetChannel(0)[frame]);
+                        reentryDiff = AkMax(reentryDiff, fabsf(diff));
+                    }
+                }
+                if (bFeederVirtual)
+                {
+                    // The feeder goes virtual at the top of the swell and its last block keeps
+                    // playing into the sidechain, so the gain must not move
+                    if (block == uSkipFrom - 1)
+                        gainBefore = gain1;
+                    else if (bVirtual)
+                        drift = AkMax(drift, fabsf(20.0f * log10f(gain1 / gainBefore)));
+                }
+            }
+
+            const bool bCaseOk = bFeederVirtual ? drift < 0.5f : reentryDiff < 0.1f;
+            bOk = bOk && bCaseOk;
+            printf("%20s %22.4f %22.4f %14.1f %14.1f %10s\n", bFeederVirtual ? "feeding instance" : "ducked instance",
+                reentryDiff, drift, uSkips ? skipSeconds * 1e9 / uSkips : 0.0, uExecutes ? executeSeconds * 1e9 / uExecutes : 0.0, bCaseOk ? "ok" : "FAILED");
+        }
+        return bOk;
+    }
+
+    // RTPC sweeps: a threshold moved every block must glide across the block, not step at its
+    // start. The largest gain step between adjacent frames while sweeping is compared with
+    // the gain change per block; held parameters must cost no more than before.
+    bool checkCurveRamp(const Options& in_options)
+    {
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uSettle = 100, uSweep = 100;
+        const AkReal32 fFrom = -40.0f, fTo = -20.0f;
+
+        printf("\nThreshold sweep, %u frames, %.0f to %.0f dB over %u blocks\n", uFrames, fFrom, fTo, uSweep);
+        printf("%12s %20s %20s %16s %16s %10s\n", "control rate", "gain dB per block", "max frame step dB", "ns/execute held", "ns/execute swept", "result");
+
+        bool bOk = true;
+        for (AkInt32 iControlRate : { 1, 16 })
+        {
+            // Instance 0 feeds a steady tone; 1 and 2 listen, 1 at the top rank so it gets the
+            // full ratio, and 1's threshold is swept
+            InstanceSet set(3, uFrames, iControlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                {
+                    params.RTPC.fThreshold = fFrom;
+                    params.RTPC.fMaxRatio = 8.0f;
+                    params.RTPC.fPriorityRank = i == 1 ? 1.0f : 10.0f;
+                    params.NonRTPC.iFeedGroups = i == 0 ? 1 : 0;
+                    params.NonRTPC.iListenGroups = i == 0 ? 0 : 1;
+                });
+
+            AkReal32 maxStep = 0.0f, previousGain = 0.0f, gainStart = 0.0f, gainEnd = 0.0f;
+            double heldSeconds = 0.0, sweptSeconds = 0.0;
+            for (AkUInt32 block = 0; block < uSettle + uSweep; ++block)
+            {
+                const bool bSweeping = block >= uSettle;
+                if (bSweeping)
+                {
+                    AkReal32 fThreshold = fFrom + (fTo - fFrom) * (AkReal32)(block - uSettle + 1) / (AkReal32)uSweep;
+                    set.params[1]->SetParam(PARAM_THRESHOLD_ID, &fThreshold, sizeof(fThreshold));
+                }
+                for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                {
+                    const AkUInt32 t = block * uFrames + frame;
+                    for (AkUInt32 channel = 0; channel < 2; ++channel)
+                    {
+                        set.inputs[0]->GetChannel(channel)[frame] = 0.5f * sinf(0.05f * t);
+                        set.inputs[1]->GetChannel(channel)[frame] = set.inputs[2]->GetChannel(channel)[frame] = 0.25f;
+                    }
+                }
+
+                set.global.BeginRender();
+                for (AkUInt32 i = 0; i < 3; ++i)
+                {
+                    set.RewindBuffers(i);
+                    Timer timer;
+                    set.effects[i]->Execute(set.inputs[i].get(), 0, set.outputs[i].get());
+                    if (i == 1)
+                        (bSweeping ? sweptSeconds : heldSeconds) += timer.Seconds();
+                }
+                set.global.EndRender();
+
+                for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                {
+                    const AkReal32 gain = 20.0f * log10f(set.outputs[1]->GetChannel(0)[frame] / 0.25f);
+                    if (bSweeping)
+                        maxStep = AkMax(maxStep, fabsf(gain - previousGain));
+                    previousGain = gain;
+                }
+                if (block == uSettle - 1)
+                    gainStart = previousGain;
+                gainEnd = previousGain;
+            }
+
+            // A step at each block start would be the whole change per block
+            const AkReal32 perBlock = fabsf(gainEnd - gainStart) / (AkReal32)uSweep;
+            const bool bCaseOk = perBlock > 0.0f && maxStep < 0.1f * perBlock;
+            bOk = bOk && bCaseOk;
+            printf("%12d %20.4f %20.5f %16.1f %16.1f %10s\n", iControlRate, perBlock, maxStep,
+                heldSeconds * 1e9 / uSettle, sweptSeconds * 1e9 / uSweep, bCaseOk ? "ok" : "FAILED");
+        }
+        return bOk;
+    }
+
+    // Multiband: with no sidechain the bands must sum back flat; a low sidechain must duck a
+    // low tone but leave a high one alone, where a single band ducks both; and the split
+    // should cost at most about 3x a single band.
+    bool checkMultiband(const Options& in_options)
+    {
+        const AkUInt16 uFrames = 256;
+        const AkReal32 crossovers[] = { 250.0f, 2000.0f, 8000.0f };
+        auto configure = [&](AkInt32 iBands)
+        {
+            return [=](SidechainCompressorFXParams& params, AkUInt32)
+            {
+                params.NonRTPC.iNumBands = iBands;
+                params.NonRTPC.fCrossover1 = crossovers[0];
+                params.NonRTPC.fCrossover2 = crossovers[1];
+                params.NonRTPC.fCrossover3 = crossovers[2];
+            };
+        };
+
+        printf("\nMultiband, crossovers %.0f / %.0f / %.0f Hz, %u frames\n", crossovers[0], crossovers[1], crossovers[2], uFrames);
+        printf("%6s %16s %16s %16s %14s %10s %10s\n", "bands", "sum ripple dB", "low tone dB", "high tone dB", "ns/instance", "cost", "result");
+
+        // Cost against a single band, on the usual load. The band counts take turns over a few
+        // rounds and each keeps its best, so a slow stretch of the machine does not land on one.
+        const AkUInt32 uRounds = 5;
+        std::vector<std::unique_ptr<InstanceSet>> costSets;
+        std::vector<double> costSeconds;
+        for (AkInt32 iBands = 1; iBands <= (AkInt32)SidechainCrossover::kMaxBands; ++iBands)
+        {
+            costSets.emplace_back(new InstanceSet(64, uFrames, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1, configure(iBands)));
+            costSeconds.push_back(1e9);
+        }
+        for (AkUInt32 round = 0; round < uRounds; ++round)
+        {
+            for (size_t b = 0; b < costSets.size(); ++b)
+            {
+                InstanceSet& set = *costSets[b];
+                costSeconds[b] = AkMin(costSeconds[b], timeLoop(AkMax(in_options.minTime / uRounds, 0.01), [&]() { set.Render(); }) / set.effects.size());
+            }
+        }
+        costSets.clear();
+
+        bool bOk = true;
+        for (AkInt32 iBands = 1; iBands <= (AkInt32)SidechainCrossover::kMaxBands; ++iBands)
+        {
+            // Impulse response of a lone instance: nothing on its sidechain, so unity gain
+            const AkUInt32 uResponse = 16 * uFrames;
+            std::vector<AkReal32> response(uResponse);
+            {
+                InstanceSet set(1, uFrames, 1, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                    [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                    {
+                        configure(iBands)(params, i);
+                        params.NonRTPC.iFeedGroups = 0;
+                    });
+                for (AkUInt32 block = 0; block < uResponse / uFrames; ++block)
+                {
+                    for (AkUInt32 channel = 0; channel < 2; ++channel)
+                    {
+                        AkReal32* pIn = set.inputs[0]->GetChannel(channel);
+                        memset(pIn, 0, sizeof(AkReal32) * uFrames);
+                        pIn[0] = block == 0 ? 1.0f : 0.0f;
+                    }
+                    set.Render();
+                    memcpy(&response[block * uFrames], set.outputs[0]->GetChannel(1), sizeof(AkReal32) * uFrames);
+                }
+            }
+            AkReal32 ripple = 0.0f;
+            for (AkReal32 hz = 20.0f; hz < 20000.0f; hz *= 1.1f)
+            {
+                double re = 0.0, im = 0.0;
+                for (AkUInt32 n = 0; n < uResponse; ++n)
+                {
+                    re += response[n] * cos(6.283185307179586 * hz * n / kSampleRate);
+                    im -= response[n] * sin(6.283185307179586 * hz * n / kSampleRate);
+                }
+                ripple = AkMax(ripple, fabsf(10.0f * log10f((AkReal32)(re * re + im * im))));
+            }
+
+            // Instance 0 feeds a 60 Hz tone; 1 listens to it through a 100 Hz tone, 2 through a
+            // 5 kHz one. Level change of each listener over the last blocks.
+            AkReal32 toneDb[2] = {};
+            {
+                InstanceSet set(3, uFrames, 1, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                    [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                    {
+                        configure(iBands)(params, i);
+                        params.RTPC.fThreshold = -30.0f;
+                        params.RTPC.fMaxRatio = 8.0f;
+                        params.RTPC.fPriorityRank = i == 0 ? 10.0f : 1.0f;
+                        params.NonRTPC.iFeedGroups = i == 0 ? 1 : 0;
+                        params.NonRTPC.iListenGroups = i == 0 ? 0 : 1;
+                    });
+                const AkReal32 toneHz[3] = { 60.0f, 100.0f, 5000.0f };
+                double inEnergy[2] = {}, outEnergy[2] = {};
+                const AkUInt32 uBlocks = 200;
+                for (AkUInt32 block = 0; block < uBlocks; ++block)
+                {
+                    for (AkUInt32 i = 0; i < 3; ++i)
+                    {
+                        for (AkUInt32 channel = 0; channel < 2; ++channel)
+                        {
+                            AkReal32* pIn = set.inputs[i]->GetChannel(channel);
+                            for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                                pIn[frame] = 0.5f * sinf(6.2831853f * toneHz[i] * (AkReal32)((block * uFrames + frame) % kSampleRate) / kSampleRate);
+                        }
+                    }
+                    set.Render();
+                    for (AkUInt32 i = 1; i < 3 && block >= uBlocks / 2; ++i)
+                    {
+                        for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                        {
+                            inEnergy[i - 1] += (double)set.inputs[i]->GetChannel(0)[frame] * set.inputs[i]->GetChannel(0)[frame];
+                            outEnergy[i - 1] += (double)set.outputs[i]->GetChannel(0)[frame] * set.outputs[i]->GetChannel(0)[frame];
+                        }
+                    }
+                }
+                for (AkUInt32 i = 0; i < 2; ++i)
+                    toneDb[i] = 10.0f * log10f((AkReal32)(outEnergy[i] / inEnergy[i]));
+            }
+
+            const double seconds = costSeconds[iBands - 1];
+            const double cost = seconds / costSeconds[0];
+
+            // A single band ducks both tones alike; split, the high tone is in a band the
+            // sidechain does not reach
+            const bool bFlat = ripple < 0.01f;
+            const bool bSelective = iBands == 1 ? fabsf(toneDb[0] - toneDb[1]) < 0.5f : toneDb[0] < -3.0f && toneDb[1] > -0.5f;
+            // The cost is reported, not checked: 2, 3 and 4 bands measure about 1.9x, 2.3x and
+            // 2.8x a single band on a quiet machine, and a busy one has pushed 4 bands past 4x
+            const bool bCaseOk = bFlat && bSelective;
+            bOk = bOk && bCaseOk;
+            printf("%6d %16.4f %16.2f %16.2f %14.1f %9.2fx %10s\n", iBands, ripple, toneDb[0], toneDb[1], seconds * 1e9, cost,
+                bCaseOk ? "ok" : !bFlat ? "NOT FLAT" : "FAILED");
+        }
+        return bOk;
+    }
+
+    // Key filter on the summed sidechain. A lone feeder plays a 60 Hz rumble or a 1 kHz voice
+    // and a listener reports how far it is ducked; the filter should take the rumble out of the
+    // detector and leave the voice alone. The cost is one filter per bus, not per voice.
+    bool checkKeyFilter(const Options& in_options)
+    {
+        const AkUInt16 uFrames = 256;
+        struct Case
+        {
+            const char* name;
+            SidechainKeyFilter::Type type;
+            AkReal32 frequency;
+            AkReal32 q;
+            AkReal32 gainDb;
+        };
+        const Case cases[] = {
+            { "off", SidechainKeyFilter::Type_Off, 200.0f, 0.707f, 0.0f },
+            { "high pass 200", SidechainKeyFilter::Type_HighPass, 200.0f, 0.707f, 0.0f },
+            { "band pass 1k", SidechainKeyFilter::Type_BandPass, 1000.0f, 1.0f, 0.0f },
+            { "low shelf -24", SidechainKeyFilter::Type_LowShelf, 200.0f, 0.707f, -24.0f },
+        };
+        auto configure = [](const Case& keyCase)
+        {
+            return [=](SidechainCompressorFXParams& params, AkUInt32)
+            {
+                params.NonRTPC.iKeyFilter = keyCase.type;
+                params.NonRTPC.fKeyFrequency = keyCase.frequency;
+                params.NonRTPC.fKeyQ = keyCase.q;
+                params.NonRTPC.fKeyGain = keyCase.gainDb;
+            };
+        };
+
+        printf("\nKey filter, %u frames, feeder at -9 dBFS, threshold -30 dB\n", uFrames);
+        printf("%14s %16s %16s %14s %10s %10s\n", "filter", "rumble dB", "voice dB", "ns/instance", "cost", "result");
+
+        // Cost on the usual load, best of a few alternating rounds
+        const AkUInt32 uRounds = 5;
+        std::vector<std::unique_ptr<InstanceSet>> costSets;
+        std::vector<double> costSeconds;
+        for (const Case& keyCase : cases)
+        {
+            costSets.emplace_back(new InstanceSet(64, uFrames, in_options.controlRate, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1, configure(keyCase)));
+            costSeconds.push_back(1e9);
+        }
+        for (AkUInt32 round = 0; round < uRounds; ++round)
+        {
+            for (size_t c = 0; c < costSets.size(); ++c)
+            {
+                InstanceSet& set = *costSets[c];
+                costSeconds[c] = AkMin(costSeconds[c], timeLoop(AkMax(in_options.minTime / uRounds, 0.01), [&]() { set.Render(); }) / set.effects.size());
+            }
+        }
+        costSets.clear();
+
+        // Level change of a listener over the last blocks, with the feeder on one tone. Two
+        // listeners of the same rank, so each sits at the 50th percentile.
+        auto duckedDb = [&](const Case& keyCase, AkReal32 toneHz)
+        {
+            InstanceSet set(3, uFrames, 1, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                {
+                    configure(keyCase)(params, i);
+                    params.RTPC.fThreshold = -30.0f;
+                    params.RTPC.fMaxRatio = 8.0f;
+                    params.RTPC.fPriorityRank = i == 0 ? 10.0f : 1.0f;
+                    params.NonRTPC.iFeedGroups = i == 0 ? 1 : 0;
+                    params.NonRTPC.iListenGroups = i == 0 ? 0 : 1;
+                });
+            const AkReal32 hz[3] = { toneHz, 440.0f, 440.0f };
+            double inEnergy = 0.0, outEnergy = 0.0;
+            const AkUInt32 uBlocks = 200;
+            for (AkUInt32 block = 0; block < uBlocks; ++block)
+            {
+                for (AkUInt32 i = 0; i < 3; ++i)
+                {
+                    for (AkUInt32 channel = 0; channel < 2; ++channel)
+                    {
+                        AkReal32* pIn = set.inputs[i]->GetChannel(channel);
+                        for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                            pIn[frame] = 0.5f * sinf(6.2831853f * hz[i] * (AkReal32)((block * uFrames + frame) % kSampleRate) / kSampleRate);
+                    }
+                }
+                set.Render();
+                for (AkUInt32 frame = 0; frame < uFrames && block >= uBlocks / 2; ++frame)
+                {
+                    inEnergy += (double)set.inputs[1]->GetChannel(0)[frame] * set.inputs[1]->GetChannel(0)[frame];
+                    outEnergy += (double)set.outputs[1]->GetChannel(0)[frame] * set.outputs[1]->GetChannel(0)[frame];
+                }
+            }
+            return 10.0f * log10f((AkReal32)(outEnergy / inEnergy));
+        };
+
+        bool bOk = true;
+        AkReal32 offRumbleDb = 0.0f, offVoiceDb = 0.0f;
+        for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+        {
+            const Case& keyCase = cases[c];
+            const AkReal32 rumbleDb = duckedDb(keyCase, 60.0f);
+            const AkReal32 voiceDb = duckedDb(keyCase, 1000.0f);
+            if (keyCase.type == SidechainKeyFilter::Type_Off)
+            {
+                offRumbleDb = rumbleDb;
+                offVoiceDb = voiceDb;
+            }
+            const double cost = costSeconds[c] / costSeconds[0];
+
+            // Unfiltered, rumble and voice duck alike. Filtered, the voice still ducks as hard
+            // while the rumble is cut by at least half in dB. The cost is reported, not checked:
+            // one filter per bus is smaller than the run-to-run noise of the per-voice cost,
+            // which has measured anywhere from 0.93x to 1.29x of unfiltered.
+            const bool bRumble = keyCase.type == SidechainKeyFilter::Type_Off ? rumbleDb < -3.0f : rumbleDb > 0.5f * offRumbleDb;
+            const bool bVoice = keyCase.type == SidechainKeyFilter::Type_Off ? fabsf(voiceDb - rumbleDb) < 0.5f : fabsf(voiceDb - offVoiceDb) < 1.0f;
+            const bool bCaseOk = bRumble && bVoice;
+            bOk = bOk && bCaseOk;
+            printf("%14s %16.2f %16.2f %14.1f %9.2fx %10s\n", keyCase.name, rumbleDb, voiceDb, costSeconds[c] * 1e9, cost,
+                bCaseOk ? "ok" : !bRumble ? "RUMBLE" : "VOICE");
+        }
+        return bOk;
+    }
+
+    // Block energy: feeders publish one mean square per channel per block instead of their
+    // samples. Publishing must cost well under the sample path, the detected level must stay
+    // within a dB of it for uncorrelated feeders, and with a key filter or bands, which need
+    // the samples, the bus must fall back to them and render exactly as the sample path does.
+    bool checkBlockEnergy(const Options& in_options)
+    {
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uFeeders = 8;
+
+        printf("\nBlock energy, %u feeders on distinct tones, %u frames\n", uFeeders, uFrames);
+        printf("%10s %18s %14s %16s %14s %10s\n", "setup", "publish ns/inst", "cost", "listener dB", "max diff", "result");
+
+        // Publishing alone, on the bus directly, best of a few alternating rounds
+        HostGlobalContext global(kSampleRate, uFrames);
+        auto sharedBuffer = GlobalManager::acquireBuffer(&global, 0);
+        std::vector<std::unique_ptr<HostAudioBuffer>> inputs;
+        std::vector<AkInt32> slots[2];
+        for (AkUInt32 i = 0; i < 64; ++i)
+        {
+            inputs.emplace_back(new HostAudioBuffer(kNumChannels, uFrames));
+            inputs.back()->uValidFrames = uFrames;
+            fillSignal(*inputs.back(), i, uFrames);
+            slots[0].push_back(sharedBuffer->acquireSlot(kNumChannels, uFrames, SidechainContribution_Samples));
+            slots[1].push_back(sharedBuffer->acquireSlot(kNumChannels, uFrames, SidechainContribution_BlockEnergy));
+        }
+        double publishSeconds[2] = { 1e9, 1e9 };
+        const AkUInt32 uRounds = 5;
+        for (AkUInt32 round = 0; round < uRounds; ++round)
+        {
+            for (AkUInt32 mode = 0; mode < 2; ++mode)
+            {
+                publishSeconds[mode] = AkMin(publishSeconds[mode], timeLoop(AkMax(in_options.minTime / uRounds, 0.01), [&]()
+                {
+                    const AkUInt32 epoch = sharedBuffer->getWriteEpoch();
+                    for (size_t i = 0; i < inputs.size(); ++i)
+                        sharedBuffer->AddToSharedBuffer(slots[mode][i], epoch, inputs[i].get(), 0, uFrames, 0);
+                }) / inputs.size());
+            }
+        }
+        for (AkUInt32 mode = 0; mode < 2; ++mode)
+        {
+            for (AkInt32 slot : slots[mode])
+                sharedBuffer->releaseSlot(slot);
+        }
+        sharedBuffer.reset();
+        GlobalManager::releaseBuffer(&global, 0);
+
+        // Feeders of rank 10 on their own tones, two listeners of rank 1 on 440 Hz. Level change
+        // of the first listener over the last blocks, and its last block for the fallbacks.
+        struct Result
+        {
+            AkReal32 listenerDb;
+            std::vector<AkReal32> lastBlock;
+        };
+        auto render = [&](SidechainContribution contribution, AkInt32 iBands, SidechainKeyFilter::Type keyType)
+        {
+            InstanceSet set(uFeeders + 2, uFrames, 1, AkChannelConfig(2, AK_SPEAKER_SETUP_STEREO), SidechainChannelLink_Unlinked, 1,
+                [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                {
+                    const bool bFeeder = i < uFeeders;
+                    params.RTPC.fThreshold = -30.0f;
+                    params.RTPC.fMaxRatio = 8.0f;
+                    params.RTPC.fPriorityRank = bFeeder ? 10.0f : 1.0f;
+                    params.NonRTPC.iFeedGroups = bFeeder ? 1 : 0;
+                    params.NonRTPC.iListenGroups = bFeeder ? 0 : 1;
+                    params.NonRTPC.iContribution = contribution;
+                    params.NonRTPC.iNumBands = iBands;
+                    params.NonRTPC.iKeyFilter = keyType;
+                });
+            Result result;
+            double inEnergy = 0.0, outEnergy = 0.0;
+            const AkUInt32 uBlocks = 200;
+            for (AkUInt32 block = 0; block < uBlocks; ++block)
+            {
+                for (AkUInt32 i = 0; i < uFeeders + 2; ++i)
+                {
+                    const AkReal32 hz = i < uFeeders ? 97.0f * (AkReal32)(i + 1) : 440.0f;
+                    const AkReal32 level = i < uFeeders ? 0.5f / sqrtf((AkReal32)uFeeders) : 0.5f;
+                    for (AkUInt32 channel = 0; channel < 2; ++channel)
+                    {
+                        AkReal32* pIn = set.inputs[i]->GetChannel(channel);
+                        for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                            pIn[frame] = level * sinf(6.2831853f * hz * (AkReal32)((block * uFrames + frame) % kSampleRate) / kSampleRate);
+                    }
+                }
+                set.Render();
+                for (AkUInt32 frame = 0; frame < uFrames && block >= uBlocks / 2; ++frame)
+                {
+                    inEnergy += (double)set.inputs[uFeeders]->GetChannel(0)[frame] * set.inputs[uFeeders]->GetChannel(0)[frame];
+                    outEnergy += (double)set.outputs[uFeeders]->GetChannel(0)[frame] * set.outputs[uFeeders]->GetChannel(0)[frame];
+                }
+            }
+            result.listenerDb = 10.0f * log10f((AkReal32)(outEnergy / inEnergy));
+            result.lastBlock.assign(set.outputs[uFeeders]->GetChannel(0), set.outputs[uFeeders]->GetChannel(0) + uFrames);
+            return result;
+        };
+        auto maxDiff = [](const Result& a, const Result& b)
+        {
+            AkReal32 diff = 0.0f;
+            for (size_t frame = 0; frame < a.lastBlock.size(); ++frame)
+                diff = AkMax(diff, fabsf(a.lastBlock[frame] - b.lastBlock[frame]));
+            return diff;
+        };
+
+        bool bOk = true;
+        const double cost = publishSeconds[1] / publishSeconds[0];
+        {
+            // Tones of different pitch are uncorrelated over a block, so their energies add
+            const Result samples = render(SidechainContribution_Samples, 1, SidechainKeyFilter::Type_Off);
+            const Result energy = render(SidechainContribution_BlockEnergy, 1, SidechainKeyFilter::Type_Off);
+            // Typically a fifth of the sample path; the bound leaves room for a busy machine
+            const bool bCaseOk = samples.listenerDb < -3.0f && fabsf(energy.listenerDb - samples.listenerDb) < 1.0f && cost < 0.75;
+            bOk = bOk && bCaseOk;
+            printf("%10s %18.1f %13.2fx %16.2f %14s %10s\n", "samples", publishSeconds[0] * 1e9, 1.0, samples.listenerDb, "-", "-");
+            printf("%10s %18.1f %13.2fx %16.2f %14s %10s\n", "energy", publishSeconds[1] * 1e9, cost, energy.listenerDb, "-",
+                bCaseOk ? "ok" : cost < 0.75 ? "LEVEL" : "TOO SLOW");
+        }
+        const struct
+        {
+            const char* name;
+            AkInt32 iBands;
+            SidechainKeyFilter::Type keyType;
+        } fallbacks[] = {
+            { "2 bands", 2, SidechainKeyFilter::Type_Off },
+            { "key HP", 1, SidechainKeyFilter::Type_HighPass },
+        };
+        for (const auto& fallback : fallbacks)
+        {
+            const Result samples = render(SidechainContribution_Samples, fallback.iBands, fallback.keyType);
+            const Result energy = render(SidechainContribution_BlockEnergy, fallback.iBands, fallback.keyType);
+            const AkReal32 diff = maxDiff(samples, energy);
+            const bool bCaseOk = diff == 0.0f && energy.listenerDb == samples.listenerDb;
+            bOk = bOk && bCaseOk;
+            printf("%10s %18s %14s %16.2f %14.2e %10s\n", fallback.name, "-", "-", energy.listenerDb, diff, bCaseOk ? "ok" : "DIFFERS");
+        }
+        return bOk;
+    }
+
+    // Execute against the double-precision reference (SidechainCompressorReference.h) on
+    // synthetic signals and the DuckingProject WAVs. Every fast path has a budget, in dB of
+    // gain and in absolute sample deviation; an optimization that needs a wider one has
+    // changed what the plug-in computes, not only how fast.
+    bool checkReference(const Options&)
+    {
+        typedef SidechainReference::Voice Voice;
+        const AkUInt16 uFrames = 256;
+
+        struct FastPath
+        {
+            const char* name;
+            AkInt32 iControlRate;
+            AkReal32 fTableStep;
+            AkReal32 maxGainDb;         // Budget: gain error, dB, wherever the input is above -80 dBFS
+            AkReal32 maxSample;         // Budget: output sample deviation
+        };
+        // Full rate and the table are precision, and get about ten times and five times what
+        // they measure (2e-4 and 1e-3 dB). Control rate's error is the gain interpolated
+        // between points where a gated onset crosses the knee, 0.56 dB on the bursts; ten times
+        // that would pass a broken follower, so it gets about twice, like checkControlRate.
+        const FastPath paths[] = {
+            { "full rate", 1, 0.0f, 0.002f, 2e-5f },
+            { "control rate 16", 16, 0.0f, 1.0f, 3e-2f },
+            { "table 0.1 dB", 1, 0.1f, 0.005f, 2e-4f },
+        };
+
+        // A whole number of audio frames of silence for every voice
+        auto makeVoices = [&](AkUInt32 uVoices, AkUInt32 uChannels, AkUInt32 uLength, const double* ranks)
+        {
+            std::vector<Voice> voices(uVoices);
+            for (AkUInt32 v = 0; v < uVoices; ++v)
+            {
+                voices[v].rank = ranks[v];
+                voices[v].input.assign(uChannels, std::vector<AkReal32>((uLength + uFrames - 1) / uFrames * uFrames, 0.0f));
+            }
+            return voices;
+        };
+        auto tone = [](AkReal32 amplitude, AkReal32 hz, AkUInt32 rate, AkUInt32 frame)
+        {
+            return amplitude * sinf(6.2831853f * hz * (AkReal32)(frame % rate) / (AkReal32)rate);
+        };
+
+        struct Signal
+        {
+            std::string name;
+            SidechainReference::Settings settings;
+            std::vector<Voice> voices;
+        };
+        std::vector<Signal> signals;
+        SidechainReference::Settings defaults;
+        defaults.threshold = -30.0;
+        defaults.maxRatio = 8.0;
+        defaults.frames = uFrames;
+
+        // A steady tone under gated bursts: attack, release and the ratio at both ends of the ranks
+        {
+            const double ranks[] = { 1.0, 10.0 };
+            Signal signal = { "bursts", defaults, makeVoices(2, 2, 2 * kSampleRate, ranks) };
+            for (AkUInt32 channel = 0; channel < 2; ++channel)
+            {
+                for (AkUInt32 frame = 0; frame < signal.voices[0].input[channel].size(); ++frame)
+                {
+                    signal.voices[0].input[channel][frame] = tone(0.25f, 440.0f, kSampleRate, frame);
+                    const bool bOn = frame % (kSampleRate / 2) < kSampleRate / 5;
+                    signal.voices[1].input[channel][frame] = bOn ? tone(0.7f, 1000.0f + 300.0f * channel, kSampleRate, frame) : 0.0f;
+                }
+            }
+            signals.push_back(std::move(signal));
+        }
+
+        // Noise swept from -60 dBFS to 0 and back through the knee, three ranks for three ratios
+        for (AkUInt32 onePole = 0; onePole < 2; ++onePole)
+        {
+            const double ranks[] = { 1.0, 5.5, 10.0 };
+            Signal signal = { onePole ? "sweep, one-pole" : "sweep", defaults, makeVoices(3, 2, 4 * kSampleRate, ranks) };
+            signal.settings.onePole = onePole != 0;
+            AkUInt32 seed = 0x2545F491u;
+            const size_t uLength = signal.voices[0].input[0].size();
+            for (AkUInt32 frame = 0; frame < uLength; ++frame)
+            {
+                const AkReal32 position = 2.0f * (AkReal32)frame / (AkReal32)uLength;
+                const AkReal32 sweepDb = -60.0f + 60.0f * (position < 1.0f ? position : 2.0f - position);
+                for (AkUInt32 channel = 0; channel < 2; ++channel)
+                {
+                    seed = seed * 1664525u + 1013904223u;
+                    signal.voices[0].input[channel][frame] = tone(0.1f, 220.0f, kSampleRate, frame);
+                    signal.voices[1].input[channel][frame] = tone(0.1f, 330.0f, kSampleRate, frame);
+                    signal.voices[2].input[channel][frame] = powf(10.0f, sweepDb / 20.0f) * ((seed >> 8) / 8388608.0f - 1.0f);
+                }
+            }
+            signals.push_back(std::move(signal));
+        }
+
+        // 5.1 on the total power of the sidechain
+        {
+            const double ranks[] = { 1.0, 4.0, 10.0 };
+            Signal signal = { "5.1 sum link", defaults, makeVoices(3, 6, 2 * kSampleRate, ranks) };
+            signal.settings.link = SidechainChannelLink_Sum;
+            for (AkUInt32 v = 0; v < 3; ++v)
+            {
+                for (AkUInt32 channel = 0; channel < 6; ++channel)
+                {
+                    for (AkUInt32 frame = 0; frame < signal.voices[v].input[channel].size(); ++frame)
+                    {
+                        const bool bOn = v < 2 || frame % kSampleRate < kSampleRate / 3;
+                        signal.voices[v].input[channel][frame] = bOn ? tone(0.15f, 110.0f * (v + 1) + 50.0f * channel, kSampleRate, frame) : 0.0f;
+                    }
+                }
+            }
+            signals.push_back(std::move(signal));
+        }
+
+        // The project's sounds: two elevator loops under a quack repeated every half second
+        {
+            const char* files[] = { "ElevatorLoop1.wav", "ElevatorLoop2.wav", "QuackSFX.wav" };
+            HostWavReader readers[3];
+            bool bFound = true;
+            for (AkUInt32 v = 0; v < 3; ++v)
+            {
+                std::string error;
+                bFound = bFound && readers[v].Open((std::string(SIDECHAIN_DUCKING_PROJECT_DIR "/Originals/SFX/") + files[v]).c_str(), error)
+                    && readers[v].GetNumChannels() == 2 && readers[v].GetSampleRate() == readers[0].GetSampleRate();
+            }
+            if (bFound)
+            {
+                const AkUInt32 uRate = readers[0].GetSampleRate();
+                const double ranks[] = { 1.0, 5.0, 10.0 };
+                Signal signal = { "DuckingProject SFX", defaults, makeVoices(3, 2, 4 * uRate, ranks) };
+                signal.settings.sampleRate = uRate;
+                const size_t uLength = signal.voices[0].input[0].size();
+                HostAudioBuffer buffer(2, uFrames);
+                for (AkUInt32 v = 0; v < 3; ++v)
+                {
+                    const AkUInt32 uPeriod = v == 2 ? uRate / 2 : (AkUInt32)readers[v].GetNumFrames();
+                    for (size_t start = 0; start < uLength; start += uFrames)
+                    {
+                        buffer.uValidFrames = 0;
+                        readers[v].Read(buffer, uFrames);
+                        for (AkUInt32 channel = 0; channel < 2; ++channel)
+                            memcpy(&signal.voices[v].input[channel][start], buffer.GetChannel(channel), sizeof(AkReal32) * uFrames);
+                    }
+                    // The quack again every period
+                    for (size_t frame = uPeriod; frame < uLength && v == 2; ++frame)
+                    {
+                        for (AkUInt32 channel = 0; channel < 2; ++channel)
+                            signal.voices[v].input[channel][frame] = signal.voices[v].input[channel][frame % uPeriod];
+                    }
+                }
+                signals.push_back(std::move(signal));
+            }
+            else
+            {
+                printf("\n(DuckingProject SFX not found under %s, skipped)\n", SIDECHAIN_DUCKING_PROJECT_DIR);
+            }
+        }
+
+        printf("\nReference model, double precision, %u frames, threshold %.0f dB, max ratio %.0f\n", uFrames, defaults.threshold, defaults.maxRatio);
+        printf("%20s %16s %14s %14s %14s %14s %10s\n", "signal", "path", "max gain dB", "budget dB", "max sample", "budget", "result");
+
+        bool bOk = true;
+        for (Signal& signal : signals)
+        {
+            SidechainReference::render(signal.voices, signal.settings);
+            const AkUInt32 uChannels = (AkUInt32)signal.voices[0].input.size();
+            const size_t uLength = signal.voices[0].input[0].size();
+            AkReal32 deepestDb = 0.0f;
+            for (const Voice& voice : signal.voices)
+            {
+                for (const std::vector<double>& gains : voice.gainDb)
+                    deepestDb = AkMin(deepestDb, (AkReal32)*std::min_element(gains.begin(), gains.end()));
+            }
+
+            for (const FastPath& path : paths)
+            {
+                // The same voices through Execute, set up as the reference assumes
+                const SidechainReference::Settings& settings = signal.settings;
+                InstanceSet set((AkUInt32)signal.voices.size(), uFrames, path.iControlRate, HostAudioBuffer::DefaultConfig(uChannels), settings.link, 1,
+                    [&](SidechainCompressorFXParams& params, AkUInt32 i)
+                    {
+                        params.RTPC.fThreshold = (AkReal32)settings.threshold;
+                        params.RTPC.fMaxRatio = (AkReal32)settings.maxRatio;
+                        params.RTPC.fAttack = (AkReal32)settings.attackMs;
+                        params.RTPC.fRelease = (AkReal32)settings.releaseMs;
+                        params.RTPC.fPriorityRank = (AkReal32)signal.voices[i].rank;
+                        params.NonRTPC.fRMSWindow = (AkReal32)settings.windowMs;
+                        params.NonRTPC.iDetectorMode = settings.onePole ? SidechainDetector::Mode_OnePole : SidechainDetector::Mode_SlidingWindow;
+                        params.NonRTPC.fCurveTableStep = path.fTableStep;
+                    }, settings.sampleRate);
+
+                AkReal32 maxGainDb = 0.0f, maxSample = 0.0f;
+                for (size_t start = 0; start < uLength; start += uFrames)
+                {
+                    for (size_t v = 0; v < signal.voices.size(); ++v)
+                    {
+                        for (AkUInt32 channel = 0; channel < uChannels; ++channel)
+                            memcpy(set.inputs[v]->GetChannel(channel), &signal.voices[v].input[channel][start], sizeof(AkReal32) * uFrames);
+                    }
+                    set.Render();
+                    for (size_t v = 0; v < signal.voices.size(); ++v)
+                    {
+                        const Voice& voice = signal.voices[v];
+                        for (AkUInt32 channel = 0; channel < uChannels; ++channel)
+                        {
+                            const AkReal32* pOut = set.outputs[v]->GetChannel(channel);
+                            for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                            {
+                                const AkReal32 in = voice.input[channel][start + frame];
+                                maxSample = AkMax(maxSample, (AkReal32)fabs(pOut[frame] - voice.output[channel][start + frame]));
+                                if (fabsf(in) > 1e-4f)
+                                {
+                                    const double gainDb = 20.0 * log10(fabs((double)pOut[frame] / in));
+                                    maxGainDb = AkMax(maxGainDb, (AkReal32)fabs(gainDb - voice.gainDb[channel][start + frame]));
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // A signal that is never ducked proves nothing about the curve
+                const bool bDucked = deepestDb < -6.0f;
+                const bool bCaseOk = bDucked && maxGainDb <= path.maxGainDb && maxSample <= path.maxSample;
+                bOk = bOk && bCaseOk;
+                printf("%20s %16s %14.5f %14.3f %14.2e %14.0e %10s\n", signal.name.c_str(), path.name, maxGainDb, path.maxGainDb, maxSample, path.maxSample,
+                    bCaseOk ? "ok" : !bDucked ? "NOT DUCKED" : "OVER BUDGET");
+            }
+        }
+        return bOk;
+    }
+
+#ifndef AK_OPTIMIZED
+    // Metering rings: the audio thread renders while a consumer thread drains every instance.
+    // Every block must arrive exactly once and in order, or be counted as dropped.
+    bool checkMetering(const Options& in_options)
+    {
+        const AkUInt32 uInstances = 16;
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uRenderFrames = 20000;
+
+        InstanceSet set(uInstances, uFrames, in_options.controlRate);
+        std::atomic<bool> bDone(false);
+        std::vector<AkUInt64> received(uInstances, 0);
+        std::vector<AkUInt32> nextBlock(uInstances, 0);
+        std::atomic<AkUInt32> uOutOfOrder(0);
+        SidechainMeterBlock last = {};
+
+        auto drainAll = [&]()
+        {
+            SidechainMeterBlock blocks[64];
+            for (AkUInt32 i = 0; i < uInstances; ++i)
+            {
+                AkUInt32 uCount;
+                while ((uCount = set.effects[i]->DrainMeters(blocks, 64)) > 0)
+                {
+                    for (AkUInt32 b = 0; b < uCount; ++b)
+                    {
+                        // Drops leave gaps, never reorder
+                        if (blocks[b].uBlock < nextBlock[i])
+                            uOutOfOrder.fetch_add(1);
+                        nextBlock[i] = blocks[b].uBlock + 1;
+                    }
+                    received[i] += uCount;
+                    if (i == 0)
+                        last = blocks[uCount - 1];
+                }
+            }
+        };
+
+        std::thread consumer([&]()
+        {
+            while (!bDone.load(std::memory_order_acquire))
+            {
+                drainAll();
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+
+        Timer timer;
+        for (AkUInt32 frame = 0; frame < uRenderFrames; ++frame)
+            set.Render();
+        const double seconds = timer.Seconds();
+        bDone.store(true, std::memory_order_release);
+        consumer.join();
+        drainAll();
+
+        AkUInt64 uReceived = 0, uDropped = 0;
+        for (AkUInt32 i = 0; i < uInstances; ++i)
+        {
+            uReceived += received[i];
+            uDropped += set.effects[i]->GetDroppedMeters();
+        }
+        const bool bOk = uOutOfOrder.load() == 0 && uReceived + uDropped == (AkUInt64)uInstances * uRenderFrames;
+
+        printf("\nMetering rings, %u instances, %u frames of %u, concurrent consumer\n", uInstances, uRenderFrames, uFrames);
+        printf("%12s %12s %10s %14s %14s %10s\n", "produced", "received", "dropped", "out of order", "ns/instance", "result");
+        printf("%12llu %12llu %10llu %14u %14.1f %10s\n", (unsigned long long)uInstances * uRenderFrames, (unsigned long long)uReceived,
+            (unsigned long long)uDropped, uOutOfOrder.load(), seconds * 1e9 / ((double)uRenderFrames * uInstances), bOk ? "ok" : "FAILED");
+        printf("last block of instance 0: #%u, gain min %.2f dB max %.2f dB mean %.2f dB, detector %.2f dB\n", last.uBlock,
+            20.0f * log10f(last.fMinGain), 20.0f * log10f(last.fMaxGain), 20.0f * log10f(last.fMeanGain), 20.0f * log10f(AkMax(last.fDetector, 1.0e-12f)));
+        return bOk;
+    }
+#endif // !AK_OPTIMIZED
+
+    // Counts every heap and plug-in allocator call made while rendering thousands of frames,
+    // with parameters changing underneath (ranks, detector, link, control rate) and instances
+    // spread over several groups. Rendering must not allocate: returns false if it did.
+    bool checkRenderAllocations(const Options& in_options)
+    {
+        const AkUInt32 uInstances = 64;
+        const AkUInt16 uFrames = 256;
+        const AkUInt32 uRenderFrames = 10000;
+        AkChannelConfig config(6, AK_SPEAKER_SETUP_5_1);
+
+        InstanceSet set(uInstances, uFrames, in_options.controlRate, config, SidechainChannelLink_Unlinked, 4);
+        for (auto& context : set.contexts)
+            context->bCanPostMonitorData = true;
+        set.Render();
+
+        const AkUInt64 uHeapBefore = g_uNumHeapAllocs.load();
+        const AkUInt64 uPluginBefore = set.global.allocator.uNumAllocs;
+        for (AkUInt32 frame = 0; frame < uRenderFrames; ++frame)
+        {
+            if (frame % 50 == 0)
+            {
+                const AkUInt32 uStep = frame / 50;
+                SidechainCompressorFXParams* pParams = set.params[uStep % uInstances];
+                AkReal32 fRank = 1.0f + (uStep % 10);
+                AkReal32 fWindow = (uStep & 1) ? 50.0f : 10.0f;
+                AkInt32 iMode = (uStep >> 1) & 1;
+                AkInt32 iLink = uStep % 3;
+                AkInt32 iControlRate = (uStep & 2) ? 32 : 1;
+                pParams->SetParam(PARAM_PRIORITYRANK_ID, &fRank, sizeof(fRank));
+                pParams->SetParam(PARAM_RMSWINDOW_ID, &fWindow, sizeof(fWindow));
+                pParams->SetParam(PARAM_DETECTORMODE_ID, &iMode, sizeof(iMode));
+                pParams->SetParam(PARAM_CHANNELLINK_ID, &iLink, sizeof(iLink));
+                pParams->SetParam(PARAM_CONTROLRATE_ID, &iControlRate, sizeof(iControlRate));
+            }
+            set.Render();
+        }
+        const AkUInt64 uHeap = g_uNumHeapAllocs.load() - uHeapBefore;
+        const AkUInt64 uPlugin = set.global.allocator.uNumAllocs - uPluginBefore;
+
+        // Monitoring is on, so the packets are part of what must not allocate
+        const HostEffectContext& context = *set.contexts[0];
+        const SidechainMonitorPacket* pPacket = SidechainMonitorPacket::read(context.lastMonitorData, context.uLastMonitorDataSize);
+        const double secondsRendered = (double)uRenderFrames * uFrames / kSampleRate;
+
+        printf("\nRender allocations, %u instances, 4 groups, 5.1, %u frames of %u, monitoring on\n", uInstances, uRenderFrames, uFrames);
+        printf("%14s %18s %16s %14s %10s\n", "heap calls", "allocator calls", "packets/s", "packet bytes", "result");
+        printf("%14llu %18llu %16.1f %14u %10s\n", (unsigned long long)uHeap, (unsigned long long)uPlugin,
+            context.uNumMonitorPosts / secondsRendered, context.uLastMonitorDataSize, (uHeap + uPlugin) == 0 && pPacket ? "ok" : "FAILED");
+        if (pPacket)
+        {
+            printf("last packet: v%u, %u channels, %u instances ranked, percentile %.3f, ratio %.3f, ch0 sidechain %.4f gain %.4f\n",
+                pPacket->uVersion, pPacket->uNumChannels, pPacket->uNumInstances, pPacket->fPercentile, pPacket->fRatio,
+                pPacket->fSidechainRMS[0], pPacket->fGain[0]);
+        }
+        return (uHeap + uPlugin) == 0 && pPacket != nullptr;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    benchGainKernel(options);
+    benchDetector(options);
+    benchExecute(options);
+    benchChannelLayouts(options);
+    benchGroups(options);
+    benchSharedBuffer(options);
+
+    bool bOk = checkGainTable(options);
+    bOk = checkInstanceTable(options) && bOk;
+    bOk = checkBusMemory(options) && bOk;
+    bOk = checkLookahead(options) && bOk;
+    bOk = checkTimeSkip(options) && bOk;
+    bOk = checkCurveRamp(options) && bOk;
+    bOk = checkControlRate(options) && bOk;
+    bOk = checkMultiband(options) && bOk;
+    bOk = checkKeyFilter(options) && bOk;
+    bOk = checkBlockEnergy(options) && bOk;
+    bOk = checkReference(options) && bOk;
+    bOk = checkMixedBuffers(options) && bOk;
+    bOk = checkParallelRender(options) && bOk;
+    bOk = checkPartialGrowth(options) && bOk;
+    bOk = checkRenderAllocations(options) && bOk;
+#ifndef AK_OPTIMIZED
+    bOk = checkMetering(options) && bOk;
+#endif
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// Minimal host implementations of the AK plug-in contexts, so the SoundEnginePlugin
+// can be driven outside of the sound engine (benchmarks, offline tools).
+
+#pragma once
+
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+class HostAllocator : public AK::IAkPluginMemAlloc
+{
+public:
+    void* Malloc(size_t in_uSize, const char* in_pszFile, AkUInt32 in_uLine) override
+    {
+        ++uNumAllocs;
+        uNumBytes += in_uSize;
+        return malloc(in_uSize);
+    }
+
+    void Free(void* in_pMemAddress) override
+    {
+        free(in_pMemAddress);
+    }
+
+    void* Malign(size_t in_uSize, size_t in_uAlignment, const char* in_pszFile, AkUInt32 in_uLine) override
+    {
+        ++uNumAllocs;
+        uNumBytes += in_uSize;
+        return aligned_alloc(in_uAlignment, (in_uSize + in_uAlignment - 1) / in_uAlignment * in_uAlignment);
+    }
+
+    void FreeAligned(void* in_pMemAddress) override
+    {
+        free(in_pMemAddress);
+    }
+
+    AkUInt64 uNumAllocs = 0;
+    AkUInt64 uNumBytes = 0;                     // Requested over the allocator's life, frees not subtracted
+};
+
+/// Stands in for the sound engine's global context: keeps the registered global
+/// callbacks and fires them when the host calls BeginRender()/EndRender().
+class HostGlobalContext : public AK::IAkGlobalPluginContext
+{
+public:
+    HostGlobalContext(AkUInt32 in_uSampleRate, AkUInt16 in_uMaxFrames)
+        : uSampleRate(in_uSampleRate)
+        , uMaxFrames(in_uMaxFrames)
+    {
+    }
+
+    ~HostGlobalContext()
+    {
+        Fire(AkGlobalCallbackLocation_Term);
+    }
+
+    AKRESULT RegisterGlobalCallback(AkPluginType in_eType, AkUInt32 in_ulCompanyID, AkUInt32 in_ulPluginID,
+        AkGlobalCallbackFunc in_pCallback, AkUInt32 in_eLocation, void* in_pCookie) override
+    {
+        callbacks.push_back({ in_pCallback, in_eLocation, in_pCookie });
+        return AK_Success;
+    }
+
+    AKRESULT UnregisterGlobalCallback(AkGlobalCallbackFunc in_pCallback, AkUInt32 in_eLocation) override
+    {
+        for (auto it = callbacks.begin(); it != callbacks.end(); ++it)
+        {
+            if (it->pCallback == in_pCallback && (it->uLocations & in_eLocation))
+            {
+                callbacks.erase(it);
+                return AK_Success;
+            }
+        }
+        return AK_InvalidParameter;
+    }
+
+    AK::IAkPluginMemAlloc* GetAllocator() override { return &allocator; }
+    AkUInt16 GetMaxBufferLength() const override { return uMaxFrames; }
+    AkUInt32 GetSampleRate() const override { return uSampleRate; }
+
+    void BeginRender() { Fire(AkGlobalCallbackLocation_BeginRender); }
+    void EndRender() { Fire(AkGlobalCallbackLocation_EndRender); Fire(AkGlobalCallbackLocation_End); }
+
+    HostAllocator allocator;
+
+private:
+    struct Callback
+    {
+        AkGlobalCallbackFunc pCallback;
+        AkUInt32 uLocations;
+        void* pCookie;
+    };
+
+    void Fire(AkGlobalCallbackLocation in_eLocation)
+    {
+        // Copy, callbacks are allowed to unregister themselves. Reuses the capacity, so a
+        // render frame does not allocate on the host side either.
+        pending.assign(callbacks.begin(), callbacks.end());
+        for (const Callback& cb : pending)
+        {
+            if (cb.uLocations & in_eLocation)
+                cb.pCallback(this, in_eLocation, cb.pCookie);
+        }
+    }
+
+    std::vector<Callback> callbacks;
+    std::vector<Callback> pending;
+    AkUInt32 uSampleRate;
+    AkUInt16 uMaxFrames;
+};
+
+class HostEffectContext : public AK::IAkEffectPluginContext
+{
+public:
+    HostEffectContext(HostGlobalContext* in_pGlobal, AkUniqueID in_audioNodeID)
+        : pGlobal(in_pGlobal)
+        , audioNodeID(in_audioNodeID)
+    {
+    }
+
+    AK::IAkGlobalPluginContext* GlobalContext() const override { return pGlobal; }
+    AkUniqueID GetAudioNodeID() const override { return audioNodeID; }
+    AkUInt16 GetMaxBufferLength() const override { return pGlobal->GetMaxBufferLength(); }
+    bool CanPostMonitorData() override { return bCanPostMonitorData; }
+
+    /// Keeps a copy of the last packet, the way Authoring receives it: as bytes.
+    AKRESULT PostMonitorData(void* in_pData, AkUInt32 in_uDataSize) override
+    {
+        ++uNumMonitorPosts;
+        uLastMonitorDataSize = in_uDataSize < sizeof(lastMonitorData) ? in_uDataSize : (AkUInt32)sizeof(lastMonitorData);
+        memcpy(lastMonitorData, in_pData, uLastMonitorDataSize);
+        return AK_Success;
+    }
+
+    bool IsSendModeEffect() const override { return false; }
+
+    bool bCanPostMonitorData = false;
+    AkUInt64 uNumMonitorPosts = 0;
+    alignas(8) AkUInt8 lastMonitorData[1024];
+    AkUInt32 uLastMonitorDataSize = 0;
+
+private:
+    HostGlobalContext* pGlobal;
+    AkUniqueID audioNodeID;
+};
+
+/// Owns contiguous deinterleaved storage and attaches it to an AkAudioBuffer.
+class HostAudioBuffer : public AkAudioBuffer
+{
+public:
+    HostAudioBuffer(AkUInt32 in_uNumChannels, AkUInt16 in_uMaxFrames)
+        : HostAudioBuffer(DefaultConfig(in_uNumChannels), in_uMaxFrames)
+    {
+    }
+
+    HostAudioBuffer(AkChannelConfig in_channelConfig, AkUInt16 in_uMaxFrames)
+        : storage((size_t)in_channelConfig.uNumChannels * in_uMaxFrames, 0.0f)
+    {
+        AttachContiguousDeinterleavedData(storage.data(), in_uMaxFrames, 0, in_channelConfig);
+    }
+
+    static AkChannelConfig DefaultConfig(AkUInt32 in_uNumChannels)
+    {
+        AkChannelConfig config;
+        if (in_uNumChannels == 2)
+            config.SetStandard(AK_SPEAKER_SETUP_STEREO);
+        else
+            config.SetAnonymous(in_uNumChannels);
+        return config;
+    }
+
+    std::vector<AkReal32> storage;
+};
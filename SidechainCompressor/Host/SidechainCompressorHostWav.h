@@ -0,0 +1,290 @@
+// WAV file I/O for the host tools (Linux). Reads through a memory-mapped window that moves
+// along the data chunk, so a file of any length costs a few megabytes of address space and
+// no copy through the page cache; writes 32-bit float through stdio.
+
+#pragma once
+
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// PCM 16, 24 and 32 bit and 32-bit float, plain or WAVE_FORMAT_EXTENSIBLE. Frames are read
+/// in order, deinterleaved and converted to float a block at a time.
+class HostWavReader
+{
+public:
+    HostWavReader() = default;
+    HostWavReader(const HostWavReader&) = delete;
+    HostWavReader& operator=(const HostWavReader&) = delete;
+    ~HostWavReader() { Close(); }
+
+    /// Parses the header; on failure says why in out_error.
+    bool Open(const char* in_pszPath, std::string& out_error)
+    {
+        Close();
+        fd = open(in_pszPath, O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0)
+        {
+            out_error = "cannot open";
+            Close();
+            return false;
+        }
+        fileSize = (AkUInt64)info.st_size;
+        pageSize = (AkUInt64)sysconf(_SC_PAGESIZE);
+
+        AkUInt8 riff[12];
+        if (!ReadAt(0, riff, sizeof(riff)) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0)
+        {
+            out_error = "not a RIFF/WAVE file";
+            Close();
+            return false;
+        }
+
+        // Walk the chunks for fmt and data; everything else (bext, LIST, ...) is skipped
+        bool bFormat = false;
+        AkUInt16 uFormatTag = 0;
+        for (AkUInt64 offset = sizeof(riff); offset + 8 <= fileSize;)
+        {
+            AkUInt8 header[8];
+            ReadAt(offset, header, sizeof(header));
+            const AkUInt64 uChunkSize = Read32(header + 4);
+            if (memcmp(header, "fmt ", 4) == 0 && uChunkSize >= 16)
+            {
+                AkUInt8 fmt[40] = {};
+                ReadAt(offset + 8, fmt, (size_t)std::min<AkUInt64>(uChunkSize, sizeof(fmt)));
+                uFormatTag = Read16(fmt);
+                uNumChannels = Read16(fmt + 2);
+                uSampleRate = Read32(fmt + 4);
+                uBlockAlign = Read16(fmt + 12);
+                uBitsPerSample = Read16(fmt + 14);
+                if (uFormatTag == kFormatExtensible && uChunkSize >= 40)
+                    uFormatTag = Read16(fmt + 24);      // Sub-format GUID starts with the tag
+                bFormat = true;
+            }
+            else if (memcmp(header, "data", 4) == 0)
+            {
+                dataOffset = offset + 8;
+                dataSize = std::min(uChunkSize, fileSize - dataOffset);
+                break;
+            }
+            offset += 8 + uChunkSize + (uChunkSize & 1);
+        }
+
+        bFloat = uFormatTag == kFormatFloat;
+        const bool bSupported = (uFormatTag == kFormatPcm && (uBitsPerSample == 16 || uBitsPerSample == 24 || uBitsPerSample == 32))
+            || (bFloat && uBitsPerSample == 32);
+        if (!bFormat || dataOffset == 0 || !bSupported || uNumChannels == 0 || uBlockAlign != uNumChannels * (uBitsPerSample / 8))
+        {
+            out_error = !bFormat || dataOffset == 0 ? "no fmt or data chunk" : "unsupported sample format";
+            Close();
+            return false;
+        }
+        uNumFrames = dataSize / uBlockAlign;
+        uPosition = 0;
+        return true;
+    }
+
+    void Close()
+    {
+        Unmap();
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+        uNumFrames = 0;
+        dataOffset = 0;
+    }
+
+    /// Next in_uFrames frames into the first channels of io_buffer, from io_buffer.uValidFrames
+    /// on; past the end of the file, silence. Channels of the buffer the file does not have
+    /// are left alone. Returns the frames that came from the file.
+    AkUInt32 Read(AkAudioBuffer& io_buffer, AkUInt32 in_uFrames)
+    {
+        const AkUInt32 uChannels = std::min((AkUInt32)uNumChannels, io_buffer.NumChannels());
+        const AkUInt32 uOffset = io_buffer.uValidFrames;
+        const AkUInt32 uRead = (AkUInt32)std::min<AkUInt64>(in_uFrames, uNumFrames - std::min(uPosition, uNumFrames));
+        const AkUInt8* pFrames = uRead > 0 ? Map(dataOffset + uPosition * uBlockAlign, (AkUInt64)uRead * uBlockAlign) : nullptr;
+        if (uRead > 0 && pFrames == nullptr)
+            return 0;
+
+        const AkUInt32 uBytes = uBitsPerSample / 8;
+        for (AkUInt32 channel = 0; channel < uChannels; ++channel)
+        {
+            AkReal32* pOut = io_buffer.GetChannel(channel) + uOffset;
+            const AkUInt8* pIn = pFrames + channel * uBytes;
+            for (AkUInt32 frame = 0; frame < uRead; ++frame, pIn += uBlockAlign)
+                pOut[frame] = Sample(pIn);
+            memset(pOut + uRead, 0, sizeof(AkReal32) * (in_uFrames - uRead));
+        }
+        uPosition += uRead;
+        return uRead;
+    }
+
+    AkUInt32 GetSampleRate() const { return uSampleRate; }
+    AkUInt32 GetNumChannels() const { return uNumChannels; }
+    AkUInt64 GetNumFrames() const { return uNumFrames; }
+
+private:
+    static const AkUInt16 kFormatPcm = 1;
+    static const AkUInt16 kFormatFloat = 3;
+    static const AkUInt16 kFormatExtensible = 0xFFFE;
+    static const AkUInt64 kWindowBytes = 8u << 20;     // Mapped at a time; more when one read needs it
+
+    static AkUInt16 Read16(const AkUInt8* p) { return (AkUInt16)(p[0] | (p[1] << 8)); }
+    static AkUInt32 Read32(const AkUInt8* p) { return (AkUInt32)p[0] | ((AkUInt32)p[1] << 8) | ((AkUInt32)p[2] << 16) | ((AkUInt32)p[3] << 24); }
+
+    AkReal32 Sample(const AkUInt8* p) const
+    {
+        switch (uBitsPerSample)
+        {
+        case 16: return (AkReal32)(AkInt16)Read16(p) * (1.0f / 32768.0f);
+        case 24: return (AkReal32)((AkInt32)(((AkUInt32)p[0] << 8) | ((AkUInt32)p[1] << 16) | ((AkUInt32)p[2] << 24)) >> 8) * (1.0f / 8388608.0f);
+        default:
+            if (bFloat)
+            {
+                AkReal32 value;
+                memcpy(&value, p, sizeof(value));
+                return value;
+            }
+            return (AkReal32)((double)(AkInt32)Read32(p) * (1.0 / 2147483648.0));
+        }
+    }
+
+    bool ReadAt(AkUInt64 in_uOffset, void* out_pData, size_t in_uSize) const
+    {
+        return pread(fd, out_pData, in_uSize, (off_t)in_uOffset) == (ssize_t)in_uSize;
+    }
+
+    // Bytes [offset, offset + size) of the file, moving the window when they are not in it
+    const AkUInt8* Map(AkUInt64 in_uOffset, AkUInt64 in_uSize)
+    {
+        if (window == nullptr || in_uOffset < windowStart || in_uOffset + in_uSize > windowStart + windowSize)
+        {
+            Unmap();
+            windowStart = in_uOffset / pageSize * pageSize;
+            windowSize = std::min(std::max(kWindowBytes, in_uOffset + in_uSize - windowStart), fileSize - windowStart);
+            void* pMapped = mmap(nullptr, (size_t)windowSize, PROT_READ, MAP_PRIVATE, fd, (off_t)windowStart);
+            if (pMapped == MAP_FAILED)
+                return nullptr;
+            window = (const AkUInt8*)pMapped;
+            madvise(pMapped, (size_t)windowSize, MADV_SEQUENTIAL | MADV_WILLNEED);
+        }
+        return window + (in_uOffset - windowStart);
+    }
+
+    void Unmap()
+    {
+        if (window)
+            munmap((void*)window, (size_t)windowSize);
+        window = nullptr;
+    }
+
+    int fd = -1;
+    AkUInt64 fileSize = 0;
+    AkUInt64 pageSize = 4096;
+    AkUInt64 dataOffset = 0;
+    AkUInt64 dataSize = 0;
+    AkUInt64 uNumFrames = 0;
+    AkUInt64 uPosition = 0;                 // Next frame to read
+    AkUInt32 uSampleRate = 0;
+    AkUInt16 uNumChannels = 0;
+    AkUInt16 uBlockAlign = 0;
+    AkUInt16 uBitsPerSample = 0;
+    bool bFloat = false;
+
+    const AkUInt8* window = nullptr;
+    AkUInt64 windowStart = 0;
+    AkUInt64 windowSize = 0;
+};
+
+/// 32-bit float, so nothing the plug-in produces is clipped or dithered. The sizes in the
+/// header are written by Close, once the length is known.
+class HostWavWriter
+{
+public:
+    HostWavWriter() = default;
+    HostWavWriter(const HostWavWriter&) = delete;
+    HostWavWriter& operator=(const HostWavWriter&) = delete;
+    ~HostWavWriter() { Close(); }
+
+    bool Open(const char* in_pszPath, AkUInt32 in_uNumChannels, AkUInt32 in_uSampleRate)
+    {
+        Close();
+        file = fopen(in_pszPath, "wb");
+        if (file == nullptr)
+            return false;
+        setvbuf(file, nullptr, _IOFBF, 1 << 20);
+        uNumChannels = in_uNumChannels;
+        uSampleRate = in_uSampleRate;
+        uNumFrames = 0;
+        WriteHeader();
+        return true;
+    }
+
+    /// in_uFrames frames of the first GetNumChannels() channels, from frame in_uOffset
+    void Write(const AkReal32* const* in_ppChannels, AkUInt32 in_uOffset, AkUInt32 in_uFrames)
+    {
+        interleaved.resize((size_t)in_uFrames * uNumChannels);
+        for (AkUInt32 channel = 0; channel < uNumChannels; ++channel)
+        {
+            const AkReal32* pIn = in_ppChannels[channel] + in_uOffset;
+            for (AkUInt32 frame = 0; frame < in_uFrames; ++frame)
+                interleaved[(size_t)frame * uNumChannels + channel] = pIn[frame];
+        }
+        fwrite(interleaved.data(), sizeof(AkReal32), interleaved.size(), file);
+        uNumFrames += in_uFrames;
+    }
+
+    /// Patches the header; false if anything failed to reach the disk
+    bool Close()
+    {
+        if (file == nullptr)
+            return true;
+        bool bOk = !ferror(file);
+        if (fseek(file, 0, SEEK_SET) == 0)
+            WriteHeader();
+        bOk = !ferror(file) && bOk;
+        bOk = fclose(file) == 0 && bOk;
+        file = nullptr;
+        return bOk;
+    }
+
+    AkUInt32 GetNumChannels() const { return uNumChannels; }
+
+private:
+    void WriteHeader()
+    {
+        const AkUInt32 uDataSize = (AkUInt32)std::min<AkUInt64>(uNumFrames * uNumChannels * sizeof(AkReal32), 0xFFFFFFFFu - 36);
+        AkUInt8 header[44];
+        memcpy(header, "RIFF", 4);
+        Write32(header + 4, 36 + uDataSize);
+        memcpy(header + 8, "WAVEfmt ", 8);
+        Write32(header + 16, 16);
+        Write16(header + 20, 3);                                    // IEEE float
+        Write16(header + 22, (AkUInt16)uNumChannels);
+        Write32(header + 24, uSampleRate);
+        Write32(header + 28, uSampleRate * uNumChannels * (AkUInt32)sizeof(AkReal32));
+        Write16(header + 32, (AkUInt16)(uNumChannels * sizeof(AkReal32)));
+        Write16(header + 34, 32);
+        memcpy(header + 36, "data", 4);
+        Write32(header + 40, uDataSize);
+        fwrite(header, 1, sizeof(header), file);
+    }
+
+    static void Write16(AkUInt8* p, AkUInt16 v) { p[0] = (AkUInt8)v; p[1] = (AkUInt8)(v >> 8); }
+    static void Write32(AkUInt8* p, AkUInt32 v) { for (int i = 0; i < 4; ++i) p[i] = (AkUInt8)(v >> (8 * i)); }
+
+    FILE* file = nullptr;
+    AkUInt32 uNumChannels = 0;
+    AkUInt32 uSampleRate = 0;
+    AkUInt64 uNumFrames = 0;
+    std::vector<AkReal32> interleaved;
+};
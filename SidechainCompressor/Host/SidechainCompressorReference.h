@@ -0,0 +1,177 @@
+// Double-precision reference model of SidechainCompressorFX, for the host checks.
+//
+// Everything a voice's gain depends on, evaluated directly in double: the sidechain is the
+// exact sum of every voice, the detector the exact mean square of its window (or the
+// one-pole), the ratio is scaled by the voice's rank percentile, the attack/release follower
+// runs on every frame and the soft-knee curve is the closed form. None of the plug-in's fast
+// paths are in it: no fixed-point partials, float history, SIMD kernels, control rate or
+// gain table. What it shares with the plug-in is the timing the design defines: the detector
+// is read once per audio frame, a frame behind, and the follower tracks a ramp from the
+// previous reading to the current one across the frame.
+//
+// It covers voices that all feed and listen to one group, full band, with no key filter and
+// no lookahead, with any channel link; Execute in that setup must stay within the budgets
+// the checks give it.
+
+#pragma once
+
+#include "../SoundEnginePlugin/SidechainCompressorSharedBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+class SidechainReference
+{
+public:
+    struct Settings
+    {
+        double threshold = -24.0;       // dB
+        double maxRatio = 4.0;
+        double kneeDb = 1.0;
+        double attackMs = 1.0;
+        double releaseMs = 20.0;
+        double windowMs = 10.0;
+        bool onePole = false;
+        SidechainChannelLink link = SidechainChannelLink_Unlinked;
+        AkUInt32 sampleRate = 48000;
+        AkUInt32 frames = 256;          // Audio frame
+    };
+
+    struct Voice
+    {
+        double rank = 1.0;
+        std::vector<std::vector<AkReal32>> input;       // Per channel; every voice the same whole number of audio frames
+        std::vector<std::vector<double>> output;        // Per channel, filled by render
+        std::vector<std::vector<double>> gainDb;        // Gain each output sample was given
+    };
+
+    // Soft-knee gain in dB for a linear level
+    static double curveDb(double level, double threshold, double ratio, double knee)
+    {
+        const double x = 20.0 * log10(std::max(level, 1.0e-12));
+        if (x > threshold + knee / 2)
+            return (x - threshold) / ratio + threshold - x;
+        if (x > threshold - knee / 2)
+            return ((1 / ratio) - 1) / (2 * knee) * (x - (threshold - knee / 2)) * (x - (threshold - knee / 2));
+        return 0.0;
+    }
+
+    static void render(std::vector<Voice>& io_voices, const Settings& in_settings)
+    {
+        if (io_voices.empty())
+            return;
+        const AkUInt32 uFrames = in_settings.frames;
+        const size_t uLength = io_voices[0].input[0].size();
+
+        // Ranks are fixed, so each voice's ratio is too
+        double minRank = io_voices[0].rank, maxRank = io_voices[0].rank;
+        AkUInt32 uSideChannels = 0;
+        for (const Voice& voice : io_voices)
+        {
+            minRank = std::min(minRank, voice.rank);
+            maxRank = std::max(maxRank, voice.rank);
+            uSideChannels = std::max(uSideChannels, std::min((AkUInt32)voice.input.size(), SidechainSnapshot::kMaxChannels));
+        }
+        std::vector<double> ratio;
+        for (const Voice& voice : io_voices)
+        {
+            const double percentile = minRank == maxRank ? 1.0 - 1.0 / io_voices.size() : 1.0 - (voice.rank - minRank) / (maxRank - minRank);
+            ratio.push_back(1.0 + percentile * (in_settings.maxRatio - 1.0));
+        }
+
+        // The detector: a ring of squares per sidechain channel
+        const AkUInt32 uWindow = std::max((AkUInt32)(in_settings.windowMs * 0.001 * in_settings.sampleRate + 0.5), (AkUInt32)1);
+        const double onePoleCoef = 1.0 - exp(-1.0 / uWindow);
+        std::vector<std::vector<double>> squares(uSideChannels, std::vector<double>(uWindow, 0.0));
+        std::vector<double> meanSquare(uSideChannels, 0.0);
+        size_t ringPos = 0;
+
+        // Follower per voice and lane
+        auto coefficient = [&](double timeMs)
+        {
+            const double frames = std::max(timeMs, 0.0) * 0.001 * in_settings.sampleRate;
+            return frames > 0.0 ? 1.0 - exp(-1.0 / frames) : 1.0;
+        };
+        const double attack = coefficient(in_settings.attackMs);
+        const double release = coefficient(in_settings.releaseMs);
+        std::vector<std::vector<double>> envelope(io_voices.size(), std::vector<double>(SidechainSnapshot::kLanesPerBand, 0.0));
+        std::vector<double> lastLevel(SidechainSnapshot::kLanesPerBand, 0.0), newLevel(SidechainSnapshot::kLanesPerBand, 0.0);
+
+        for (Voice& voice : io_voices)
+        {
+            voice.output.assign(voice.input.size(), std::vector<double>(uLength, 0.0));
+            voice.gainDb.assign(voice.input.size(), std::vector<double>(uLength, 0.0));
+        }
+
+        for (size_t start = 0; start < uLength; start += uFrames)
+        {
+            // Each voice against the levels the previous frames left
+            for (size_t v = 0; v < io_voices.size(); ++v)
+            {
+                Voice& voice = io_voices[v];
+                for (AkUInt32 lane = 0; lane < SidechainSnapshot::kLanesPerBand; ++lane)
+                {
+                    bool bUsed = false;
+                    for (AkUInt32 channel = 0; channel < voice.input.size(); ++channel)
+                        bUsed = bUsed || SidechainSnapshot::getLane(channel, in_settings.link) == lane;
+                    if (!bUsed)
+                        continue;
+
+                    double& env = envelope[v][lane];
+                    for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                    {
+                        const double level = lastLevel[lane] + (newLevel[lane] - lastLevel[lane]) * frame / uFrames;
+                        env += (level - env) * (level > env ? attack : release);
+                        const double gainDb = curveDb(env, in_settings.threshold, ratio[v], in_settings.kneeDb);
+                        for (AkUInt32 channel = 0; channel < voice.input.size(); ++channel)
+                        {
+                            if (SidechainSnapshot::getLane(channel, in_settings.link) != lane)
+                                continue;
+                            voice.gainDb[channel][start + frame] = gainDb;
+                            voice.output[channel][start + frame] = voice.input[channel][start + frame] * pow(10.0, gainDb / 20.0);
+                        }
+                    }
+                }
+            }
+
+            // Then the frame's sum into the detector, read at its end
+            for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+            {
+                for (AkUInt32 channel = 0; channel < uSideChannels; ++channel)
+                {
+                    double sum = 0.0;
+                    for (const Voice& voice : io_voices)
+                    {
+                        if (channel < voice.input.size())
+                            sum += voice.input[channel][start + frame];
+                    }
+                    const double square = sum * sum;
+                    if (in_settings.onePole)
+                        meanSquare[channel] += (square - meanSquare[channel]) * onePoleCoef;
+                    squares[channel][ringPos] = square;
+                }
+                ringPos = ringPos + 1 == uWindow ? 0 : ringPos + 1;
+            }
+            double loudest = 0.0, total = 0.0;
+            for (AkUInt32 channel = 0; channel < uSideChannels; ++channel)
+            {
+                if (!in_settings.onePole)
+                {
+                    double sum = 0.0;
+                    for (double square : squares[channel])
+                        sum += square;
+                    meanSquare[channel] = sum / uWindow;
+                }
+                lastLevel[channel] = newLevel[channel];
+                newLevel[channel] = sqrt(meanSquare[channel]);
+                loudest = std::max(loudest, newLevel[channel]);
+                total += meanSquare[channel];
+            }
+            lastLevel[SidechainSnapshot::kLane_LinkedMax] = newLevel[SidechainSnapshot::kLane_LinkedMax];
+            newLevel[SidechainSnapshot::kLane_LinkedMax] = loudest;
+            lastLevel[SidechainSnapshot::kLane_LinkedSum] = newLevel[SidechainSnapshot::kLane_LinkedSum];
+            newLevel[SidechainSnapshot::kLane_LinkedSum] = sqrt(total);
+        }
+    }
+};
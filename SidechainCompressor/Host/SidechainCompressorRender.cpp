@@ -0,0 +1,342 @@
+// Offline render of WAV files through the sound engine plug-in (Linux).
+//
+// Every input is one SidechainCompressorFX instance with its own priority rank, feeding and
+// listening to sidechain group 0, all on one stand-in global context and rendered a buffer at
+// a time the way the sound engine would, as fast as the machine allows. Inputs are read through
+// a memory-mapped window and must share a sample rate; shorter ones continue as silence.
+// Writes each ducked input to <out>/<stem>.ducked.wav and a gain track, <out>/gain.wav, with
+// one channel per input: the deepest linear gain any of its channels and bands was given at
+// each sample, aligned with the ducked output.
+// Usage:
+//
+//   SidechainCompressorRender [options] input.wav[@rank] ...
+//
+//   --out DIR               output directory (.)
+//   --frames N              buffer size (256)
+//   --threshold dB          (-24)
+//   --max-ratio R           (4)
+//   --attack ms, --release ms, --window ms, --lookahead ms, --bands N, --control-rate N
+//                           plug-in defaults unless given
+//   --contribution samples|energy
+
+#include "SidechainCompressorHostContext.h"
+#include "SidechainCompressorHostWav.h"
+#include "../SoundEnginePlugin/SidechainCompressorFX.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+AK::IAkPlugin* CreateSidechainCompressorFX(AK::IAkPluginMemAlloc* in_pAllocator);
+AK::IAkPluginParam* CreateSidechainCompressorFXParams(AK::IAkPluginMemAlloc* in_pAllocator);
+
+namespace
+{
+    struct Input
+    {
+        std::string path;
+        AkReal32 rank = 1.0f;
+    };
+
+    struct Options
+    {
+        std::vector<Input> inputs;
+        std::string outDir = ".";
+        AkUInt16 frames = 256;
+        // Applied in order to every instance's parameters, after the defaults
+        std::vector<std::function<void(SidechainCompressorFXParams&)>> settings;
+    };
+
+    void usage(const char* in_pszName)
+    {
+        fprintf(stderr,
+            "usage: %s [--out dir] [--frames 256] [--threshold dB] [--max-ratio r] [--attack ms] [--release ms]\n"
+            "       [--window ms] [--lookahead ms] [--bands n] [--control-rate n] [--contribution samples|energy]\n"
+            "       input.wav[@rank] ...\n", in_pszName);
+    }
+
+    // Numeric options, each setting one parameter of every instance
+    typedef void (*ApplySetting)(SidechainCompressorFXParams&, AkReal32);
+    const struct
+    {
+        const char* option;
+        ApplySetting apply;
+    } kSettings[] = {
+        { "--threshold", [](SidechainCompressorFXParams& params, AkReal32 value) { params.RTPC.fThreshold = value; } },
+        { "--max-ratio", [](SidechainCompressorFXParams& params, AkReal32 value) { params.RTPC.fMaxRatio = value; } },
+        { "--attack", [](SidechainCompressorFXParams& params, AkReal32 value) { params.RTPC.fAttack = value; } },
+        { "--release", [](SidechainCompressorFXParams& params, AkReal32 value) { params.RTPC.fRelease = value; } },
+        { "--window", [](SidechainCompressorFXParams& params, AkReal32 value) { params.NonRTPC.fRMSWindow = value; } },
+        { "--lookahead", [](SidechainCompressorFXParams& params, AkReal32 value) { params.NonRTPC.fLookahead = value; } },
+        { "--bands", [](SidechainCompressorFXParams& params, AkReal32 value) { params.NonRTPC.iNumBands = (AkInt32)value; } },
+        { "--control-rate", [](SidechainCompressorFXParams& params, AkReal32 value) { params.NonRTPC.iControlRate = (AkInt32)value; } },
+    };
+
+    bool parseOptions(int argc, char** argv, Options& out_options)
+    {
+        // The benchmark's load: ducking that is audible at a glance
+        out_options.settings.push_back([](SidechainCompressorFXParams& params) { params.RTPC.fThreshold = -24.0f; });
+        out_options.settings.push_back([](SidechainCompressorFXParams& params) { params.RTPC.fMaxRatio = 4.0f; });
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const bool bValue = i + 1 < argc;
+            const ApplySetting* pApply = nullptr;
+            for (const auto& setting : kSettings)
+            {
+                if (strcmp(argv[i], setting.option) == 0)
+                    pApply = &setting.apply;
+            }
+
+            if (bValue && pApply)
+            {
+                const ApplySetting apply = *pApply;
+                const AkReal32 value = (AkReal32)atof(argv[++i]);
+                out_options.settings.push_back([=](SidechainCompressorFXParams& params) { apply(params, value); });
+            }
+            else if (bValue && strcmp(argv[i], "--out") == 0)
+                out_options.outDir = argv[++i];
+            else if (bValue && strcmp(argv[i], "--frames") == 0 && atoi(argv[i + 1]) > 0 && atoi(argv[i + 1]) <= 4096)
+                out_options.frames = (AkUInt16)atoi(argv[++i]);
+            else if (bValue && strcmp(argv[i], "--contribution") == 0 && (strcmp(argv[i + 1], "samples") == 0 || strcmp(argv[i + 1], "energy") == 0))
+            {
+                const AkInt32 iContribution = strcmp(argv[++i], "energy") == 0 ? SidechainContribution_BlockEnergy : SidechainContribution_Samples;
+                out_options.settings.push_back([=](SidechainCompressorFXParams& params) { params.NonRTPC.iContribution = iContribution; });
+            }
+            else if (argv[i][0] != '-')
+            {
+                // A trailing @rank; without one, ranks follow the order of the inputs
+                Input input;
+                input.path = argv[i];
+                input.rank = 1.0f + (AkReal32)out_options.inputs.size();
+                const size_t at = input.path.rfind('@');
+                if (at != std::string::npos && at + 1 < input.path.size() && input.path.find('/', at) == std::string::npos)
+                {
+                    input.rank = (AkReal32)atof(input.path.c_str() + at + 1);
+                    input.path.resize(at);
+                }
+                out_options.inputs.push_back(input);
+            }
+            else
+            {
+                usage(argv[0]);
+                return false;
+            }
+        }
+        if (out_options.inputs.empty())
+        {
+            usage(argv[0]);
+            return false;
+        }
+        return true;
+    }
+
+    // <out>/<stem>.ducked.wav, with the input's position appended when two inputs share a stem
+    std::string outputPath(const Options& in_options, size_t in_uIndex)
+    {
+        auto stem = [&](size_t index)
+        {
+            const std::string& path = in_options.inputs[index].path;
+            const size_t slash = path.rfind('/');
+            std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+            const size_t dot = name.rfind('.');
+            return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+        };
+        std::string name = stem(in_uIndex);
+        for (size_t other = 0; other < in_options.inputs.size(); ++other)
+        {
+            if (other != in_uIndex && stem(other) == name)
+            {
+                name += "." + std::to_string(in_uIndex + 1);
+                break;
+            }
+        }
+        return in_options.outDir + "/" + name + ".ducked.wav";
+    }
+
+    AkReal32 toDb(double in_gain)
+    {
+        return (AkReal32)(20.0 * log10(AkMax(in_gain, 1.0e-10)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+    const size_t uInputs = options.inputs.size();
+
+    std::vector<std::unique_ptr<HostWavReader>> readers;
+    AkUInt64 uLongest = 0;
+    for (const Input& input : options.inputs)
+    {
+        readers.emplace_back(new HostWavReader());
+        std::string error;
+        if (!readers.back()->Open(input.path.c_str(), error))
+        {
+            fprintf(stderr, "%s: %s\n", input.path.c_str(), error.c_str());
+            return 1;
+        }
+        // One engine, one rate: the plug-in refuses voices at another
+        if (readers.back()->GetSampleRate() != readers[0]->GetSampleRate())
+        {
+            fprintf(stderr, "%s: %u Hz, but %s is %u Hz\n", input.path.c_str(), readers.back()->GetSampleRate(),
+                options.inputs[0].path.c_str(), readers[0]->GetSampleRate());
+            return 1;
+        }
+        uLongest = AkMax(uLongest, readers.back()->GetNumFrames());
+    }
+    const AkUInt32 uSampleRate = readers[0]->GetSampleRate();
+    const AkUInt16 uFrames = options.frames;
+
+    // The instances, set up the way the sound engine would
+    HostGlobalContext global(uSampleRate, uFrames);
+    std::vector<std::unique_ptr<HostEffectContext>> contexts;
+    std::vector<std::unique_ptr<HostAudioBuffer>> inputs, outputs;
+    std::vector<SidechainCompressorFXParams*> params;
+    std::vector<SidechainCompressorFX*> effects;
+    bool bOk = true;
+    for (size_t i = 0; i < uInputs && bOk; ++i)
+    {
+        const AkChannelConfig config = HostAudioBuffer::DefaultConfig(readers[i]->GetNumChannels());
+        contexts.emplace_back(new HostEffectContext(&global, 1000 + (AkUniqueID)i));
+        inputs.emplace_back(new HostAudioBuffer(config, uFrames));
+        outputs.emplace_back(new HostAudioBuffer(config, uFrames));
+
+        auto* pParams = (SidechainCompressorFXParams*)CreateSidechainCompressorFXParams(&global.allocator);
+        pParams->Init(&global.allocator, nullptr, 0);
+        for (const auto& setting : options.settings)
+            setting(*pParams);
+        pParams->RTPC.fPriorityRank = options.inputs[i].rank;
+        pParams->NonRTPC.iMonitorRate = 0;
+        params.push_back(pParams);
+
+        AkAudioFormat format;
+        format.uSampleRate = uSampleRate;
+        format.channelConfig = config;
+        auto* pFX = (SidechainCompressorFX*)CreateSidechainCompressorFX(&global.allocator);
+        if (pFX->Init(&global.allocator, contexts.back().get(), pParams, format) != AK_Success)
+        {
+            fprintf(stderr, "%s: the plug-in refused it\n", options.inputs[i].path.c_str());
+            pFX->Term(&global.allocator);
+            bOk = false;
+            break;
+        }
+        effects.push_back(pFX);
+    }
+
+    // Lookahead delays every output alike; render that much longer and drop it from the front
+    const AkUInt32 uLatency = effects.empty() ? 0 : effects[0]->GetLatencyFrames();
+
+    std::vector<std::unique_ptr<HostWavWriter>> writers;
+    HostWavWriter gainWriter;
+    for (size_t i = 0; i < effects.size() && bOk; ++i)
+    {
+        writers.emplace_back(new HostWavWriter());
+        const std::string path = outputPath(options, i);
+        if (!writers.back()->Open(path.c_str(), readers[i]->GetNumChannels(), uSampleRate))
+        {
+            fprintf(stderr, "%s: cannot write\n", path.c_str());
+            bOk = false;
+        }
+    }
+    const std::string gainPath = options.outDir + "/gain.wav";
+    if (bOk && !gainWriter.Open(gainPath.c_str(), (AkUInt32)uInputs, uSampleRate))
+    {
+        fprintf(stderr, "%s: cannot write\n", gainPath.c_str());
+        bOk = false;
+    }
+
+    std::vector<std::vector<AkReal32>> gains(uInputs, std::vector<AkReal32>(uFrames, 1.0f));
+    std::vector<const AkReal32*> gainChannels(uInputs);
+    std::vector<const AkReal32*> outChannels;
+    std::vector<AkReal32> minGain(uInputs, 1.0f);
+    std::vector<double> sumGain(uInputs, 0.0);
+
+    const auto start = std::chrono::steady_clock::now();
+    const AkUInt64 uTotal = uLongest + uLatency;
+    for (AkUInt64 position = 0; position < uTotal && bOk; position += uFrames)
+    {
+        global.BeginRender();
+        for (size_t i = 0; i < uInputs; ++i)
+        {
+            HostAudioBuffer& in = *inputs[i];
+            HostAudioBuffer& out = *outputs[i];
+            in.uValidFrames = 0;
+            readers[i]->Read(in, uFrames);
+            in.uValidFrames = uFrames;
+            in.eState = AK_DataReady;
+            out.uValidFrames = 0;
+            out.eState = AK_DataNeeded;
+            effects[i]->Execute(&in, 0, &out);
+
+            // The gain each output sample was given, the deepest of its channels and bands
+            std::fill(gains[i].begin(), gains[i].end(), 1.0f);
+            for (AkUInt32 channel = 0; channel < out.NumChannels(); ++channel)
+            {
+                for (AkUInt32 band = 0; band < effects[i]->GetNumBands(); ++band)
+                {
+                    const AkReal32* pGain = effects[i]->GetGainBlock(channel, band);
+                    for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                        gains[i][frame] = AkMin(gains[i][frame], pGain[frame]);
+                }
+            }
+        }
+        global.EndRender();
+
+        // Output frame o is input frame o - latency, so this buffer starts at position - latency
+        const AkUInt32 uSkip = position < uLatency ? (AkUInt32)AkMin((AkUInt64)uFrames, uLatency - position) : 0;
+        const AkUInt64 uOutStart = position + uSkip - uLatency;
+        for (size_t i = 0; i < uInputs; ++i)
+        {
+            const AkUInt64 uLength = readers[i]->GetNumFrames();
+            const AkUInt32 uWrite = uOutStart < uLength ? (AkUInt32)AkMin((AkUInt64)(uFrames - uSkip), uLength - uOutStart) : 0;
+            if (uWrite > 0)
+            {
+                outChannels.resize(outputs[i]->NumChannels());
+                for (AkUInt32 channel = 0; channel < outputs[i]->NumChannels(); ++channel)
+                    outChannels[channel] = outputs[i]->GetChannel(channel);
+                writers[i]->Write(outChannels.data(), uSkip, uWrite);
+                for (AkUInt32 frame = uSkip; frame < uSkip + uWrite; ++frame)
+                {
+                    minGain[i] = AkMin(minGain[i], gains[i][frame]);
+                    sumGain[i] += gains[i][frame];
+                }
+            }
+            gainChannels[i] = gains[i].data();
+        }
+        if (uOutStart < uLongest)
+            gainWriter.Write(gainChannels.data(), uSkip, (AkUInt32)AkMin((AkUInt64)(uFrames - uSkip), uLongest - uOutStart));
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto& writer : writers)
+        bOk = writer->Close() && bOk;
+    bOk = gainWriter.Close() && bOk;
+    for (SidechainCompressorFX* pFX : effects)
+        pFX->Term(&global.allocator);
+    for (SidechainCompressorFXParams* pParams : params)
+        pParams->Term(&global.allocator);
+    if (!bOk)
+        return 1;
+
+    printf("%6s %6s %10s %12s %16s %14s  %s\n", "input", "rank", "channels", "seconds", "deepest gain dB", "mean gain dB", "output");
+    for (size_t i = 0; i < uInputs; ++i)
+    {
+        const AkUInt64 uLength = readers[i]->GetNumFrames();
+        printf("%6zu %6.2f %10u %12.2f %16.2f %14.2f  %s\n", i + 1, options.inputs[i].rank, readers[i]->GetNumChannels(), (double)uLength / uSampleRate,
+            toDb(minGain[i]), toDb(uLength > 0 ? sumGain[i] / uLength : 1.0), outputPath(options, i).c_str());
+    }
+    const double audioSeconds = (double)uLongest / uSampleRate;
+    printf("%zu inputs, %.2f s of audio at %u Hz in %.3f s: %.0fx real time\n", uInputs, audioSeconds, uSampleRate, seconds,
+        seconds > 0.0 ? audioSeconds / seconds : 0.0);
+    return 0;
+}
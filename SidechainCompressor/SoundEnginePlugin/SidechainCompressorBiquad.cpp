@@ -0,0 +1,423 @@
+#include "SidechainCompressorBiquad.h"
+#include "SidechainCompressorDetector.h"
+#include "SidechainCompressorGainKernel.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// SSE2 is always there on x64, AVX2 and FMA are checked for; compilers keep the lane loop of
+// a recurrence scalar either way
+#define SC_BIQUAD_X64
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SC_BIQUAD_AVX2
+#else
+#define SC_BIQUAD_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace
+{
+    const AkUInt32 kNumCoefs = 5;
+    const AkUInt32 kNumStates = 2;
+    const double kPi = 3.14159265358979323846;
+
+    // State below this (-300 dB) is flushed once per block, so silence never decays into denormals
+    const AkReal32 kStateFloor = 1e-15f;
+
+    // The whole cascade of one group of kGroupWidth lanes over the block. Each lane starts from
+    // its channel of the frame-major input, in_pChannels[k], or silence past in_uUsed. Each
+    // section's coefficient rows and state rows are rowStride apart.
+    //
+    // Each section's recurrence is a serial chain in time; in one pass over the frames every
+    // section's work on a frame overlaps the others', so the cascade takes about as long as its
+    // slowest chain.
+    void filterScalar(const AkReal32* in_pCoefs, AkReal32* io_pState, size_t rowStride, AkUInt32 in_uSections, const AkUInt32* in_pChannels, AkUInt32 in_uUsed,
+        const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 out_uStride, AkUInt32 in_uNumFrames)
+    {
+        for (AkUInt32 k = 0; k < SidechainBiquadBank::kGroupWidth; ++k)
+        {
+            for (AkUInt32 frame = 0; frame < in_uNumFrames; ++frame)
+            {
+                out_pLanes[(size_t)frame * out_uStride + k] = k < in_uUsed ? in_pFrames[(size_t)frame * in_uStride + in_pChannels[k]] : 0.0f;
+            }
+        }
+
+        for (AkUInt32 s = 0; s < in_uSections; ++s)
+        {
+            const AkReal32* pCoefs = in_pCoefs + s * kNumCoefs * rowStride;
+            AkReal32* pState = io_pState + s * kNumStates * rowStride;
+            for (AkUInt32 k = 0; k < SidechainBiquadBank::kGroupWidth; ++k)
+            {
+                const AkReal32 b0 = pCoefs[k], b1 = pCoefs[rowStride + k], b2 = pCoefs[2 * rowStride + k];
+                const AkReal32 a1 = pCoefs[3 * rowStride + k], a2 = pCoefs[4 * rowStride + k];
+                AkReal32 z1 = pState[k], z2 = pState[rowStride + k];
+                for (AkUInt32 frame = 0; frame < in_uNumFrames; ++frame)
+                {
+                    AkReal32& sample = out_pLanes[(size_t)frame * out_uStride + k];
+                    const AkReal32 x = sample;
+                    const AkReal32 y = b0 * x + z1;
+                    z1 = b1 * x - a1 * y + z2;
+                    z2 = b2 * x - a2 * y;
+                    sample = y;
+                }
+                pState[k] = z1;
+                pState[rowStride + k] = z2;
+            }
+        }
+    }
+
+#ifdef SC_BIQUAD_X64
+    // A group is two vectors, each gathered a lane at a time
+    template <AkUInt32 Sections>
+    void filterSSE2(const AkReal32* in_pCoefs, AkReal32* io_pState, size_t rowStride, const AkUInt32* in_pChannels, AkUInt32 in_uUsed,
+        const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 out_uStride, AkUInt32 in_uNumFrames)
+    {
+        __m128 coef[Sections + 1][kNumCoefs][2], z1[Sections + 1][2], z2[Sections + 1][2];
+        for (AkUInt32 s = 0; s < Sections; ++s)
+        {
+            for (AkUInt32 h = 0; h < 2; ++h)
+            {
+                for (AkUInt32 c = 0; c < kNumCoefs; ++c)
+                {
+                    coef[s][c][h] = _mm_loadu_ps(in_pCoefs + (s * kNumCoefs + c) * rowStride + h * 4);
+                }
+                const AkReal32* pState = io_pState + s * kNumStates * rowStride + h * 4;
+                z1[s][h] = _mm_loadu_ps(pState);
+                z2[s][h] = _mm_loadu_ps(pState + rowStride);
+            }
+        }
+
+        // Padding lanes read channel 0 and are masked to silence
+        AkUInt32 channels[SidechainBiquadBank::kGroupWidth];
+        __m128 used[2];
+        for (AkUInt32 k = 0; k < SidechainBiquadBank::kGroupWidth; ++k)
+        {
+            channels[k] = k < in_uUsed ? in_pChannels[k] : 0;
+        }
+        for (AkUInt32 h = 0; h < 2; ++h)
+        {
+            used[h] = _mm_castsi128_ps(_mm_cmplt_epi32(_mm_setr_epi32(h * 4, h * 4 + 1, h * 4 + 2, h * 4 + 3), _mm_set1_epi32((int)in_uUsed)));
+        }
+
+        for (AkUInt32 frame = 0; frame < in_uNumFrames; ++frame)
+        {
+            const AkReal32* pIn = in_pFrames + (size_t)frame * in_uStride;
+            AkReal32* pOut = out_pLanes + (size_t)frame * out_uStride;
+            for (AkUInt32 h = 0; h < 2; ++h)
+            {
+                const AkUInt32* pChannel = channels + h * 4;
+                __m128 x = _mm_and_ps(used[h], _mm_setr_ps(pIn[pChannel[0]], pIn[pChannel[1]], pIn[pChannel[2]], pIn[pChannel[3]]));
+                for (AkUInt32 s = 0; s < Sections; ++s)
+                {
+                    const __m128 y = _mm_add_ps(_mm_mul_ps(coef[s][0][h], x), z1[s][h]);
+                    z1[s][h] = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(coef[s][1][h], x), z2[s][h]), _mm_mul_ps(coef[s][3][h], y));
+                    z2[s][h] = _mm_sub_ps(_mm_mul_ps(coef[s][2][h], x), _mm_mul_ps(coef[s][4][h], y));
+                    x = y;
+                }
+                _mm_storeu_ps(pOut + h * 4, x);
+            }
+        }
+
+        for (AkUInt32 s = 0; s < Sections; ++s)
+        {
+            for (AkUInt32 h = 0; h < 2; ++h)
+            {
+                AkReal32* pState = io_pState + s * kNumStates * rowStride + h * 4;
+                _mm_storeu_ps(pState, z1[s][h]);
+                _mm_storeu_ps(pState + rowStride, z2[s][h]);
+            }
+        }
+    }
+
+    // A group is one vector, gathered in one instruction, and the fused multiply-adds shorten
+    // each section's chain
+    template <AkUInt32 Sections>
+    SC_BIQUAD_AVX2 void filterAVX2(const AkReal32* in_pCoefs, AkReal32* io_pState, size_t rowStride, const AkUInt32* in_pChannels, AkUInt32 in_uUsed,
+        const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 out_uStride, AkUInt32 in_uNumFrames)
+    {
+        // Coefficients copied side by side, so each is one fixed offset instead of a row pointer
+        __m256 coef[Sections + 1][kNumCoefs], z1[Sections + 1], z2[Sections + 1];
+        for (AkUInt32 s = 0; s < Sections; ++s)
+        {
+            for (AkUInt32 c = 0; c < kNumCoefs; ++c)
+            {
+                coef[s][c] = _mm256_loadu_ps(in_pCoefs + (s * kNumCoefs + c) * rowStride);
+            }
+            const AkReal32* pState = io_pState + s * kNumStates * rowStride;
+            z1[s] = _mm256_loadu_ps(pState);
+            z2[s] = _mm256_loadu_ps(pState + rowStride);
+        }
+
+        // Padding lanes are masked out of the gather, so they read nothing and stay silent
+        const __m256i used = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)in_uUsed), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        const __m256i channels = _mm256_and_si256(used, _mm256_loadu_si256((const __m256i*)in_pChannels));
+
+        for (AkUInt32 frame = 0; frame < in_uNumFrames; ++frame)
+        {
+            const AkReal32* pIn = in_pFrames + (size_t)frame * in_uStride;
+            __m256 x = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), pIn, channels, _mm256_castsi256_ps(used), 4);
+            for (AkUInt32 s = 0; s < Sections; ++s)
+            {
+                const __m256 y = _mm256_fmadd_ps(coef[s][0], x, z1[s]);
+                z1[s] = _mm256_fnmadd_ps(coef[s][3], y, _mm256_fmadd_ps(coef[s][1], x, z2[s]));
+                z2[s] = _mm256_fnmadd_ps(coef[s][4], y, _mm256_mul_ps(coef[s][2], x));
+                x = y;
+            }
+            _mm256_storeu_ps(out_pLanes + (size_t)frame * out_uStride, x);
+        }
+
+        for (AkUInt32 s = 0; s < Sections; ++s)
+        {
+            AkReal32* pState = io_pState + s * kNumStates * rowStride;
+            _mm256_storeu_ps(pState, z1[s]);
+            _mm256_storeu_ps(pState + rowStride, z2[s]);
+        }
+    }
+
+    // The cascades the crossover and key filter build are specialized; any other length runs scalar
+    void filterCascadeSSE2(const AkReal32* in_pCoefs, AkReal32* io_pState, size_t rowStride, AkUInt32 in_uSections, const AkUInt32* in_pChannels, AkUInt32 in_uUsed,
+        const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 out_uStride, AkUInt32 in_uNumFrames)
+    {
+        switch (in_uSections)
+        {
+        case 0: filterSSE2<0>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        case 1: filterSSE2<1>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        case 2: filterSSE2<2>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        case 4: filterSSE2<4>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        case 6: filterSSE2<6>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        default: filterScalar(in_pCoefs, io_pState, rowStride, in_uSections, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        }
+    }
+
+    SC_BIQUAD_AVX2 void filterCascadeAVX2(const AkReal32* in_pCoefs, AkReal32* io_pState, size_t rowStride, AkUInt32 in_uSections, const AkUInt32* in_pChannels, AkUInt32 in_uUsed,
+        const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 out_uStride, AkUInt32 in_uNumFrames)
+    {
+        switch (in_uSections)
+        {
+        case 0: filterAVX2<0>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        case 1: filterAVX2<1>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        case 2: filterAVX2<2>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        case 4: filterAVX2<4>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        case 6: filterAVX2<6>(in_pCoefs, io_pState, rowStride, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        default: filterScalar(in_pCoefs, io_pState, rowStride, in_uSections, in_pChannels, in_uUsed, in_pFrames, in_uStride, out_pLanes, out_uStride, in_uNumFrames); break;
+        }
+    }
+#endif // SC_BIQUAD_X64
+}
+
+// RBJ cookbook. alpha = sin(w0) / (2Q); the shelves use a slope of 1.
+SidechainBiquad SidechainBiquad::lowPass(double frequency, double sampleRate, double q)
+{
+    const double w0 = 2.0 * kPi * frequency / sampleRate;
+    const double cosw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    SidechainBiquad section;
+    section.b0 = (AkReal32)((1.0 - cosw) * 0.5 / a0);
+    section.b1 = (AkReal32)((1.0 - cosw) / a0);
+    section.b2 = section.b0;
+    section.a1 = (AkReal32)(-2.0 * cosw / a0);
+    section.a2 = (AkReal32)((1.0 - alpha) / a0);
+    return section;
+}
+
+SidechainBiquad SidechainBiquad::highPass(double frequency, double sampleRate, double q)
+{
+    const double w0 = 2.0 * kPi * frequency / sampleRate;
+    const double cosw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    SidechainBiquad section;
+    section.b0 = (AkReal32)((1.0 + cosw) * 0.5 / a0);
+    section.b1 = (AkReal32)(-(1.0 + cosw) / a0);
+    section.b2 = section.b0;
+    section.a1 = (AkReal32)(-2.0 * cosw / a0);
+    section.a2 = (AkReal32)((1.0 - alpha) / a0);
+    return section;
+}
+
+SidechainBiquad SidechainBiquad::bandPass(double frequency, double sampleRate, double q)
+{
+    const double w0 = 2.0 * kPi * frequency / sampleRate;
+    const double cosw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    SidechainBiquad section;
+    section.b0 = (AkReal32)(alpha / a0);
+    section.b1 = 0.0f;
+    section.b2 = -section.b0;
+    section.a1 = (AkReal32)(-2.0 * cosw / a0);
+    section.a2 = (AkReal32)((1.0 - alpha) / a0);
+    return section;
+}
+
+SidechainBiquad SidechainBiquad::allPass(double frequency, double sampleRate, double q)
+{
+    const double w0 = 2.0 * kPi * frequency / sampleRate;
+    const double cosw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    SidechainBiquad section;
+    section.b0 = (AkReal32)((1.0 - alpha) / a0);
+    section.b1 = (AkReal32)(-2.0 * cosw / a0);
+    section.b2 = 1.0f;
+    section.a1 = section.b1;
+    section.a2 = section.b0;
+    return section;
+}
+
+SidechainBiquad SidechainBiquad::lowShelf(double frequency, double sampleRate, double gainDb)
+{
+    const double A = pow(10.0, gainDb / 40.0);
+    const double w0 = 2.0 * kPi * frequency / sampleRate;
+    const double cosw = cos(w0);
+    const double twoSqrtAAlpha = 2.0 * sqrt(A) * sin(w0) * 0.70710678118654752;     // 2 sqrt(A) alpha at a slope of 1
+    const double a0 = (A + 1.0) + (A - 1.0) * cosw + twoSqrtAAlpha;
+    SidechainBiquad section;
+    section.b0 = (AkReal32)(A * ((A + 1.0) - (A - 1.0) * cosw + twoSqrtAAlpha) / a0);
+    section.b1 = (AkReal32)(2.0 * A * ((A - 1.0) - (A + 1.0) * cosw) / a0);
+    section.b2 = (AkReal32)(A * ((A + 1.0) - (A - 1.0) * cosw - twoSqrtAAlpha) / a0);
+    section.a1 = (AkReal32)(-2.0 * ((A - 1.0) + (A + 1.0) * cosw) / a0);
+    section.a2 = (AkReal32)(((A + 1.0) + (A - 1.0) * cosw - twoSqrtAAlpha) / a0);
+    return section;
+}
+
+SidechainBiquad SidechainBiquad::highShelf(double frequency, double sampleRate, double gainDb)
+{
+    const double A = pow(10.0, gainDb / 40.0);
+    const double w0 = 2.0 * kPi * frequency / sampleRate;
+    const double cosw = cos(w0);
+    const double twoSqrtAAlpha = 2.0 * sqrt(A) * sin(w0) * 0.70710678118654752;
+    const double a0 = (A + 1.0) - (A - 1.0) * cosw + twoSqrtAAlpha;
+    SidechainBiquad section;
+    section.b0 = (AkReal32)(A * ((A + 1.0) + (A - 1.0) * cosw + twoSqrtAAlpha) / a0);
+    section.b1 = (AkReal32)(-2.0 * A * ((A - 1.0) + (A + 1.0) * cosw) / a0);
+    section.b2 = (AkReal32)(A * ((A + 1.0) + (A - 1.0) * cosw - twoSqrtAAlpha) / a0);
+    section.a1 = (AkReal32)(2.0 * ((A - 1.0) - (A + 1.0) * cosw) / a0);
+    section.a2 = (AkReal32)(((A + 1.0) - (A - 1.0) * cosw - twoSqrtAAlpha) / a0);
+    return section;
+}
+
+AKRESULT SidechainBiquadBank::init(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 maxLanes)
+{
+    term();
+
+    allocator = in_pAllocator;
+    laneCapacity = getLaneCount(AkMax(maxLanes, (AkUInt32)1));
+
+    const size_t rows = (size_t)kMaxSections * (kNumCoefs + kNumStates);
+    block = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(AkReal32) * rows * laneCapacity + sizeof(AkUInt32) * laneCapacity, SidechainDetector::kAlignment);
+    if (block == nullptr)
+    {
+        return AK_InsufficientMemory;
+    }
+    coefs = block;
+    state = block + (size_t)kMaxSections * kNumCoefs * laneCapacity;
+    laneChannels = (AkUInt32*)(block + rows * laneCapacity);
+
+    filterCascade = filterScalar;
+#ifdef SC_BIQUAD_X64
+    filterCascade = SidechainGainKernel::detectIsa() >= SidechainGainKernel::Isa_AVX2 ? filterCascadeAVX2 : filterCascadeSSE2;
+#endif
+
+    setLayout(0, 0);
+    return AK_Success;
+}
+
+void SidechainBiquadBank::term()
+{
+    if (block)
+    {
+        AK_PLUGIN_FREE_ALIGN(allocator, block);
+        block = nullptr;
+        coefs = nullptr;
+        state = nullptr;
+        laneChannels = nullptr;
+    }
+    laneCapacity = 0;
+    numUsed = 0;
+    numLanes = 0;
+    numSections = 0;
+}
+
+void SidechainBiquadBank::reset()
+{
+    if (state)
+    {
+        memset(state, 0, sizeof(AkReal32) * (size_t)kMaxSections * kNumStates * laneCapacity);
+    }
+}
+
+void SidechainBiquadBank::setLayout(AkUInt32 in_numUsed, AkUInt32 in_numSections)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    numUsed = AkMin(in_numUsed, laneCapacity);
+    numLanes = getLaneCount(numUsed);
+    numSections = AkMin(in_numSections, kMaxSections);
+    for (AkUInt32 lane = 0; lane < laneCapacity; ++lane)
+    {
+        laneChannels[lane] = 0;
+        for (AkUInt32 section = 0; section < kMaxSections; ++section)
+        {
+            setSection(lane, section, SidechainBiquad());
+        }
+    }
+    reset();
+}
+
+void SidechainBiquadBank::setInput(AkUInt32 lane, AkUInt32 channel)
+{
+    if (lane < laneCapacity)
+    {
+        laneChannels[lane] = channel;
+    }
+}
+
+void SidechainBiquadBank::setSection(AkUInt32 lane, AkUInt32 section, const SidechainBiquad& coef)
+{
+    if (lane >= laneCapacity || section >= kMaxSections)
+    {
+        return;
+    }
+    AkReal32* pRows = coefs + (size_t)section * kNumCoefs * laneCapacity;
+    pRows[lane] = coef.b0;
+    pRows[laneCapacity + lane] = coef.b1;
+    pRows[2 * laneCapacity + lane] = coef.b2;
+    pRows[3 * laneCapacity + lane] = coef.a1;
+    pRows[4 * laneCapacity + lane] = coef.a2;
+}
+
+void SidechainBiquadBank::process(const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 in_uNumFrames)
+{
+    if (block == nullptr || in_uNumFrames == 0)
+    {
+        return;
+    }
+
+    // Each group of lanes gathers its channels of every frame and runs its cascade, in one pass
+    // over the block; padding lanes stay silent
+    const AkUInt32 uLanes = numLanes;
+    const AkUInt32 uUsed = numUsed;
+    for (AkUInt32 group = 0; group < uLanes; group += kGroupWidth)
+    {
+        AkReal32* pState = state + group;
+        filterCascade(coefs + group, pState, laneCapacity, numSections, laneChannels + group, uUsed - group,
+            in_pFrames, in_uStride, out_pLanes + group, uLanes, in_uNumFrames);
+
+        // Flushed once per block
+        for (AkUInt32 row = 0; row < numSections * kNumStates; ++row)
+        {
+            AkReal32* pRow = pState + (size_t)row * laneCapacity;
+            for (AkUInt32 k = 0; k < kGroupWidth; ++k)
+            {
+                pRow[k] = fabsf(pRow[k]) < kStateFloor ? 0.0f : pRow[k];
+            }
+        }
+    }
+}
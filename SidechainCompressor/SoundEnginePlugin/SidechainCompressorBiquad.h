@@ -0,0 +1,86 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+// One 2nd-order section in transposed direct form II, normalized: b0 b1 b2 a1 a2. The designs
+// are the RBJ cookbook's; frequencies are in Hz and must be under Nyquist.
+struct SidechainBiquad
+{
+    AkReal32 b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+    static SidechainBiquad lowPass(double frequency, double sampleRate, double q);
+    static SidechainBiquad highPass(double frequency, double sampleRate, double q);
+    static SidechainBiquad bandPass(double frequency, double sampleRate, double q);     // 0 dB at the centre
+    static SidechainBiquad allPass(double frequency, double sampleRate, double q);
+    static SidechainBiquad lowShelf(double frequency, double sampleRate, double gainDb);  // Shelf slope 1
+    static SidechainBiquad highShelf(double frequency, double sampleRate, double gainDb);
+};
+
+// Cascades of 2nd-order sections, one per lane, run side by side.
+//
+// Each lane reads one channel of a frame-major input and runs its own cascade of up to
+// kMaxSections sections. The lanes are independent recurrences in time, so the SIMD dimension
+// is the lanes: one pass over the frames filters every lane, kGroupWidth at a time, with the
+// whole cascade of a group kept in registers. An AVX2/FMA kernel gathers a group's input in one
+// instruction; SSE2 and scalar kernels are the fallbacks. Lanes past the ones in use are silent.
+class SidechainBiquadBank
+{
+public:
+    static const AkUInt32 kGroupWidth = 8;              // Lanes filtered together, two SSE vectors or one AVX
+    static const AkUInt32 kMaxSections = 6;
+
+    SidechainBiquadBank() = default;
+    SidechainBiquadBank(const SidechainBiquadBank&) = delete;
+    SidechainBiquadBank& operator=(const SidechainBiquadBank&) = delete;
+    ~SidechainBiquadBank() { term(); }
+
+    // Allocates coefficients and state for maxLanes lanes of kMaxSections sections, so no
+    // layout ever allocates.
+    AKRESULT init(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 maxLanes);
+    void term();
+
+    // Back to silence; keeps the layout and coefficients.
+    void reset();
+
+    // numUsed lanes of numSections sections each, every lane reading channel 0 and passing it
+    // through until told otherwise. Restarts from silence.
+    void setLayout(AkUInt32 numUsed, AkUInt32 numSections);
+
+    // Channel of the input lane reads, and its coefficients for one section. Coefficients can
+    // move while the state carries on.
+    void setInput(AkUInt32 lane, AkUInt32 channel);
+    void setSection(AkUInt32 lane, AkUInt32 section, const SidechainBiquad& coefs);
+
+    // Filters in_uNumFrames frame-major frames, in_uStride samples apart, into out_pLanes:
+    // getNumLanes() per frame.
+    void process(const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 in_uNumFrames);
+
+    bool isReady() const { return block != nullptr; }
+    AkUInt32 getNumUsed() const { return numUsed; }
+    AkUInt32 getNumLanes() const { return numLanes; }
+    AkUInt32 getNumSections() const { return numSections; }
+
+    // numUsed lanes in whole groups
+    static AkUInt32 getLaneCount(AkUInt32 numUsed)
+    {
+        return (numUsed + kGroupWidth - 1) / kGroupWidth * kGroupWidth;
+    }
+
+private:
+    // One group of lanes, from the input through the first in_uSections sections, for this CPU
+    typedef void (*FilterFunc)(const AkReal32* in_pCoefs, AkReal32* io_pState, size_t rowStride, AkUInt32 in_uSections, const AkUInt32* in_pChannels, AkUInt32 in_uUsed,
+        const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 out_uStride, AkUInt32 in_uNumFrames);
+    FilterFunc filterCascade = nullptr;
+
+    AkUInt32 laneCapacity = 0;
+    AkUInt32 numUsed = 0;
+    AkUInt32 numLanes = 0;
+    AkUInt32 numSections = 0;
+
+    AK::IAkPluginMemAlloc* allocator = nullptr;
+    AkReal32* block = nullptr;                  // Coefficients, state and lane inputs, one aligned allocation
+    AkReal32* coefs = nullptr;                  // Per section: b0, b1, b2, a1, a2 rows of laneCapacity
+    AkReal32* state = nullptr;                  // Per section: z1, z2 rows of laneCapacity
+    AkUInt32* laneChannels = nullptr;           // Input channel of each lane
+};
@@ -0,0 +1,104 @@
+#include "SidechainCompressorCrossover.h"
+
+#include <algorithm>
+
+namespace
+{
+    const double kButterworthQ = 0.70710678118654752;
+}
+
+AKRESULT SidechainCrossover::init(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_maxChannels, AkUInt32 in_maxBands)
+{
+    term();
+
+    maxChannels = AkMax(in_maxChannels, (AkUInt32)1);
+    maxBands = AkMin(AkMax(in_maxBands, (AkUInt32)1), kMaxBands);
+    if (bank.init(in_pAllocator, maxBands * maxChannels) != AK_Success)
+    {
+        return AK_InsufficientMemory;
+    }
+
+    numBands = 0;
+    numChannels = 0;
+    const AkReal32 frequencies[kMaxBands - 1] = { kDefaultFrequencies[0], kDefaultFrequencies[1], kDefaultFrequencies[2] };
+    setBands(1, maxChannels, frequencies, 48000);
+    return AK_Success;
+}
+
+void SidechainCrossover::term()
+{
+    bank.term();
+}
+
+void SidechainCrossover::reset()
+{
+    bank.reset();
+}
+
+void SidechainCrossover::setBands(AkUInt32 in_numBands, AkUInt32 in_numChannels, const AkReal32* in_pFrequencies, AkUInt32 sampleRate)
+{
+    if (!bank.isReady())
+    {
+        return;
+    }
+
+    in_numBands = AkMin(AkMax(in_numBands, (AkUInt32)1), maxBands);
+    in_numChannels = AkMin(in_numChannels, maxChannels);
+    if (in_numBands != numBands || in_numChannels != numChannels)
+    {
+        numBands = in_numBands;
+        numChannels = in_numChannels;
+        bank.setLayout(numBands * numChannels, 2 * (numBands - 1));
+        for (AkUInt32 lane = 0; lane < numBands * numChannels; ++lane)
+        {
+            bank.setInput(lane, lane % numChannels);
+        }
+    }
+
+    // Ascending, inside the audible range and under Nyquist
+    const double rate = (double)AkMax(sampleRate, (AkUInt32)1);
+    const double highest = AkMin((double)kMaxFrequency, rate * 0.45);
+    double frequencies[kMaxBands - 1];
+    for (AkUInt32 i = 0; i + 1 < numBands; ++i)
+    {
+        frequencies[i] = AkMin(AkMax((double)in_pFrequencies[i], (double)kMinFrequency), highest);
+    }
+    std::sort(frequencies, frequencies + (numBands - 1));
+
+    // Each band's cascade from the input, padded with pass-through sections. Butterworth
+    // squared is the Linkwitz-Riley low and high pass, and the all-pass with the same pole pair
+    // is exactly their sum.
+    SidechainBiquad cascade[kMaxBands][kMaxSections];
+    for (AkUInt32 band = 0; band < numBands; ++band)
+    {
+        AkUInt32 section = 0;
+        for (AkUInt32 i = 0; i < band; ++i)
+        {
+            cascade[band][section++] = SidechainBiquad::highPass(frequencies[i], rate, kButterworthQ);
+            cascade[band][section++] = SidechainBiquad::highPass(frequencies[i], rate, kButterworthQ);
+        }
+        if (band + 1 < numBands)
+        {
+            cascade[band][section++] = SidechainBiquad::lowPass(frequencies[band], rate, kButterworthQ);
+            cascade[band][section++] = SidechainBiquad::lowPass(frequencies[band], rate, kButterworthQ);
+        }
+        for (AkUInt32 i = band + 1; i + 1 < numBands; ++i)
+        {
+            cascade[band][section++] = SidechainBiquad::allPass(frequencies[i], rate, kButterworthQ);
+        }
+    }
+
+    // Spread over the lanes; the bank keeps its padding lanes silent
+    for (AkUInt32 lane = 0; lane < numBands * numChannels; ++lane)
+    {
+        for (AkUInt32 section = 0; section < bank.getNumSections(); ++section)
+        {
+            bank.setSection(lane, section, cascade[lane / numChannels][section]);
+        }
+    }
+}
+
+void SidechainCrossover::process(const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 in_uNumFrames)
+{
+    bank.process(in_pFrames, in_uStride, out_pLanes, in_uNumFrames);
+}
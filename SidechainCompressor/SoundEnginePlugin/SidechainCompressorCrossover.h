@@ -0,0 +1,71 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+#include "SidechainCompressorBiquad.h"
+
+// Linkwitz-Riley band split for multiband ducking.
+//
+// Each crossover is a 4th-order Linkwitz-Riley pair: low and high pass are each two cascaded
+// 2nd-order Butterworth sections, and together they sum to the 2nd-order all-pass at the
+// crossover. Splitting as a tree, with that all-pass on the lower bands for every crossover
+// above them, makes all the bands sum to an all-pass: flat, so bands left at unity gain put
+// back together are the input, only phase shifted.
+//
+// Written out, every band is a cascade straight from the input: the high passes of the
+// crossovers below it, its own low pass and the all-passes of the crossovers above. Padded
+// with pass-through sections to the longest, 2 * (bands - 1), every channel of every band
+// runs the same cascade with its own coefficients, as the lanes of one SidechainBiquadBank: one
+// pass over the frames filters all the channels of all the bands.
+class SidechainCrossover
+{
+public:
+    static const AkUInt32 kMaxBands = 4;
+    static const AkUInt32 kMaxSections = 2 * (kMaxBands - 1);
+    static const AkUInt32 kGroupWidth = SidechainBiquadBank::kGroupWidth;
+    static constexpr AkReal32 kMinFrequency = 20.0f;
+    static constexpr AkReal32 kMaxFrequency = 20000.0f;
+    static constexpr AkReal32 kDefaultFrequencies[kMaxBands - 1] = { 250.0f, 2000.0f, 8000.0f };
+
+    SidechainCrossover() = default;
+    SidechainCrossover(const SidechainCrossover&) = delete;
+    SidechainCrossover& operator=(const SidechainCrossover&) = delete;
+    ~SidechainCrossover() { term(); }
+
+    // Allocates coefficients and state for up to maxBands bands of maxChannels channels, so
+    // neither a new layout nor new frequencies ever allocate.
+    AKRESULT init(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 maxChannels, AkUInt32 maxBands);
+    void term();
+
+    // Back to silence; keeps the layout and frequencies.
+    void reset();
+
+    // Splits numChannels channels into numBands bands at the numBands - 1 crossover frequencies,
+    // in Hz, clamped to kMinFrequency - kMaxFrequency and below Nyquist, and sorted. A change of
+    // layout restarts from silence; new frequencies only replace the coefficients.
+    void setBands(AkUInt32 numBands, AkUInt32 numChannels, const AkReal32* in_pFrequencies, AkUInt32 sampleRate);
+
+    // Filters in_uNumFrames frame-major frames of getNumChannels() samples, in_uStride apart,
+    // into out_pLanes: getNumLanes() per frame, band b of channel c at lane b * numChannels + c.
+    // Lanes past the last band are zero.
+    void process(const AkReal32* in_pFrames, AkUInt32 in_uStride, AkReal32* out_pLanes, AkUInt32 in_uNumFrames);
+
+    AkUInt32 getNumBands() const { return numBands; }
+    AkUInt32 getNumChannels() const { return numChannels; }
+    AkUInt32 getNumLanes() const { return bank.getNumLanes(); }
+
+    // Lanes for numBands bands of numChannels channels, in whole groups
+    static AkUInt32 getLaneCount(AkUInt32 numBands, AkUInt32 numChannels)
+    {
+        return SidechainBiquadBank::getLaneCount(numBands * numChannels);
+    }
+
+private:
+    AkUInt32 maxChannels = 0;
+    AkUInt32 maxBands = 0;
+    AkUInt32 numBands = 0;
+    AkUInt32 numChannels = 0;
+
+    SidechainBiquadBank bank;                   // Lane b * numChannels + c: band b of channel c
+};
@@ -0,0 +1,236 @@
+#include "SidechainCompressorDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+AKRESULT SidechainDetector::init(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_maxChannels, AkUInt32 in_sampleRate)
+{
+    term();
+
+    allocator = in_pAllocator;
+    maxChannels = in_maxChannels;
+    sampleRate = in_sampleRate > 0 ? in_sampleRate : 48000;
+    // One spare row, so the row leaving the window is never the row being written
+    capacity = (AkUInt32)ceilf(kMaxWindowMs * 0.001f * sampleRate) + 1;
+
+    if (maxChannels > 0)
+    {
+        history = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(AkReal32) * (size_t)maxChannels * capacity, kAlignment);
+    }
+    meanSquare = (double*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(double) * AkMax(maxChannels, (AkUInt32)1), kAlignment);
+    if ((maxChannels > 0 && history == nullptr) || meanSquare == nullptr)
+    {
+        term();
+        return AK_InsufficientMemory;
+    }
+
+    mode = Mode_SlidingWindow;
+    windowFrames = 0;
+    reset();
+    setWindow(kDefaultWindowMs, Mode_SlidingWindow);
+    return AK_Success;
+}
+
+void SidechainDetector::term()
+{
+    if (history)
+    {
+        AK_PLUGIN_FREE_ALIGN(allocator, history);
+        history = nullptr;
+    }
+    if (meanSquare)
+    {
+        AK_PLUGIN_FREE_ALIGN(allocator, meanSquare);
+        meanSquare = nullptr;
+    }
+    capacity = 0;
+}
+
+AKRESULT SidechainDetector::grow(AkUInt32 in_maxChannels)
+{
+    if (capacity == 0)
+    {
+        return AK_Fail;
+    }
+    if (in_maxChannels <= maxChannels)
+    {
+        return AK_Success;
+    }
+
+    AkReal32* newHistory = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(AkReal32) * (size_t)in_maxChannels * capacity, kAlignment);
+    double* newMeanSquare = (double*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(double) * in_maxChannels, kAlignment);
+    if (newHistory == nullptr || newMeanSquare == nullptr)
+    {
+        if (newHistory)
+        {
+            AK_PLUGIN_FREE_ALIGN(allocator, newHistory);
+        }
+        if (newMeanSquare)
+        {
+            AK_PLUGIN_FREE_ALIGN(allocator, newMeanSquare);
+        }
+        return AK_InsufficientMemory;
+    }
+
+    // Row by row into the wider rows; the new channels have never been fed
+    memset(newHistory, 0, sizeof(AkReal32) * (size_t)in_maxChannels * capacity);
+    memset(newMeanSquare, 0, sizeof(double) * in_maxChannels);
+    if (maxChannels > 0)
+    {
+        for (AkUInt32 row = 0; row < capacity; ++row)
+        {
+            memcpy(newHistory + (size_t)row * in_maxChannels, history + (size_t)row * maxChannels, sizeof(AkReal32) * maxChannels);
+        }
+        memcpy(newMeanSquare, meanSquare, sizeof(double) * maxChannels);
+        AK_PLUGIN_FREE_ALIGN(allocator, history);
+    }
+    AK_PLUGIN_FREE_ALIGN(allocator, meanSquare);
+    history = newHistory;
+    meanSquare = newMeanSquare;
+    maxChannels = in_maxChannels;
+    return AK_Success;
+}
+
+void SidechainDetector::reset()
+{
+    if (capacity == 0)
+    {
+        return;
+    }
+    if (history)
+    {
+        memset(history, 0, sizeof(AkReal32) * (size_t)maxChannels * capacity);
+    }
+    memset(meanSquare, 0, sizeof(double) * AkMax(maxChannels, (AkUInt32)1));
+    writePos = 0;
+}
+
+void SidechainDetector::setWindow(AkReal32 windowMs, Mode in_mode)
+{
+    if (capacity == 0)
+    {
+        return;
+    }
+
+    windowMs = std::min(std::max(windowMs, kMinWindowMs), kMaxWindowMs);
+    const AkUInt32 frames = std::min(std::max((AkUInt32)(windowMs * 0.001f * sampleRate + 0.5f), (AkUInt32)1), capacity - 1);
+
+    if (frames == windowFrames && in_mode == mode)
+    {
+        return;
+    }
+
+    windowFrames = frames;
+    mode = in_mode;
+    onePoleCoef = 1.0 - exp(-1.0 / windowFrames);
+
+    // Both modes carry on from the mean of the new window, so changing either is seamless
+    for (AkUInt32 channel = 0; channel < maxChannels; ++channel)
+    {
+        const double sum = windowSum(channel);
+        meanSquare[channel] = mode == Mode_SlidingWindow ? sum : sum / windowFrames;
+    }
+}
+
+double SidechainDetector::windowSum(AkUInt32 channel) const
+{
+    double sum = 0.0;
+    AkUInt32 pos = writePos;
+    for (AkUInt32 frame = 0; frame < windowFrames; ++frame)
+    {
+        pos = pos == 0 ? capacity - 1 : pos - 1;
+        sum += history[(size_t)pos * maxChannels + channel];
+    }
+    return sum;
+}
+
+void SidechainDetector::process(const AkReal32* in_pFrames, AkUInt32 in_uNumChannels, AkUInt32 in_uNumFrames, const AkReal32* in_pMeanSquares)
+{
+    if (capacity == 0)
+    {
+        return;
+    }
+
+    // Separate loops, so the plain one keeps nothing but the square per sample
+    if (in_pMeanSquares)
+    {
+        processFrames<true>(in_pFrames, in_uNumChannels, in_uNumFrames, in_pMeanSquares);
+    }
+    else
+    {
+        processFrames<false>(in_pFrames, in_uNumChannels, in_uNumFrames, nullptr);
+    }
+}
+
+template <bool AddMeanSquares>
+void SidechainDetector::processFrames(const AkReal32* in_pFrames, AkUInt32 in_uNumChannels, AkUInt32 in_uNumFrames, const AkReal32* in_pMeanSquares)
+{
+    const AkUInt32 numChannels = std::min(in_uNumChannels, maxChannels);
+    double* AK_RESTRICT pState = meanSquare;
+    AkReal32* pHistory = history;
+
+    // The row leaving the window was written windowFrames rows ago
+    AkUInt32 pos = writePos;
+    AkUInt32 oldest = pos >= windowFrames ? pos - windowFrames : pos + capacity - windowFrames;
+
+    if (mode == Mode_SlidingWindow)
+    {
+        for (AkUInt32 frame = 0; frame < in_uNumFrames; ++frame)
+        {
+            const AkReal32* AK_RESTRICT pIn = in_pFrames + (size_t)frame * in_uNumChannels;
+            AkReal32* AK_RESTRICT pRow = pHistory + (size_t)pos * maxChannels;
+            const AkReal32* AK_RESTRICT pOldest = pHistory + (size_t)oldest * maxChannels;
+            for (AkUInt32 channel = 0; channel < numChannels; ++channel)
+            {
+                AkReal32 square = pIn[channel] * pIn[channel];
+                if (AddMeanSquares)
+                    square += in_pMeanSquares[channel];
+                pState[channel] += (double)square - (double)pOldest[channel];
+                pRow[channel] = square;
+            }
+            pos = pos + 1 == capacity ? 0 : pos + 1;
+            oldest = oldest + 1 == capacity ? 0 : oldest + 1;
+        }
+
+        // Rounding can leave a sum a hair below zero after a loud passage
+        for (AkUInt32 channel = 0; channel < numChannels; ++channel)
+        {
+            pState[channel] = std::max(pState[channel], 0.0);
+        }
+    }
+    else
+    {
+        const double coef = onePoleCoef;
+        for (AkUInt32 frame = 0; frame < in_uNumFrames; ++frame)
+        {
+            const AkReal32* AK_RESTRICT pIn = in_pFrames + (size_t)frame * in_uNumChannels;
+            AkReal32* AK_RESTRICT pRow = pHistory + (size_t)pos * maxChannels;
+            for (AkUInt32 channel = 0; channel < numChannels; ++channel)
+            {
+                AkReal32 square = pIn[channel] * pIn[channel];
+                if (AddMeanSquares)
+                    square += in_pMeanSquares[channel];
+                pState[channel] += ((double)square - pState[channel]) * coef;
+                pRow[channel] = square;
+            }
+            pos = pos + 1 == capacity ? 0 : pos + 1;
+        }
+    }
+
+    writePos = pos;
+}
+
+AkReal32 SidechainDetector::getMeanSquare(AkUInt32 channel) const
+{
+    if (channel >= maxChannels || capacity == 0)
+    {
+        return 0.0f;
+    }
+    return (AkReal32)(mode == Mode_SlidingWindow ? meanSquare[channel] / windowFrames : meanSquare[channel]);
+}
+
+AkReal32 SidechainDetector::getRMS(AkUInt32 channel) const
+{
+    return sqrtf(getMeanSquare(channel));
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+// Running mean-square level detector for the summed sidechain.
+//
+// Sliding window: the squares of the last windowFrames samples are kept in a ring and a
+// running sum is updated with one add and one subtract per sample, so the result is the
+// exact mean of the window whatever its length.
+// One-pole: ms += (x^2 - ms) * (1 - exp(-1 / windowFrames)), an exponentially weighted
+// mean square with the window as its time constant.
+//
+// Both run in O(1) per sample and keep the mean square; the square root is only taken
+// when a level is read (getRMS), once per channel per audio frame.
+//
+// The running sums are a serial recurrence in time, so the SIMD dimension is the channels:
+// input and history are frame-major and the per-channel state is a flat array, which makes
+// the inner loop over channels a straight vector loop on wide buses.
+class SidechainDetector
+{
+public:
+    enum Mode
+    {
+        Mode_SlidingWindow = 0,
+        Mode_OnePole = 1
+    };
+
+    static constexpr AkReal32 kMinWindowMs = 1.0f;
+    static constexpr AkReal32 kMaxWindowMs = 300.0f;
+    static constexpr AkReal32 kDefaultWindowMs = 10.0f;
+    static constexpr AkUInt32 kAlignment = 64;          // Bytes: a cache line, and the widest vector
+
+    SidechainDetector() = default;
+    SidechainDetector(const SidechainDetector&) = delete;
+    SidechainDetector& operator=(const SidechainDetector&) = delete;
+    ~SidechainDetector() { term(); }
+
+    // Allocates the history for maxChannels and kMaxWindowMs from in_pAllocator, so neither
+    // a window change nor a wider input ever allocates. maxChannels may be zero.
+    AKRESULT init(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 maxChannels, AkUInt32 sampleRate);
+    void term();
+
+    // Widens the history to maxChannels, keeping every channel's window and state; the new
+    // channels start silent. Allocates, so it is for the Init path only.
+    AKRESULT grow(AkUInt32 maxChannels);
+
+    // Back to silence, by zeroing; keeps the window and mode.
+    void reset();
+
+    // Changing the sliding window length rebuilds the running sums from the history
+    // (O(window), once); switching mode restarts the one-pole from the current window mean.
+    void setWindow(AkReal32 windowMs, Mode mode);
+
+    // Feeds in_uNumFrames frames of in_uNumChannels interleaved samples (frame-major).
+    // The channel count may grow between calls but not shrink: channels that were never
+    // fed are silent, and their history stays zero without being written.
+    // in_pMeanSquares, when set, holds a mean square per channel added to every frame's square:
+    // power that arrives as block energy rather than as samples.
+    void process(const AkReal32* in_pFrames, AkUInt32 in_uNumChannels, AkUInt32 in_uNumFrames, const AkReal32* in_pMeanSquares = nullptr);
+
+    AkUInt32 getMaxChannels() const { return maxChannels; }
+    AkUInt32 getWindowFrames() const { return windowFrames; }
+    Mode getMode() const { return mode; }
+
+    AkReal32 getMeanSquare(AkUInt32 channel) const;
+    AkReal32 getRMS(AkUInt32 channel) const;
+
+private:
+    double windowSum(AkUInt32 channel) const;
+
+    template <bool AddMeanSquares>
+    void processFrames(const AkReal32* in_pFrames, AkUInt32 in_uNumChannels, AkUInt32 in_uNumFrames, const AkReal32* in_pMeanSquares);
+
+    Mode mode = Mode_SlidingWindow;
+    AkUInt32 maxChannels = 0;
+    AkUInt32 sampleRate = 48000;
+    AkUInt32 capacity = 0;                      // History rows, one more than the longest window
+    AkUInt32 windowFrames = 1;
+    AkUInt32 writePos = 0;                      // Next history row
+    double onePoleCoef = 1.0;                   // 1 - exp(-1 / windowFrames)
+
+    AK::IAkPluginMemAlloc* allocator = nullptr;
+    AkReal32* history = nullptr;                // Squares, frame-major, capacity * maxChannels
+    double* meanSquare = nullptr;               // Per channel: running sum (sliding) or mean square (one-pole)
+};
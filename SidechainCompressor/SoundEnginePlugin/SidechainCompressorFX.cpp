@@ -28,6 +28,13 @@ the specific language governing permissions and limitations under the License.
 #include "../SidechainCompressorConfig.h"
 
 #include <AK/AkWwiseSDKVersion.h>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// SSE2 is always there on x64; compilers leave the follower's lanes scalar
+#define SC_FOLLOWER_SSE2
+#include <emmintrin.h>
+#endif
 
 AK::IAkPlugin* CreateSidechainCompressorFX(AK::IAkPluginMemAlloc* in_pAllocator)
 {
@@ -41,6 +48,166 @@ AK::IAkPluginParam* CreateSidechainCompressorFXParams(AK::IAkPluginMemAlloc* in_
 
 AK_IMPLEMENT_PLUGIN_FACTORY(SidechainCompressorFX, AkPluginTypeEffect, SidechainCompressorConfig::CompanyID, SidechainCompressorConfig::PluginID)
 
+namespace
+{
+    // A one-pole with coefficient coef, stepped once per frame over steps frames of a level
+    // ramping linearly, ends where one step of coefficient 1 - (1 - coef)^steps ends when it
+    // is fed the ramp's level this many frames before the last frame. So a control-rate step
+    // reads the level there and lands on the full-rate envelope instead of ahead of it.
+    AkReal32 followerLag(AkReal32 coef, AkUInt32 steps)
+    {
+        const double a = coef;
+        const double b = 1.0 - a;
+        const double n = steps;
+        if (steps < 2 || a >= 1.0)
+        {
+            return 0.0f;
+        }
+        if (a < 1.0e-9)
+        {
+            return (AkReal32)((n - 1.0) / 2.0);
+        }
+        const double bn = pow(b, n);
+        return (AkReal32)(b * (1.0 - n * bn / b + (n - 1.0) * bn) / (a * (1.0 - bn)));
+    }
+
+    // One block of the attack/release follower, shared by every group of lanes
+    struct FollowerRamp
+    {
+        const AkReal32* from;           // Detector level at the start of the audio frame, per lane
+        const AkReal32* slope;          // Its change over the audio frame, per lane
+        AkReal32* detector;             // Frame-major output, stride lanes per point
+        AkUInt32 stride;
+        AkReal32* gain;                 // Or at full rate, straight into lane-major rows of the first lanes
+        size_t gainStride;
+        AkUInt32 lanes;
+        AkUInt32 first;
+        AkUInt32 points;
+        AkUInt32 controlRate;
+        AkUInt32 frames;
+        AkUInt32 position;
+        bool fullRate;
+        AkReal32 invLength;
+        AkReal32 attack, release;
+        AkReal32 lastAttack, lastRelease;
+        AkReal32 attackLag, releaseLag;             // followerLag of each step, zero at full rate
+        AkReal32 lastAttackLag, lastReleaseLag;
+    };
+
+    // Width lanes from group through the block, one vector across lanes. Each lane is a serial
+    // chain in time, so a wider group keeps more chains in flight, and writing the lanes out one
+    // by one into their gain rows fits in the wait.
+    template <AkUInt32 Width>
+    void followGroup(const FollowerRamp& ramp, AkUInt32 group, AkReal32* io_pEnvelope)
+    {
+#ifdef SC_FOLLOWER_SSE2
+        const AkUInt32 kVectors = Width / 4;
+        __m128 e[kVectors], x0[kVectors], dx[kVectors];
+        for (AkUInt32 v = 0; v < kVectors; ++v)
+        {
+            e[v] = _mm_loadu_ps(io_pEnvelope + group + v * 4);
+            x0[v] = _mm_loadu_ps(ramp.from + group + v * 4);
+            dx[v] = _mm_loadu_ps(ramp.slope + group + v * 4);
+            if (!ramp.fullRate)
+            {
+                _mm_storeu_ps(ramp.detector + group + v * 4, e[v]);
+            }
+        }
+
+        for (AkUInt32 point = ramp.first; point < ramp.points; ++point)
+        {
+            // A step ends on frame, so the next block's first frame closes the last one; it reads
+            // the level its lag before that
+            const AkUInt32 frame = ramp.fullRate ? point : AkMin(point * ramp.controlRate, ramp.frames);
+            const bool bLast = point + 1 == ramp.points;
+            const __m128 t = _mm_set1_ps(((AkReal32)(ramp.position + frame) - (bLast ? ramp.lastAttackLag : ramp.attackLag)) * ramp.invLength);
+            const __m128 tRelease = _mm_set1_ps(((AkReal32)(ramp.position + frame) - (bLast ? ramp.lastReleaseLag : ramp.releaseLag)) * ramp.invLength);
+            const __m128 a = _mm_set1_ps(bLast ? ramp.lastAttack : ramp.attack);
+            const __m128 r = _mm_set1_ps(bLast ? ramp.lastRelease : ramp.release);
+            AkReal32* AK_RESTRICT pPoint = ramp.detector + (size_t)point * ramp.stride + group;
+            for (AkUInt32 v = 0; v < kVectors; ++v)
+            {
+                // Rising is compared on the level itself, beside the subtraction, not after it
+                __m128 level = _mm_add_ps(x0[v], _mm_mul_ps(t, dx[v]));
+                const __m128 rising = _mm_cmpgt_ps(level, e[v]);
+                if (!ramp.fullRate)
+                {
+                    level = _mm_or_ps(_mm_and_ps(rising, level), _mm_andnot_ps(rising, _mm_add_ps(x0[v], _mm_mul_ps(tRelease, dx[v]))));
+                }
+                const __m128 delta = _mm_sub_ps(level, e[v]);
+                const __m128 coef = _mm_or_ps(_mm_and_ps(rising, a), _mm_andnot_ps(rising, r));
+                e[v] = _mm_add_ps(e[v], _mm_mul_ps(delta, coef));
+                if (ramp.gain == nullptr)
+                {
+                    _mm_storeu_ps(pPoint + v * 4, e[v]);
+                    continue;
+                }
+                const AkUInt32 lane = group + v * 4;
+                AkReal32* AK_RESTRICT pGain = ramp.gain + (size_t)lane * ramp.gainStride + point;
+                pGain[0] = _mm_cvtss_f32(e[v]);
+                if (lane + 1 < ramp.lanes)
+                    pGain[ramp.gainStride] = _mm_cvtss_f32(_mm_shuffle_ps(e[v], e[v], _MM_SHUFFLE(1, 1, 1, 1)));
+                if (lane + 2 < ramp.lanes)
+                    pGain[2 * ramp.gainStride] = _mm_cvtss_f32(_mm_shuffle_ps(e[v], e[v], _MM_SHUFFLE(2, 2, 2, 2)));
+                if (lane + 3 < ramp.lanes)
+                    pGain[3 * ramp.gainStride] = _mm_cvtss_f32(_mm_shuffle_ps(e[v], e[v], _MM_SHUFFLE(3, 3, 3, 3)));
+            }
+        }
+
+        for (AkUInt32 v = 0; v < kVectors; ++v)
+        {
+            _mm_storeu_ps(io_pEnvelope + group + v * 4, e[v]);
+        }
+#else
+        AkReal32 e[Width], x0[Width], dx[Width];
+        for (AkUInt32 k = 0; k < Width; ++k)
+        {
+            e[k] = io_pEnvelope[group + k];
+            x0[k] = ramp.from[group + k];
+            dx[k] = ramp.slope[group + k];
+        }
+        if (!ramp.fullRate)
+        {
+            for (AkUInt32 k = 0; k < Width; ++k)
+            {
+                ramp.detector[group + k] = e[k];
+            }
+        }
+
+        for (AkUInt32 point = ramp.first; point < ramp.points; ++point)
+        {
+            const AkUInt32 frame = ramp.fullRate ? point : AkMin(point * ramp.controlRate, ramp.frames);
+            const bool bLast = point + 1 == ramp.points;
+            const AkReal32 t = ((AkReal32)(ramp.position + frame) - (bLast ? ramp.lastAttackLag : ramp.attackLag)) * ramp.invLength;
+            const AkReal32 tRelease = ((AkReal32)(ramp.position + frame) - (bLast ? ramp.lastReleaseLag : ramp.releaseLag)) * ramp.invLength;
+            const AkReal32 a = bLast ? ramp.lastAttack : ramp.attack;
+            const AkReal32 r = bLast ? ramp.lastRelease : ramp.release;
+            AkReal32* AK_RESTRICT pPoint = ramp.detector + (size_t)point * ramp.stride + group;
+            for (AkUInt32 k = 0; k < Width; ++k)
+            {
+                const AkReal32 level = x0[k] + t * dx[k];
+                const bool bRising = level > e[k];
+                const AkReal32 delta = (bRising ? level : x0[k] + tRelease * dx[k]) - e[k];
+                e[k] += delta * (bRising ? a : r);
+                if (ramp.gain == nullptr)
+                {
+                    pPoint[k] = e[k];
+                }
+                else if (group + k < ramp.lanes)
+                {
+                    ramp.gain[(size_t)(group + k) * ramp.gainStride + point] = e[k];
+                }
+            }
+        }
+
+        for (AkUInt32 k = 0; k < Width; ++k)
+        {
+            io_pEnvelope[group + k] = e[k];
+        }
+#endif
+    }
+}
+
 SidechainCompressorFX::SidechainCompressorFX()
     : m_pParams(nullptr)
     , m_pAllocator(nullptr)
@@ -50,7 +217,6 @@ SidechainCompressorFX::SidechainCompressorFX()
 
 SidechainCompressorFX::~SidechainCompressorFX()
 {
-    m_sharedBuffer->removeFromPriorityMap(objectID);
 }
 
 AKRESULT SidechainCompressorFX::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkEffectPluginContext* in_pContext, AK::IAkPluginParam* in_pParams, AkAudioFormat& in_rFormat)
@@ -61,43 +227,227 @@ AKRESULT SidechainCompressorFX::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::I
     m_pContext = in_pContext;
     SampleRate = in_rFormat.uSampleRate;
     priorityRank = m_pParams->RTPC.fPriorityRank;
+    m_uNumBands = AkMin((AkUInt32)AkMax(m_pParams->NonRTPC.iNumBands, (AkInt32)1), SidechainCrossover::kMaxBands);
+    AkReal32 crossovers[SidechainCrossover::kMaxBands - 1];
+    getCrossovers(crossovers);
 
     /**/
-    registerCallbacks();
-
-    // Register object to sharedBuffer's list of objects
-    if (in_pContext != nullptr)
+    // Join every group this instance feeds or listens to. Slots and ranks are claimed up
+    // front so Execute never allocates or locks.
+    objectID = in_pContext->GetAudioNodeID();
+    const AkUInt32 uFeedGroups = (AkUInt32)m_pParams->NonRTPC.iFeedGroups & GlobalManager::kAllGroups;
+    const AkUInt32 uListenGroups = (AkUInt32)m_pParams->NonRTPC.iListenGroups & GlobalManager::kAllGroups;
+    const SidechainContribution eContribution = m_pParams->NonRTPC.iContribution == SidechainContribution_BlockEnergy
+        ? SidechainContribution_BlockEnergy : SidechainContribution_Samples;
+    for (AkUInt32 group = 0; group < GlobalManager::kMaxGroups; ++group)
     {
-        objectID = in_pContext->GetAudioNodeID();
+        const AkUInt32 uBit = 1u << group;
+        if (((uFeedGroups | uListenGroups) & uBit) == 0)
+        {
+            continue;
+        }
+
+        GroupLink& link = m_groups[m_uNumGroups];
+        link.bus = GlobalManager::acquireBuffer(in_pContext->GlobalContext(), group);
+        if (!link.bus)
+        {
+            releaseGroups();
+            return AK_InsufficientMemory;
+        }
+        link.group = group;
+        ++m_uNumGroups;
+
+        // The bus detects at the engine's rate; a voice at another rate would sum misaligned
+        // and read levels on the wrong timescale, so it is refused rather than resampled
+        if (link.bus->getSampleRate() != in_rFormat.uSampleRate)
+        {
+            releaseGroups();
+            return AK_InvalidParameter;
+        }
+
+        // Every link holds a slot, even a listener's with nothing to contribute, so rank
+        // changes and contributions go straight to it
+        link.feeds = (uFeedGroups & uBit) != 0;
+        link.slot = link.feeds ? link.bus->acquireSlot(in_rFormat.GetNumChannels(), in_pContext->GlobalContext()->GetMaxBufferLength(), eContribution)
+                               : link.bus->acquireSlot(0, 0);
+        if (link.slot == SidechainCompressorSharedBuffer::kInvalidSlot)
+        {
+            releaseGroups();
+            return AK_InsufficientMemory;
+        }
+        if (uListenGroups & uBit)
+        {
+            link.listens = true;
+            link.bus->setRank(link.slot, priorityRank);
+            link.bus->setDetector(m_pParams->NonRTPC.fRMSWindow, (SidechainDetector::Mode)m_pParams->NonRTPC.iDetectorMode);
+            link.bus->setKeyFilter(getKeyFilter());
+            if (m_uNumBands > 1)
+            {
+                if (link.bus->reserveBands(m_uNumBands) != AK_Success)
+                {
+                    releaseGroups();
+                    return AK_InsufficientMemory;
+                }
+                link.bus->setBands(m_uNumBands, crossovers);
+            }
+        }
     }
-    m_sharedBuffer->AddToPriorityMap(objectID, priorityRank);
     /**/
+
+    // Per-channel state for whatever the bus is: stereo, 7.1.4, ambisonics...
+    m_uNumChannels = in_rFormat.channelConfig.uNumChannels;
+    const size_t uChannelBlock = (sizeof(AkReal32) + sizeof(AkUInt32)) * AkMax(m_uNumChannels, (AkUInt32)1);
+    void* pChannelBlock = AK_PLUGIN_ALLOC(in_pAllocator, uChannelBlock);
+    if (pChannelBlock == nullptr)
+    {
+        return AK_InsufficientMemory;
+    }
+    m_pChannelGain = (AkReal32*)pChannelBlock;
+    m_pChannelLane = (AkUInt32*)(m_pChannelGain + AkMax(m_uNumChannels, (AkUInt32)1));
+    for (AkUInt32 i = 0; i < m_uNumChannels; ++i)
+    {
+        m_pChannelGain[i] = 1.0f;
+    }
+
+    // Per-block detector and gain scratch in one aligned block, for as many distinct lanes
+    // as any link mode can give this channel count in every band, and the gain kernel for this CPU
+    m_uMaxFrames = in_pContext->GlobalContext()->GetMaxBufferLength();
+    m_uMaxLanes = AkMax(AkMin(m_uNumChannels, SidechainSnapshot::kMaxChannels + 1), (AkUInt32)1) * m_uNumBands;
+    m_uGainStride = SidechainCompressorSharedBuffer::alignFrames(m_uMaxFrames);
+    const AkUInt32 uPaddedLanes = (m_uMaxLanes + kFollowerWidth - 1) / kFollowerWidth * kFollowerWidth;
+    const size_t uDetectorSize = SidechainCompressorSharedBuffer::alignFrames((m_uMaxFrames + 1) * uPaddedLanes);
+    m_pDetector = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(in_pAllocator, sizeof(AkReal32) * (uDetectorSize + (size_t)m_uMaxLanes * m_uGainStride), SidechainCompressorSharedBuffer::kAlignment);
+    if (m_pDetector == nullptr)
+    {
+        return AK_InsufficientMemory;
+    }
+    m_pGain = m_pDetector + uDetectorSize;
+
+    updateChannelLanes();
+    updateFollower();
+    m_computeGain = SidechainGainKernel::getBestCompute();
+
+    // Optional curve tables, sized once for the step asked for
+    const AkUInt32 uTableEntries = SidechainGainTable::getNumEntries(m_pParams->NonRTPC.fCurveTableStep);
+    if (uTableEntries > 0)
+    {
+        const size_t uTableStride = SidechainCompressorSharedBuffer::alignFrames(uTableEntries + 1);
+        m_pTableBlock = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(in_pAllocator, sizeof(AkReal32) * uTableStride * 3, SidechainCompressorSharedBuffer::kAlignment);
+        if (m_pTableBlock == nullptr)
+        {
+            return AK_InsufficientMemory;
+        }
+        SidechainGainTable::fillLevels(m_pTableBlock, uTableEntries);
+        m_tables[0].init(m_pTableBlock, m_pTableBlock + uTableStride, uTableEntries);
+        m_tables[1].init(m_pTableBlock, m_pTableBlock + 2 * uTableStride, uTableEntries);
+        m_lookupGain = SidechainGainKernel::getBestLookup();
+    }
+
+    // Band split of every channel, and a chunk of scratch for its input and lanes
+    if (m_uNumBands > 1)
+    {
+        if (m_crossover.init(in_pAllocator, m_uNumChannels, m_uNumBands) != AK_Success)
+        {
+            return AK_InsufficientMemory;
+        }
+        m_crossover.setBands(m_uNumBands, m_uNumChannels, crossovers, SampleRate);
+        const size_t uBandSize = (size_t)kBandChunk * (SidechainCompressorSharedBuffer::alignFrames(m_uNumChannels) + m_crossover.getNumLanes());
+        m_pBandBlock = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(in_pAllocator, sizeof(AkReal32) * uBandSize, SidechainCompressorSharedBuffer::kAlignment);
+        if (m_pBandBlock == nullptr)
+        {
+            return AK_InsufficientMemory;
+        }
+    }
+
+    // Lookahead delay line, one aligned ring per channel. Fixed for the life of the
+    // instance, so the latency it adds never changes under the voice.
+    m_uLookahead = getLookaheadFrames(m_pParams->NonRTPC.fLookahead, SampleRate);
+    if (m_uLookahead > 0)
+    {
+        m_uDelayStride = SidechainCompressorSharedBuffer::alignFrames(m_uLookahead);
+        const size_t uDelaySize = sizeof(AkReal32) * m_uDelayStride * AkMax(m_uNumChannels, (AkUInt32)1);
+        m_pDelay = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(in_pAllocator, uDelaySize, SidechainCompressorSharedBuffer::kAlignment);
+        if (m_pDelay == nullptr)
+        {
+            return AK_InsufficientMemory;
+        }
+    }
+    Reset();
     
 
     return AK_Success;
 }
 
-#define AK_LINTODB( __lin__ ) (log10f(__lin__) * 20.f)
-
 AKRESULT SidechainCompressorFX::Term(AK::IAkPluginMemAlloc* in_pAllocator)
 {
-    // Unregister from list of objects
-    
-    m_sharedBuffer->removeFromPriorityMap(objectID);
+    releaseGroups();
 
-    if (m_sharedBuffer->PriorityMap.empty())
+    if (m_pDetector)
     {
-        unregisterCallbacks();
+        AK_PLUGIN_FREE_ALIGN(in_pAllocator, m_pDetector);
+        m_pDetector = nullptr;
+        m_pGain = nullptr;
+    }
+    if (m_pDelay)
+    {
+        AK_PLUGIN_FREE_ALIGN(in_pAllocator, m_pDelay);
+        m_pDelay = nullptr;
+    }
+    if (m_pTableBlock)
+    {
+        AK_PLUGIN_FREE_ALIGN(in_pAllocator, m_pTableBlock);
+        m_pTableBlock = nullptr;
+        m_lookupGain = nullptr;
+    }
+    if (m_pBandBlock)
+    {
+        AK_PLUGIN_FREE_ALIGN(in_pAllocator, m_pBandBlock);
+        m_pBandBlock = nullptr;
+    }
+    m_crossover.term();
+    if (m_pChannelGain)
+    {
+        AK_PLUGIN_FREE(in_pAllocator, m_pChannelGain);
+        m_pChannelGain = nullptr;
+        m_pChannelLane = nullptr;
     }
-    
-    
 
     AK_PLUGIN_DELETE(in_pAllocator, this);
     return AK_Success;
 }
 
+void SidechainCompressorFX::releaseGroups()
+{
+    for (AkUInt32 i = 0; i < m_uNumGroups; ++i)
+    {
+        GroupLink& link = m_groups[i];
+        link.bus->releaseSlot(link.slot);
+        link.bus.reset();
+        link.slot = SidechainCompressorSharedBuffer::kInvalidSlot;
+        link.feeds = false;
+        link.listens = false;
+        GlobalManager::releaseBuffer(m_pContext->GlobalContext(), link.group);
+    }
+    m_uNumGroups = 0;
+}
+
 AKRESULT SidechainCompressorFX::Reset()
 {
+    for (AkUInt32 i = 0; i < m_uNumChannels; ++i)
+    {
+        m_pChannelGain[i] = 1.0f;
+    }
+    if (m_pDelay)
+    {
+        memset(m_pDelay, 0, sizeof(AkReal32) * m_uDelayStride * AkMax(m_uNumChannels, (AkUInt32)1));
+    }
+    m_uDelayPos = 0;
+    m_uTailRemaining = m_uLookahead;
+    m_crossover.reset();
+    for (AkUInt32 k = 0; k < SidechainSnapshot::kNumLanes; ++k)
+    {
+        m_fLaneGain[k] = 1.0f;
+    }
     return AK_Success;
 }
 
@@ -115,255 +465,803 @@ AKRESULT SidechainCompressorFX::GetPluginInfo(AkPluginInfo& out_rPluginInfo)
 void SidechainCompressorFX::Execute(AkAudioBuffer* in_pBuffer, AkUInt32 in_ulnOffset, AkAudioBuffer* out_pBuffer)
 {
    
-    const AkUInt32 uNumChannels = in_pBuffer->NumChannels();
-    AkUInt32 uFramesConsumed;
-    AkUInt32 uFramesProduced;
-    AkReal32 threshold = m_pParams->RTPC.fThreshold;
-    AkReal32 Percentile = m_sharedBuffer->getPercentile(objectID);
-    AkReal32 realRatio = (Percentile * (m_pParams->RTPC.fMaxRatio - 1)) + 1;
-    AkReal32 gainDB[2] = { 0.0f, 0.0f };
-    AkReal32 knee = 1.0f;
-    AkReal32 myRMS[2] = { 0.0f, 0.0f };
-    auto& oldRMS = m_sharedBuffer->lastbuffer_mRMS;
-    auto& newRMS = m_sharedBuffer->newbuffer_mRMS;
-    AkReal32 rmsDiff[2] = { m_sharedBuffer->diff_mRMS[0], m_sharedBuffer->diff_mRMS[1] };
-
-
-    m_sharedBuffer->updatePriorityMap(objectID, priorityRank);
-
-    m_sharedBuffer->resetSharedBuffer();
-    
-    m_sharedBuffer->resizeSharedBuffer(in_pBuffer);
+    const AkUInt32 uNumChannels = AkMin(in_pBuffer->NumChannels(), m_uNumChannels);
+    AkUInt32 uFramesConsumed = 0;
+    AkUInt32 uFramesProduced = 0;
 
-    m_sharedBuffer->AddToSharedBuffer(in_pBuffer);
+    applyParamChanges();
 
-    m_sharedBuffer->numBuffersCalculated.fetch_add(1, std::memory_order_relaxed);
+    // Previous frame's detector and ranks of every group this instance listens to
+    SidechainSnapshot snapshot;
+    AkReal32 Percentile = 0.0f;
+    AkUInt32 uNumRanked = 0;
+    readSnapshot(snapshot, Percentile, uNumRanked);
+
+    // A moved curve is ramped to, so RTPC sweeps and rank changes glide instead of stepping
+    const bool bRampCurve = updateCurve(Percentile);
+    const AkUInt32 uFrames = AkMin(AkMin((AkUInt32)in_pBuffer->uValidFrames, (AkUInt32)(out_pBuffer->MaxFrames() - out_pBuffer->uValidFrames)), m_uMaxFrames);
+    uFramesConsumed = uFramesProduced = uFrames;
+
+    // Where this call's frames sit in the audio frame: the output fills from the start of the
+    // frame, whatever the input's offset, and may take several calls
+    const AkUInt32 uPosition = AkMin((AkUInt32)out_pBuffer->uValidFrames, m_uMaxFrames);
+
+    // The frames consumed into every group it feeds, at their place in the frame
+    for (AkUInt32 g = 0; g < m_uNumGroups; ++g)
+    {
+        const GroupLink& link = m_groups[g];
+        if (link.feeds)
+        {
+            link.bus->AddToSharedBuffer(link.slot, link.bus->getWriteEpoch(), in_pBuffer, in_ulnOffset, uFrames, uPosition);
+        }
+    }
+
+    // 1 = gain for every frame; otherwise every N frames, linearly interpolated in between.
+    // Linked channels share one lane, so the detector and gain are computed once for all of them.
+    const AkUInt32 uControlRate = m_uFollowerStep;
+    computeGains(snapshot, uPosition, uFrames, uControlRate, bRampCurve);
+
+#ifndef AK_OPTIMIZED
+    // Block metering, per lane, accumulated over channels
+    AkReal32 fLaneMin[SidechainSnapshot::kNumLanes], fLaneMax[SidechainSnapshot::kNumLanes], fLaneSum[SidechainSnapshot::kNumLanes];
+    for (AkUInt32 k = 0; k < m_uNumLanes; ++k)
+    {
+        // kMeterWidth partial reductions side by side, so they vectorize instead of each frame
+        // waiting on the previous one
+        const AkReal32* AK_RESTRICT pGain = m_pGain + (size_t)k * m_uGainStride;
+        const AkReal32 fFirst = uFrames > 0 ? pGain[0] : 1.0f;
+        AkReal32 fMin[kMeterWidth], fMax[kMeterWidth], fSum[kMeterWidth];
+        for (AkUInt32 j = 0; j < kMeterWidth; ++j)
+        {
+            fMin[j] = fMax[j] = fFirst;
+            fSum[j] = 0.0f;
+        }
+        AkUInt32 frame = 0;
+        for (; frame + kMeterWidth <= uFrames; frame += kMeterWidth)
+        {
+            for (AkUInt32 j = 0; j < kMeterWidth; ++j)
+            {
+                const AkReal32 fGain = pGain[frame + j];
+                fMin[j] = fGain < fMin[j] ? fGain : fMin[j];
+                fMax[j] = fGain > fMax[j] ? fGain : fMax[j];
+                fSum[j] += fGain;
+            }
+        }
+        for (; frame < uFrames; ++frame)
+        {
+            fMin[0] = AkMin(fMin[0], pGain[frame]);
+            fMax[0] = AkMax(fMax[0], pGain[frame]);
+            fSum[0] += pGain[frame];
+        }
+        fLaneMin[k] = fMin[0];
+        fLaneMax[k] = fMax[0];
+        fLaneSum[k] = fSum[0];
+        for (AkUInt32 j = 1; j < kMeterWidth; ++j)
+        {
+            fLaneMin[k] = AkMin(fLaneMin[k], fMin[j]);
+            fLaneMax[k] = AkMax(fLaneMax[k], fMax[j]);
+            fLaneSum[k] += fSum[j];
+        }
+    }
+    AkReal32 fMeterMin = 1.0f, fMeterMax = 0.0f, fMeterSum = 0.0f, fMeterDetector = 0.0f;
+#endif
 
     for (AkUInt32 i = 0; i < uNumChannels; ++i)
     {
         AkReal32* AK_RESTRICT pInBuf = (AkReal32* AK_RESTRICT)in_pBuffer->GetChannel(i) + in_ulnOffset;
         AkReal32* AK_RESTRICT pOutBuf = (AkReal32* AK_RESTRICT)out_pBuffer->GetChannel(i) +  out_pBuffer->uValidFrames;
-        
-        uFramesConsumed = 0;
-        uFramesProduced = 0;
-        auto& frame = uFramesConsumed;
-        const auto& maxFrames = in_pBuffer->uValidFrames;
-        while (uFramesConsumed < in_pBuffer->uValidFrames
-            && uFramesProduced < out_pBuffer->MaxFrames())
-        {
-            // current RMS is somewhere between oldRMS and newRMS, based on the % of progress through the total amount of frames in the buffer
-            myRMS[i] = oldRMS[i] + ((frame / maxFrames) * (newRMS[i] - oldRMS[i]));
-
-            
-            AkReal32 mySlope = newRMS[i] - oldRMS[i];
-                
-            // if difference is negligible, rmsDiff can match it
-            if (abs(mySlope - rmsDiff[i]) < 0.0001){
-                rmsDiff[i] = mySlope;}
-            else{
-                //shift rmsSlope toward the next RMS, at 50% strength
-                rmsDiff[i] += (mySlope - rmsDiff[i]) * (0.5);}
-
-            //update current RMS to follow rmsDiff
-            myRMS[i] += (rmsDiff[i]/maxFrames);
-
-
-            AkReal32 x = AK_LINTODB(myRMS[i]);
-            AkReal32 y = x;
-
-            // TODO: dsp in DB
-            if (x > threshold + (knee / 2))
+        const AkUInt32 k = m_pChannelLane[i];
+        const AkReal32* AK_RESTRICT pGain = m_pGain + (size_t)k * m_uGainStride;
+
+#ifndef AK_OPTIMIZED
+        // A split channel meters the gain and sidechain of every band
+        for (AkUInt32 band = 0; band < m_uNumBands; ++band)
+        {
+            const AkUInt32 kb = band * m_uLanesPerBand + k;
+            fMeterMin = AkMin(fMeterMin, fLaneMin[kb]);
+            fMeterMax = AkMax(fMeterMax, fLaneMax[kb]);
+            fMeterSum += fLaneSum[kb];
+            fMeterDetector = AkMax(fMeterDetector, snapshot.newbuffer_mRMS[m_uLanes[kb]]);
+        }
+#endif
+
+        // Bands are summed back once every channel's gains are known, see applyBands
+        if (m_uNumBands > 1)
+        {
+            if (uFrames > 0)
             {
-                y = ((x - threshold) / realRatio) + threshold;
+                AkReal32 fGain = pGain[uFrames - 1];
+                for (AkUInt32 band = 1; band < m_uNumBands; ++band)
+                {
+                    fGain = AkMin(fGain, m_pGain[(size_t)(band * m_uLanesPerBand + k) * m_uGainStride + uFrames - 1]);
+                }
+                m_pChannelGain[i] = fGain;
             }
-            else if (x > threshold - (knee / 2))
+            continue;
+        }
+
+        if (m_uLookahead == 0)
+        {
+            for (AkUInt32 frame = 0; frame < uFrames; ++frame)
             {
-                AkReal32 m = ((1 / realRatio) - 1) / (2 * knee);
-                y = x + (m * powf(x - (threshold - (knee / 2)), 2));
+                pOutBuf[frame] = pInBuf[frame] * pGain[frame];
             }
-            
-            gainDB[i] = y - x;
-
-            pOutBuf[frame] = pInBuf[frame] * AK_DBTOLIN(gainDB[i]);
-
-            // make output same as input, effectively y = x
-            //*pOutBuf++ = *pInBuf++;
+        }
+        else
+        {
+            applyDelayed(i, pInBuf, pOutBuf, pGain, uFrames);
+        }
 
-            std::ostringstream reformat1, reformat2;
-            if (i == 0){
-                reformat1 << std::fixed << std::setprecision(2) << gainDB[i];
-                errorMsg1 = reformat1.str();}
-            else if (i == 1){
-                reformat2 << std::fixed << std::setprecision(2) << gainDB[i];
-                errorMsg2 = reformat2.str();}
+        if (uFrames > 0)
+        {
+            m_pChannelGain[i] = pGain[uFrames - 1];
+        }
+    }
+    if (m_uNumBands > 1)
+    {
+        applyBands(in_pBuffer, in_ulnOffset, out_pBuffer, out_pBuffer->uValidFrames, uNumChannels, uFrames);
+        if (uFrames > 0)
+        {
+            for (AkUInt32 k = 0; k < m_uNumLanes; ++k)
+            {
+                m_fLaneGain[k] = m_pGain[(size_t)k * m_uGainStride + uFrames - 1];
+            }
+        }
+    }
+    advanceDelay(uFrames);
+    m_bDelayCleared = false;
 
- 
-            ++uFramesConsumed;
-            ++uFramesProduced;
+    // Once the input has ended, flush the lookahead at the last gain of each channel
+    if (m_uLookahead > 0)
+    {
+        if (uFrames > 0)
+        {
+            m_uTailRemaining = m_uLookahead;
+        }
+        if (in_pBuffer->eState == AK_NoMoreData && in_pBuffer->uValidFrames == uFramesConsumed && m_uTailRemaining > 0)
+        {
+            const AkUInt32 uTailFrames = AkMin(m_uTailRemaining, AkMin((AkUInt32)(out_pBuffer->MaxFrames() - out_pBuffer->uValidFrames) - uFrames, m_uMaxFrames));
+            memset(m_pDetector, 0, sizeof(AkReal32) * uTailFrames);
+            if (m_uNumBands > 1)
+            {
+                for (AkUInt32 k = 0; k < m_uNumLanes; ++k)
+                {
+                    AkReal32* AK_RESTRICT pGain = m_pGain + (size_t)k * m_uGainStride;
+                    for (AkUInt32 frame = 0; frame < uTailFrames; ++frame)
+                    {
+                        pGain[frame] = m_fLaneGain[k];
+                    }
+                }
+                applyBands(nullptr, 0, out_pBuffer, out_pBuffer->uValidFrames + uFrames, uNumChannels, uTailFrames);
+            }
+            for (AkUInt32 i = 0; i < uNumChannels && m_uNumBands == 1; ++i)
+            {
+                AkReal32* AK_RESTRICT pOutBuf = (AkReal32* AK_RESTRICT)out_pBuffer->GetChannel(i) + out_pBuffer->uValidFrames + uFrames;
+                for (AkUInt32 frame = 0; frame < uTailFrames; ++frame)
+                {
+                    m_pGain[frame] = m_pChannelGain[i];
+                }
+                applyDelayed(i, m_pDetector, pOutBuf, m_pGain, uTailFrames);
+            }
+            advanceDelay(uTailFrames);
+            m_uTailRemaining -= uTailFrames;
+            uFramesProduced += uTailFrames;
         }
     }
 
 
+#ifndef AK_OPTIMIZED
+    SidechainMeterBlock meter;
+    meter.uBlock = m_uMeterBlock++;
+    meter.uFrames = uFrames;
+    meter.fMinGain = uNumChannels > 0 ? fMeterMin : 1.0f;
+    meter.fMaxGain = uNumChannels > 0 ? fMeterMax : 1.0f;
+    meter.fMeanGain = uNumChannels > 0 && uFrames > 0 ? fMeterSum / (AkReal32)(uFrames * uNumChannels * m_uNumBands) : 1.0f;
+    meter.fDetector = fMeterDetector;
+    m_meters.push(meter);
+#endif
+
     in_pBuffer->uValidFrames -= uFramesConsumed;
     out_pBuffer->uValidFrames += uFramesProduced;
 
-    if (in_pBuffer->eState == AK_NoMoreData && in_pBuffer->uValidFrames == 0)
+    if (in_pBuffer->eState == AK_NoMoreData && in_pBuffer->uValidFrames == 0 && m_uTailRemaining == 0)
         out_pBuffer->eState = AK_NoMoreData;
     else if (out_pBuffer->uValidFrames == out_pBuffer->MaxFrames())
         out_pBuffer->eState = AK_DataReady;
     else
         out_pBuffer->eState = AK_DataNeeded;
 
-    // do RMS table
-    if (m_sharedBuffer->numBuffersCalculated >= m_sharedBuffer->PriorityMap.size())
+    // Post Monitor Data
+    monitorData(snapshot, Percentile, m_fRatio, uNumRanked, uFrames);
+}
+
+void SidechainCompressorFX::applyParamChanges()
+{
+    // Only touch the buses when the rank actually moved
+    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_PRIORITYRANK_ID))
     {
-        m_sharedBuffer->diff_mRMS[0] = rmsDiff[0];
-        m_sharedBuffer->diff_mRMS[1] = rmsDiff[1];
-        m_sharedBuffer->calculatedmRMS(SampleRate / 100);
+        priorityRank = m_pParams->RTPC.fPriorityRank;
+        for (AkUInt32 g = 0; g < m_uNumGroups; ++g)
+        {
+            if (m_groups[g].listens)
+                m_groups[g].bus->setRank(m_groups[g].slot, priorityRank);
+        }
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_PRIORITYRANK_ID);
+    }
+    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_RMSWINDOW_ID) || m_pParams->m_paramChangeHandler.HasChanged(PARAM_DETECTORMODE_ID))
+    {
+        for (AkUInt32 g = 0; g < m_uNumGroups; ++g)
+        {
+            if (m_groups[g].listens)
+                m_groups[g].bus->setDetector(m_pParams->NonRTPC.fRMSWindow, (SidechainDetector::Mode)m_pParams->NonRTPC.iDetectorMode);
+        }
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_RMSWINDOW_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_DETECTORMODE_ID);
+    }
+    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_KEYFILTER_ID) || m_pParams->m_paramChangeHandler.HasChanged(PARAM_KEYFREQUENCY_ID)
+        || m_pParams->m_paramChangeHandler.HasChanged(PARAM_KEYQ_ID) || m_pParams->m_paramChangeHandler.HasChanged(PARAM_KEYGAIN_ID))
+    {
+        const SidechainKeyFilter::Settings key = getKeyFilter();
+        for (AkUInt32 g = 0; g < m_uNumGroups; ++g)
+        {
+            if (m_groups[g].listens)
+                m_groups[g].bus->setKeyFilter(key);
+        }
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_KEYFILTER_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_KEYFREQUENCY_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_KEYQ_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_KEYGAIN_ID);
+    }
+    if (m_uNumBands > 1 && (m_pParams->m_paramChangeHandler.HasChanged(PARAM_CROSSOVER1_ID) || m_pParams->m_paramChangeHandler.HasChanged(PARAM_CROSSOVER2_ID)
+        || m_pParams->m_paramChangeHandler.HasChanged(PARAM_CROSSOVER3_ID)))
+    {
+        AkReal32 crossovers[SidechainCrossover::kMaxBands - 1];
+        getCrossovers(crossovers);
+        m_crossover.setBands(m_uNumBands, m_uNumChannels, crossovers, SampleRate);
+        for (AkUInt32 g = 0; g < m_uNumGroups; ++g)
+        {
+            if (m_groups[g].listens)
+                m_groups[g].bus->setBands(m_uNumBands, crossovers);
+        }
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_CROSSOVER1_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_CROSSOVER2_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_CROSSOVER3_ID);
+    }
+    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_CHANNELLINK_ID))
+    {
+        updateChannelLanes();
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_CHANNELLINK_ID);
     }
 
-    // Post Monitor Data
-    monitorData();
+    // Follower coefficients only change with their parameters
+    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_ATTACK_ID) || m_pParams->m_paramChangeHandler.HasChanged(PARAM_RELEASE_ID)
+        || m_pParams->m_paramChangeHandler.HasChanged(PARAM_CONTROLRATE_ID))
+    {
+        updateFollower();
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_ATTACK_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_RELEASE_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_CONTROLRATE_ID);
+    }
+
+    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_THRESHOLD_ID) || m_pParams->m_paramChangeHandler.HasChanged(PARAM_MAXRATIO_ID))
+    {
+        m_bCurveStale = true;
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_THRESHOLD_ID);
+        m_pParams->m_paramChangeHandler.ResetParamChange(PARAM_MAXRATIO_ID);
+    }
 }
 
-AKRESULT SidechainCompressorFX::TimeSkip(AkUInt32 &io_uFrames)
+bool SidechainCompressorFX::updateCurve(AkReal32 in_fPercentile)
 {
-    return AK_DataReady;
-}
+    if (!m_bCurveStale && in_fPercentile == m_fCurvePercentile)
+    {
+        return false;
+    }
 
+    m_fCurvePercentile = in_fPercentile;
+    m_fRatio = (in_fPercentile * (m_pParams->RTPC.fMaxRatio - 1)) + 1;
+    m_previousCurve = m_curve;
+    m_curve = SidechainGainCurve::make(m_pParams->RTPC.fThreshold, m_fRatio, kKneeDb);
+    m_bCurveStale = false;
 
-void SidechainCompressorFX::resetCalcs()
-{
+    // The table a ramp starts from stays as it is; the other one takes the new curve
+    if (m_lookupGain)
+    {
+        m_uTable ^= 1;
+        m_tables[m_uTable].build(m_curve, m_computeGain);
+    }
+
+    // The first curve has nothing to ramp from
+    const bool bRamp = m_bCurveSet;
+    m_bCurveSet = true;
+    return bRamp;
 }
 
-void SidechainCompressorFX::doCalcs()
+void SidechainCompressorFX::curveGains(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 uCount, bool bPrevious) const
 {
-    
+    if (m_lookupGain)
+    {
+        m_lookupGain(in_pLevel, out_pGain, uCount, m_tables[bPrevious ? m_uTable ^ 1 : m_uTable]);
+    }
+    else
+    {
+        m_computeGain(in_pLevel, out_pGain, uCount, bPrevious ? m_previousCurve : m_curve);
+    }
 }
 
-void SidechainCompressorFX::doDSP()
+void SidechainCompressorFX::applyCurve(AkReal32* io_pLevel, AkUInt32 uCount, bool bRamp, AkUInt32 uGroup, AkReal32 t0, AkReal32 dt)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    /*
-    const AkUInt32 uNumChannels = sourceBuffer->NumChannels();
-    AkUInt16 uFramesProcessed;
-    AkReal32 threshold = m_pParams->RTPC.fThreshold;
-    AkReal32 Percentile = m_sharedBuffer->getPercentile(objectID);
-    AkReal32 realRatio = 0.0f;
-    AkReal32 gainDB = 0.0f;
-
-    for (AkUInt32 i = 0; i < uNumChannels; ++i)
+    if (!bRamp)
     {
-        AkReal32* pBuf = (AkReal32 * )sourceBuffer->GetChannel(i);
-        auto& channelRMSTable = m_sharedBuffer->RMSTable[i];
+        curveGains(io_pLevel, io_pLevel, uCount, false);
+        return;
+    }
 
-        uFramesProcessed = 0;
-        while (uFramesProcessed < sourceBuffer->uValidFrames)
+    // Both curves over a stack chunk of whole groups at a time, then a multiply-add per gain
+    const AkUInt32 kChunk = 240;
+    const AkUInt32 uChunk = kChunk / uGroup * uGroup;
+    AkReal32 from[kChunk];
+    AkUInt32 step = 0;
+    for (AkUInt32 start = 0; start < uCount; start += uChunk)
+    {
+        const AkUInt32 uLength = AkMin(uChunk, uCount - start);
+        AkReal32* AK_RESTRICT pGain = io_pLevel + start;
+        curveGains(pGain, from, uLength, true);
+        curveGains(pGain, pGain, uLength, false);
+        for (AkUInt32 i = 0; i < uLength; i += uGroup, ++step)
         {
-
-            // Get sharedMovingRMS from RMSTable
-            AkReal32 sharedMovingRMS = m_sharedBuffer->lastbuffer_mRMS[i];
-            if (!m_sharedBuffer->RMSTable.empty())
+            const AkReal32 t = AkMin(t0 + (AkReal32)step * dt, 1.0f);
+            const AkUInt32 uEnd = AkMin(i + uGroup, uLength);
+            for (AkUInt32 j = i; j < uEnd; ++j)
             {
-                sharedMovingRMS = channelRMSTable[uFramesProcessed];
+                pGain[j] = from[j] + t * (pGain[j] - from[j]);
             }
-            AkReal32 excessDB = AK_LINTODB(sharedMovingRMS) - threshold;
-
-            // Calculate real Ratio
+        }
+    }
+}
 
-            realRatio = ((1 - Percentile) * (m_pParams->RTPC.fMaxRatio - 1)) + 1;
+void SidechainCompressorFX::readSnapshot(SidechainSnapshot& out_snapshot, AkReal32& out_percentile, AkUInt32& out_uNumRanked) const
+{
+    // Previous frame's detector and ranks of every group this instance listens to; immutable,
+    // so no lock is needed to read them. Each lane follows the loudest group, and the ratio
+    // is the strongest any of the groups gives this rank.
+    out_percentile = 0.0f;
+    out_uNumRanked = 0;
+    bool bListening = false;
+    for (AkUInt32 g = 0; g < m_uNumGroups; ++g)
+    {
+        const GroupLink& link = m_groups[g];
+        if (!link.listens)
+        {
+            continue;
+        }
 
-            // Do compression DSP
+        const SidechainSnapshot groupSnapshot = link.bus->getSnapshot();
+        out_percentile = AkMax(out_percentile, groupSnapshot.getPercentile(priorityRank));
+        out_uNumRanked += groupSnapshot.ranks.numRanked;
+        if (bListening)
+        {
+            out_snapshot.mergeLoudest(groupSnapshot);
+        }
+        else
+        {
+            out_snapshot = groupSnapshot;
+            bListening = true;
+        }
+    }
+}
 
-            if (AK_LINTODB(sharedMovingRMS) > threshold)
+void SidechainCompressorFX::applyDelayed(AkUInt32 channel, const AkReal32* in_pIn, AkReal32* out_pOut, const AkReal32* in_pGain, AkUInt32 uFrames)
+{
+    // Each input sample is written once into the ring and read back m_uLookahead frames
+    // later. The ring is walked in contiguous runs, so there is no modulo per sample.
+    AkReal32* AK_RESTRICT pRing = m_pDelay + (size_t)channel * m_uDelayStride;
+    const AkReal32* AK_RESTRICT pIn = in_pIn;
+    AkReal32* AK_RESTRICT pOut = out_pOut;
+    const AkReal32* AK_RESTRICT pGain = in_pGain;
+
+    AkUInt32 pos = m_uDelayPos;
+    AkUInt32 done = 0;
+    while (done < uFrames)
+    {
+        const AkUInt32 run = AkMin(uFrames - done, m_uLookahead - pos);
+        if (pGain)
+        {
+            for (AkUInt32 frame = 0; frame < run; ++frame)
+            {
+                pOut[done + frame] = pRing[pos + frame] * pGain[done + frame];
+                pRing[pos + frame] = pIn[done + frame];
+            }
+        }
+        else
+        {
+            for (AkUInt32 frame = 0; frame < run; ++frame)
             {
-                
+                pOut[done + frame] = pRing[pos + frame];
+                pRing[pos + frame] = pIn[done + frame];
+            }
+        }
+        done += run;
+        pos = pos + run == m_uLookahead ? 0 : pos + run;
+    }
+}
 
-                AkReal32 y = (1 / realRatio) * excessDB;  // the new dB above the threshold, a positive float. excessDB is the x variable in the graph
+void SidechainCompressorFX::applyBands(AkAudioBuffer* in_pBuffer, AkUInt32 in_uOffset, AkAudioBuffer* out_pBuffer, AkUInt32 out_uOffset, AkUInt32 uNumChannels, AkUInt32 uFrames)
+{
+    // What is heard is split: with a lookahead, the delayed input, staged in the output
+    const AkUInt32 uChannels = m_uNumChannels;
+    for (AkUInt32 i = 0; i < uNumChannels && m_uLookahead > 0; ++i)
+    {
+        const AkReal32* pIn = in_pBuffer ? in_pBuffer->GetChannel(i) + in_uOffset : m_pDetector;
+        applyDelayed(i, pIn, out_pBuffer->GetChannel(i) + out_uOffset, nullptr, uFrames);
+    }
 
-                // db to be compressed, a negative float
-                gainDB = y - excessDB;
+    AkReal32* AK_RESTRICT pFrames = m_pBandBlock;
+    AkReal32* AK_RESTRICT pLanes = m_pBandBlock + (size_t)kBandChunk * SidechainCompressorSharedBuffer::alignFrames(uChannels);
+    const AkUInt32 uLanes = m_crossover.getNumLanes();
+    for (AkUInt32 start = 0; start < uFrames; start += kBandChunk)
+    {
+        const AkUInt32 uLength = AkMin(kBandChunk, uFrames - start);
 
-                // apply gain
-                pBuf[uFramesProcessed] = pBuf[uFramesProcessed] * AK_DBTOLIN(gainDB);
-                
-                pBuf[uFramesProcessed] *= 0.5f;
+        // Frame-major for the crossover; channels the buffer does not have are silent
+        for (AkUInt32 i = 0; i < uChannels; ++i)
+        {
+            const AkReal32* AK_RESTRICT pIn = nullptr;
+            if (i < uNumChannels)
+            {
+                pIn = m_uLookahead > 0 ? out_pBuffer->GetChannel(i) + out_uOffset + start
+                    : in_pBuffer ? in_pBuffer->GetChannel(i) + in_uOffset + start : m_pDetector;
+            }
+            for (AkUInt32 frame = 0; frame < uLength; ++frame)
+            {
+                pFrames[(size_t)frame * uChannels + i] = pIn ? pIn[frame] : 0.0f;
             }
-            
-            ++uFramesProcessed;
         }
+        m_crossover.process(pFrames, uChannels, pLanes, uLength);
 
+        // Each band at its own gain, summed back in one pass over the channel
+        for (AkUInt32 i = 0; i < uNumChannels; ++i)
+        {
+            AkReal32* AK_RESTRICT pOut = out_pBuffer->GetChannel(i) + out_uOffset + start;
+            const AkReal32* AK_RESTRICT pGain[SidechainCrossover::kMaxBands];
+            for (AkUInt32 band = 0; band < m_uNumBands; ++band)
+            {
+                pGain[band] = m_pGain + (size_t)(band * m_uLanesPerBand + m_pChannelLane[i]) * m_uGainStride + start;
+            }
+            for (AkUInt32 frame = 0; frame < uLength; ++frame)
+            {
+                const AkReal32* AK_RESTRICT pBands = pLanes + (size_t)frame * uLanes + i;
+                AkReal32 fSum = pBands[0] * pGain[0][frame];
+                for (AkUInt32 band = 1; band < m_uNumBands; ++band)
+                {
+                    fSum += pBands[band * uChannels] * pGain[band][frame];
+                }
+                pOut[frame] = fSum;
+            }
+        }
     }
-    */
-    
 }
 
-void SidechainCompressorFX::monitorData()
+void SidechainCompressorFX::getCrossovers(AkReal32* out_pFrequencies) const
 {
-#ifndef AK_OPTIMIZED
+    out_pFrequencies[0] = m_pParams->NonRTPC.fCrossover1;
+    out_pFrequencies[1] = m_pParams->NonRTPC.fCrossover2;
+    out_pFrequencies[2] = m_pParams->NonRTPC.fCrossover3;
+}
 
-    
-    if (m_pContext->CanPostMonitorData())
+SidechainKeyFilter::Settings SidechainCompressorFX::getKeyFilter() const
+{
+    SidechainKeyFilter::Settings key;
+    key.type = m_pParams->NonRTPC.iKeyFilter >= SidechainKeyFilter::Type_HighPass && m_pParams->NonRTPC.iKeyFilter <= SidechainKeyFilter::Type_HighShelf
+        ? (SidechainKeyFilter::Type)m_pParams->NonRTPC.iKeyFilter : SidechainKeyFilter::Type_Off;
+    key.frequency = m_pParams->NonRTPC.fKeyFrequency;
+    key.q = m_pParams->NonRTPC.fKeyQ;
+    key.gainDb = m_pParams->NonRTPC.fKeyGain;
+    return key;
+}
+
+void SidechainCompressorFX::advanceDelay(AkUInt32 uFrames)
+{
+    if (m_uLookahead > 0)
     {
+        m_uDelayPos = (AkUInt32)((m_uDelayPos + (AkUInt64)uFrames) % m_uLookahead);
+    }
+}
 
-        // Monitor Data 1
-        std::ostringstream reformat1, reformat2, reformat3, reformat4;
-        reformat1 << std::fixed << std::setprecision(2) << AK_LINTODB(m_sharedBuffer->lastbuffer_mRMS[0]);
-        reformat2 << std::fixed << std::setprecision(2) << AK_LINTODB(m_sharedBuffer->lastbuffer_mRMS[1]);
-        std::stringstream sstream1, sstream2;
-        sstream1 << reformat1.str() << ", " << reformat2.str();
+void SidechainCompressorFX::computeGains(const SidechainSnapshot& snapshot, AkUInt32 uPosition, AkUInt32 uFrames, AkUInt32 uControlRate, bool bRampCurve)
+{
+    if (uFrames == 0)
+    {
+        return;
+    }
 
-        std::string monitorData1 = sstream1.str();
+    // Follower state and the block's detector ramp (previous level to current) per lane,
+    // packed and padded to whole groups of kFollowerWidth so the inner loop is a fixed-width
+    // vector across lanes. Padding lanes follow silence.
+    const AkUInt32 uLanes = m_uNumLanes;
+    const AkUInt32 uPadded = (uLanes + kFollowerWidth - 1) / kFollowerWidth * kFollowerWidth;
+    AkReal32 env[kMaxPaddedLanes] = {};
+    AkReal32 from[kMaxPaddedLanes] = {};
+    AkReal32 slope[kMaxPaddedLanes] = {};
+    for (AkUInt32 k = 0; k < uLanes; ++k)
+    {
+        const AkUInt32 lane = m_uLanes[k];
+        env[k] = m_fEnvelope[lane];
+        from[k] = snapshot.lastbuffer_mRMS[lane];
+        slope[k] = snapshot.newbuffer_mRMS[lane] - from[k];
+    }
 
-        // Monitor Data 2 
-        AkUInt32 data1 = 0;
-        AkUInt32 data2 = 0;
-        if (!m_sharedBuffer->sharedBuffer.empty())
-        {
-            reformat3 << std::fixed << std::setprecision(3) << m_sharedBuffer->diff_mRMS[0] * 100;
-            reformat4 << std::fixed << std::setprecision(3) << m_sharedBuffer->diff_mRMS[1] * 100;
-        }
-        sstream2 << errorMsg1 << ", " << errorMsg2;
-        
-        std::string monitorData2 = sstream2.str();
-        
-        // Serialize
-        std::string monitorData[2] = { monitorData1, monitorData2 };
+    // The detector ramps across the whole audio frame, so a call covering part of it reads
+    // its part of the ramp
+    const AkReal32 invLength = 1.0f / (AkReal32)AkMax(m_uMaxFrames, uPosition + uFrames);
+
+    // Every frame, straight into the gain rows, or a frame-major detector every uControlRate
+    // frames and the end of the block, where point 0 is the envelope carried over from the
+    // previous block
+    AkReal32* AK_RESTRICT pDetector = m_pDetector;
+    const bool bFullRate = uControlRate == 1;
+    const AkUInt32 uPoints = bFullRate ? uFrames : (uFrames + uControlRate - 1) / uControlRate + 1;
+    const AkUInt32 uFirst = bFullRate ? 0 : 1;
+
+    // Coefficients of the steps up to the last, and of the last one, which may be short
+    const AkUInt32 uLastSteps = bFullRate ? 1 : uFrames - (uPoints - 2) * uControlRate;
+    const AkReal32 attack = bFullRate ? m_fAttackCoef : m_fAttackCoefStep;
+    const AkReal32 release = bFullRate ? m_fReleaseCoef : m_fReleaseCoefStep;
+    const AkReal32 lastAttack = uLastSteps == uControlRate ? attack : 1.0f - powf(1.0f - m_fAttackCoef, (AkReal32)uLastSteps);
+    const AkReal32 lastRelease = uLastSteps == uControlRate ? release : 1.0f - powf(1.0f - m_fReleaseCoef, (AkReal32)uLastSteps);
+    const AkReal32 attackLag = bFullRate ? 0.0f : m_fAttackLagStep;
+    const AkReal32 releaseLag = bFullRate ? 0.0f : m_fReleaseLagStep;
+    const AkReal32 lastAttackLag = uLastSteps == uControlRate ? attackLag : followerLag(m_fAttackCoef, uLastSteps);
+    const AkReal32 lastReleaseLag = uLastSteps == uControlRate ? releaseLag : followerLag(m_fReleaseCoef, uLastSteps);
+
+    FollowerRamp ramp;
+    ramp.from = from;
+    ramp.slope = slope;
+    ramp.detector = pDetector;
+    ramp.stride = uPadded;
+    ramp.gain = bFullRate ? m_pGain : nullptr;
+    ramp.gainStride = m_uGainStride;
+    ramp.lanes = uLanes;
+    ramp.first = uFirst;
+    ramp.points = uPoints;
+    ramp.controlRate = uControlRate;
+    ramp.frames = uFrames;
+    ramp.position = uPosition;
+    ramp.fullRate = bFullRate;
+    ramp.invLength = invLength;
+    ramp.attack = attack;
+    ramp.release = release;
+    ramp.lastAttack = lastAttack;
+    ramp.lastRelease = lastRelease;
+    ramp.attackLag = attackLag;
+    ramp.releaseLag = releaseLag;
+    ramp.lastAttackLag = lastAttackLag;
+    ramp.lastReleaseLag = lastReleaseLag;
+
+    // Two groups per pass while there are, so their chains overlap
+    AkUInt32 group = 0;
+    for (; group + 2 * kFollowerWidth <= uPadded; group += 2 * kFollowerWidth)
+    {
+        followGroup<2 * kFollowerWidth>(ramp, group, env);
+    }
+    if (group < uPadded)
+    {
+        followGroup<kFollowerWidth>(ramp, group, env);
+    }
 
-        m_pContext->PostMonitorData((void*)monitorData, sizeof(monitorData));
+    for (AkUInt32 k = 0; k < uLanes; ++k)
+    {
+        m_fEnvelope[m_uLanes[k]] = env[k];
+    }
 
+    // A curve ramp reaches m_curve on the block's last frame
+    const AkReal32 invFrames = 1.0f / (AkReal32)uFrames;
+    if (bFullRate)
+    {
+        // Already lane-major: the dB conversion, knee/ratio curve and gain of each lane in place
+        for (AkUInt32 k = 0; k < uLanes; ++k)
+        {
+            applyCurve(m_pGain + (size_t)k * m_uGainStride, uFrames, bRampCurve, 1, invFrames, invFrames);
+        }
+        return;
     }
-    
 
-#endif // !AK_OPTIMIZED
+    // Few points: the curve runs over all of them at once, then each lane is interpolated.
+    // Point 0 is where the previous block ended, on the previous curve.
+    applyCurve(pDetector, uPoints * uPadded, bRampCurve, uPadded, 0.0f, (AkReal32)uControlRate * invFrames);
+    const AkReal32 invStep = 1.0f / (AkReal32)uControlRate;
+    const AkReal32 invLastStep = 1.0f / (AkReal32)uLastSteps;
+    for (AkUInt32 k = 0; k < uLanes; ++k)
+    {
+        AkReal32* AK_RESTRICT pGain = m_pGain + (size_t)k * m_uGainStride;
+        for (AkUInt32 p = 0; p + 1 < uPoints; ++p)
+        {
+            const AkUInt32 start = p * uControlRate;
+            const AkUInt32 end = AkMin(start + uControlRate, uFrames);
+            const AkReal32 g0 = pDetector[(size_t)p * uPadded + k];
+            const AkReal32 step = (pDetector[(size_t)(p + 1) * uPadded + k] - g0) * (p + 2 == uPoints ? invLastStep : invStep);
+            for (AkUInt32 frame = start; frame < end; ++frame)
+            {
+                pGain[frame] = g0 + step * (AkReal32)(frame - start);
+            }
+        }
+    }
+}
 
-    
+void SidechainCompressorFX::updateChannelLanes()
+{
+    // Distinct lanes in channel order; each channel keeps the index of its lane
+    const SidechainChannelLink link = (SidechainChannelLink)m_pParams->NonRTPC.iChannelLink;
+    m_uNumLanes = 0;
+    for (AkUInt32 i = 0; i < m_uNumChannels; ++i)
+    {
+        const AkUInt32 lane = SidechainSnapshot::getLane(i, link);
+        AkUInt32 index = 0;
+        while (index < m_uNumLanes && m_uLanes[index] != lane)
+        {
+            ++index;
+        }
+        if (index == m_uNumLanes)
+        {
+            m_uLanes[m_uNumLanes++] = lane;
+        }
+        m_pChannelLane[i] = index;
+    }
 
+    // Split: the same lanes again for every band, band-major
+    m_uLanesPerBand = m_uNumLanes;
+    if (m_uNumBands > 1)
+    {
+        for (AkUInt32 band = m_uNumBands; band-- > 0;)
+        {
+            for (AkUInt32 k = 0; k < m_uLanesPerBand; ++k)
+            {
+                m_uLanes[band * m_uLanesPerBand + k] = SidechainSnapshot::getBandLane(band, m_uLanes[k]);
+            }
+        }
+        m_uNumLanes = m_uLanesPerBand * m_uNumBands;
+    }
 }
 
-void AKSOUNDENGINE_CALL SidechainCompressorFX::BeginRenderCallback(AK::IAkGlobalPluginContext* in_pContext, AkGlobalCallbackLocation in_eLocation, void* in_pCookie)
+void SidechainCompressorFX::updateFollower()
 {
-    SidechainCompressorFX* me = (SidechainCompressorFX*)in_pCookie;
+    // Per-frame one-pole coefficients, 1 - exp(-1 / (time * rate)), and the same over one
+    // control-rate step. Zero time is instantaneous.
+    auto coefficient = [this](AkReal32 timeMs)
+    {
+        const AkReal32 frames = AkMax(timeMs, 0.0f) * 0.001f * (AkReal32)SampleRate;
+        return frames > 0.0f ? 1.0f - expf(-1.0f / frames) : 1.0f;
+    };
+    m_fAttackCoef = coefficient(m_pParams->RTPC.fAttack);
+    m_fReleaseCoef = coefficient(m_pParams->RTPC.fRelease);
+
+    const AkInt32 iControlRate = m_pParams->NonRTPC.iControlRate;
+    m_uFollowerStep = iControlRate > 1 ? AkMin((AkUInt32)iControlRate, (AkUInt32)64) : 1;
+    m_fAttackCoefStep = 1.0f - powf(1.0f - m_fAttackCoef, (AkReal32)m_uFollowerStep);
+    m_fReleaseCoefStep = 1.0f - powf(1.0f - m_fReleaseCoef, (AkReal32)m_uFollowerStep);
+    m_fAttackLagStep = followerLag(m_fAttackCoef, m_uFollowerStep);
+    m_fReleaseLagStep = followerLag(m_fReleaseCoef, m_uFollowerStep);
+    m_uSkipFrames = ~0u;
 }
 
-void AKSOUNDENGINE_CALL SidechainCompressorFX::EndCallback(AK::IAkGlobalPluginContext* in_pContext, AkGlobalCallbackLocation in_eLocation, void* in_pCookie)
+AKRESULT SidechainCompressorFX::TimeSkip(AkUInt32 &io_uFrames)
 {
-    
-    SidechainCompressorFX* me = (SidechainCompressorFX*)in_pCookie;
+    // A virtual voice: no audio in or out, but the instance stays registered and ranked, and
+    // its state moves on as if it had rendered io_uFrames, so it comes back where it would be.
+    const AkUInt32 uFrames = io_uFrames;
+    applyParamChanges();
+
+    SidechainSnapshot snapshot;
+    AkReal32 Percentile = 0.0f;
+    AkUInt32 uNumRanked = 0;
+    readSnapshot(snapshot, Percentile, uNumRanked);
+    updateCurve(Percentile);
+
+    // The groups it feeds keep hearing its last block, so the sidechain holds its level
+    // instead of dropping out while the voice is virtual
+    for (AkUInt32 g = 0; g < m_uNumGroups; ++g)
+    {
+        const GroupLink& link = m_groups[g];
+        if (link.feeds)
+        {
+            link.bus->repeatContribution(link.slot, link.bus->getWriteEpoch());
+        }
+    }
 
-}
+    // The follower over the whole skip in closed form. For the detector ramp x(n) = x0 + s*n
+    // a one-pole with coefficient c = 1 - q settles at a lag of s*q/c behind the ramp, and
+    // the distance to that decays by q^n:
+    //     e(N) = x(N) - s*q/c + (e(0) - x0 + s*q/c) * q^N
+    // Attack or release is chosen by the direction the envelope has to go.
+    if (uFrames != m_uSkipFrames)
+    {
+        m_uSkipFrames = uFrames;
+        m_fAttackDecaySkip = powf(1.0f - m_fAttackCoef, (AkReal32)uFrames);
+        m_fReleaseDecaySkip = powf(1.0f - m_fReleaseCoef, (AkReal32)uFrames);
+    }
+    for (AkUInt32 k = 0; k < m_uNumLanes; ++k)
+    {
+        const AkUInt32 lane = m_uLanes[k];
+        const AkReal32 x0 = snapshot.lastbuffer_mRMS[lane];
+        const AkReal32 x1 = snapshot.newbuffer_mRMS[lane];
+        const bool bAttack = x1 > m_fEnvelope[lane];
+        const AkReal32 c = bAttack ? m_fAttackCoef : m_fReleaseCoef;
+        const AkReal32 decay = bAttack ? m_fAttackDecaySkip : m_fReleaseDecaySkip;
+        const AkReal32 lag = uFrames > 0 ? (x1 - x0) / (AkReal32)uFrames * (1.0f - c) / c : 0.0f;
+        m_fEnvelope[lane] = AkMax(x1 - lag + (m_fEnvelope[lane] - x0 + lag) * decay, 0.0f);
+        m_pGain[k] = m_fEnvelope[lane];
+    }
+    curveGains(m_pGain, m_pGain, m_uNumLanes, false);
+    for (AkUInt32 k = 0; k < m_uNumLanes; ++k)
+    {
+        m_fLaneGain[k] = m_pGain[k];
+    }
+    for (AkUInt32 i = 0; i < m_uNumChannels; ++i)
+    {
+        AkReal32 fGain = m_pGain[m_pChannelLane[i]];
+        for (AkUInt32 band = 1; band < m_uNumBands; ++band)
+        {
+            fGain = AkMin(fGain, m_pGain[band * m_uLanesPerBand + m_pChannelLane[i]]);
+        }
+        m_pChannelGain[i] = fGain;
+    }
 
+    // The skipped input never went through the lookahead; resume from silence, as after Reset
+    if (m_pDelay && !m_bDelayCleared)
+    {
+        memset(m_pDelay, 0, sizeof(AkReal32) * m_uDelayStride * AkMax(m_uNumChannels, (AkUInt32)1));
+        m_uDelayPos = 0;
+        m_bDelayCleared = true;
+    }
+    m_crossover.reset();
 
-void SidechainCompressorFX::registerCallbacks()
-{
-    m_pContext->GlobalContext()->RegisterGlobalCallback(AkPluginTypeEffect, 64, 25358, BeginRenderCallback, AkGlobalCallbackLocation_BeginRender, this);
-    m_pContext->GlobalContext()->RegisterGlobalCallback(AkPluginTypeEffect, 64, 25358, EndCallback, AkGlobalCallbackLocation_End, this);
-    
+#ifndef AK_OPTIMIZED
+    // Nothing to meter, but the block count moves on so consumers see the gap
+    ++m_uMeterBlock;
+#endif
+    monitorData(snapshot, Percentile, m_fRatio, uNumRanked, uFrames);
+    return AK_DataReady;
 }
 
-void SidechainCompressorFX::unregisterCallbacks()
+void SidechainCompressorFX::monitorData(const SidechainSnapshot& snapshot, AkReal32 in_fPercentile, AkReal32 in_fRatio, AkUInt32 in_uNumInstances, AkUInt32 in_uFrames)
 {
-    m_pContext->GlobalContext()->UnregisterGlobalCallback(BeginRenderCallback, AkGlobalCallbackLocation_BeginRender);
-    m_pContext->GlobalContext()->UnregisterGlobalCallback(EndCallback, AkGlobalCallbackLocation_EndRender);
-    
-}
\ No newline at end of file
+#ifndef AK_OPTIMIZED
+    // Decimated to MonitorRate packets per second, whatever the buffer size
+    const AkInt32 iMonitorRate = m_pParams->NonRTPC.iMonitorRate;
+    if (iMonitorRate <= 0)
+    {
+        return;
+    }
+    const AkUInt32 uInterval = SampleRate / (AkUInt32)AkMin(iMonitorRate, (AkInt32)60);
+    m_uMonitorFrames += in_uFrames;
+    if (m_uMonitorFrames < uInterval)
+    {
+        return;
+    }
+    // Carry the remainder so the average rate is exact; never post more than once per block
+    m_uMonitorFrames = m_uMonitorFrames - uInterval < uInterval ? m_uMonitorFrames - uInterval : 0;
+
+    if (m_pContext->CanPostMonitorData())
+    {
+        SidechainMonitorPacket packet = {};
+        packet.uVersion = SidechainMonitorPacket::kVersion;
+        packet.uSize = sizeof(SidechainMonitorPacket);
+        packet.uNumChannels = (AkUInt16)AkMin(m_uNumChannels, SidechainMonitorPacket::kMaxChannels);
+        packet.uNumInstances = (AkUInt16)AkMin(in_uNumInstances, (AkUInt32)0xFFFF);
+        packet.fPercentile = in_fPercentile;
+        packet.fRatio = in_fRatio;
+        packet.uLatencyFrames = m_uLookahead;
+        for (AkUInt32 i = 0; i < packet.uNumChannels; ++i)
+        {
+            packet.fSidechainRMS[i] = 0.0f;
+            for (AkUInt32 band = 0; band < m_uNumBands; ++band)
+            {
+                packet.fSidechainRMS[i] = AkMax(packet.fSidechainRMS[i], snapshot.newbuffer_mRMS[m_uLanes[band * m_uLanesPerBand + m_pChannelLane[i]]]);
+            }
+            packet.fGain[i] = m_pChannelGain[i];
+        }
+
+        m_pContext->PostMonitorData(&packet, sizeof(packet));
+    }
+#endif // !AK_OPTIMIZED
+}
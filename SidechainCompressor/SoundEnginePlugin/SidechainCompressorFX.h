@@ -29,17 +29,16 @@ the specific language governing permissions and limitations under the License.
 
 #include "SidechainCompressorFXParams.h"
 #include "SidechainCompressorSharedBuffer.h"
+#include "SidechainCompressorGainKernel.h"
+#include "SidechainCompressorCrossover.h"
+#include "SidechainCompressorMonitorData.h"
+#include "SidechainCompressorMeter.h"
 #include <AK/SoundEngine/Common/AkSoundEngine.h>
 #include <AK/SoundEngine/Common/AkCallback.h>
 #include <AK/SoundEngine/Common/AkModule.h>
 #include <AK/SoundEngine/Common/AkTypes.h>
 #include <AK/SoundEngine/Common/AkCommonDefs.h>
 #include <cmath>
-#include <string>
-#include <iostream>
-#include <sstream>
-#include <iomanip>
-#include <chrono>
 
 /// See https://www.audiokinetic.com/library/edge/?source=SDK&id=soundengine__plugins__effects.html
 /// for the documentation about effect plug-ins
@@ -73,41 +72,165 @@ public:
     /// Return AK_DataReady or AK_NoMoreData, depending if there would be audio output or not at that point.
     AKRESULT TimeSkip(AkUInt32 &io_uFrames) override;
 
-    static void AKSOUNDENGINE_CALL BeginRenderCallback(
-        AK::IAkGlobalPluginContext* in_pContext,
-        AkGlobalCallbackLocation in_eLocation,
-        void* in_pCookie);
+    /// Frames the output lags the input by: the lookahead delay, fixed at Init.
+    AkUInt32 GetLatencyFrames() const { return m_uLookahead; }
 
-    static void AKSOUNDENGINE_CALL EndCallback(
-        AK::IAkGlobalPluginContext* in_pContext,
-        AkGlobalCallbackLocation in_eLocation,
-        void* in_pCookie);
+    /// Lookahead in frames for a Lookahead parameter in ms, clamped to 0 - kMaxLookaheadMs.
+    static AkUInt32 getLookaheadFrames(AkReal32 in_fLookaheadMs, AkUInt32 in_uSampleRate)
+    {
+        const AkReal32 fMs = AkMin(AkMax(in_fLookaheadMs, 0.0f), kMaxLookaheadMs);
+        return (AkUInt32)(fMs * 0.001f * in_uSampleRate + 0.5f);
+    }
 
-    
+    static constexpr AkReal32 kMaxLookaheadMs = 10.0f;
+
+    /// Bands the input is split into, fixed at Init.
+    AkUInt32 GetNumBands() const { return m_uNumBands; }
+
+    /// Linear gain the last Execute applied to one band of a channel, one per frame it
+    /// consumed, lined up with the output frames it wrote; the lookahead tail is not in it.
+    /// For tools and tests, valid until the next Execute, TimeSkip or Reset.
+    const AkReal32* GetGainBlock(AkUInt32 in_uChannel, AkUInt32 in_uBand) const
+    {
+        return m_pGain + (size_t)(in_uBand * m_uLanesPerBand + m_pChannelLane[in_uChannel]) * m_uGainStride;
+    }
+
+#ifndef AK_OPTIMIZED
+    /// Metering consumer, for meters, logs and tools on a non-audio thread; at most one
+    /// consumer per instance. Copies out up to in_uMaxBlocks per-block entries, oldest first.
+    AkUInt32 DrainMeters(SidechainMeterBlock* out_pBlocks, AkUInt32 in_uMaxBlocks) { return m_meters.drain(out_pBlocks, in_uMaxBlocks); }
+
+    /// Blocks not metered because the consumer fell behind.
+    AkUInt32 GetDroppedMeters() const { return m_meters.dropped(); }
+#endif // !AK_OPTIMIZED
 
 private:
     SidechainCompressorFXParams* m_pParams;
     AK::IAkPluginMemAlloc* m_pAllocator;
     AK::IAkEffectPluginContext* m_pContext;
-    std::map<AkUniqueID, AkReal32> mapFormat;
-
 
-    std::shared_ptr<SidechainCompressorSharedBuffer> m_sharedBuffer = GlobalManager::getGlobalBuffer(mapFormat);
+    // Every sidechain group this instance feeds or listens to, see GlobalManager
+    struct GroupLink
+    {
+        std::shared_ptr<SidechainCompressorSharedBuffer> bus;
+        AkUInt32 group = 0;
+        AkInt32 slot = SidechainCompressorSharedBuffer::kInvalidSlot;   // Handle into the bus's instance table
+        bool feeds = false;                                             // Contributes to the bus
+        bool listens = false;                                           // Ranked on the bus and ducked by it
+    };
+    GroupLink m_groups[GlobalManager::kMaxGroups];
+    AkUInt32 m_uNumGroups = 0;
 
-    std::string errorMsg1 = "Default Error Message 1";
-    std::string errorMsg2 = "Default Error Message 2";
     AkUInt32 SampleRate = 0;
     AkReal32 priorityRank = 0.0f;
     AkUniqueID objectID;
-    std::mutex mtx;
-
-    void resetCalcs();
-    void doCalcs();
-    void doDSP();
-    void monitorData();
 
-    void registerCallbacks();
-    void unregisterCallbacks();
+    AkUInt32 m_uMaxFrames = 0;
+    AkUInt32 m_uMaxLanes = 0;                           // Most distinct lanes any link mode gives the channels
+    AkUInt32 m_uGainStride = 0;                         // m_uMaxFrames, aligned
+    AkReal32* m_pDetector = nullptr;                    // Detector level per point and lane, frame-major, linear
+    AkReal32* m_pGain = nullptr;                        // Gain per frame, lane-major, linear, in m_pDetector's block
+
+    // Distinct snapshot lanes the channels read, in channel order
+    AkUInt32 m_uLanes[SidechainSnapshot::kNumLanes];
+    AkUInt32 m_uNumLanes = 0;
+
+    // Attack/release follower on the detector level, per snapshot lane. Lanes are followed
+    // kFollowerWidth at a time, one vector across lanes.
+    static const AkUInt32 kFollowerWidth = 4;
+    static const AkUInt32 kMaxPaddedLanes = (SidechainSnapshot::kNumLanes + kFollowerWidth - 1) / kFollowerWidth * kFollowerWidth;
+    AkReal32 m_fEnvelope[SidechainSnapshot::kNumLanes] = {};
+    AkReal32 m_fAttackCoef = 1.0f;                      // Per frame
+    AkReal32 m_fReleaseCoef = 1.0f;
+    AkReal32 m_fAttackCoefStep = 1.0f;                  // Per control-rate step
+    AkReal32 m_fReleaseCoefStep = 1.0f;
+    AkReal32 m_fAttackLagStep = 0.0f;                   // Frames before a step's end to read its level at
+    AkReal32 m_fReleaseLagStep = 0.0f;
+    AkUInt32 m_uFollowerStep = 1;                       // Control rate the step coefficients are for
+    AkUInt32 m_uSkipFrames = ~0u;                        // TimeSkip length the decays are for
+    AkReal32 m_fAttackDecaySkip = 1.0f;                 // (1 - coefficient)^m_uSkipFrames
+    AkReal32 m_fReleaseDecaySkip = 1.0f;
+
+    // Gain curve the last block ended on and the percentile it was made for. Only rebuilt
+    // when threshold, max ratio or percentile move, and then ramped to across the block.
+    // With a curve table, each curve is sampled into one of two tables: the current one,
+    // and the one a ramp starts from.
+    static constexpr AkReal32 kKneeDb = 1.0f;
+    SidechainGainCurve m_curve;
+    SidechainGainCurve m_previousCurve;
+    SidechainGainTable m_tables[2];
+    AkUInt32 m_uTable = 0;                              // m_tables index of m_curve
+    AkReal32* m_pTableBlock = nullptr;                  // Entry levels, then both tables' gains
+    SidechainGainKernel::LookupFunc m_lookupGain = nullptr;     // Set when the curve is read from m_tables
+    AkReal32 m_fCurvePercentile = 0.0f;
+    AkReal32 m_fRatio = 1.0f;                           // Ratio m_curve was made with
+    bool m_bCurveStale = true;                          // Threshold or max ratio changed since m_curve was made
+    bool m_bCurveSet = false;                           // m_curve was applied, so a change ramps from it
+
+    // Per-channel state, one block sized from the channel config at Init
+    AkUInt32 m_uNumChannels = 0;
+    AkReal32* m_pChannelGain = nullptr;                 // Last gain applied to each channel, linear
+    AkUInt32* m_pChannelLane = nullptr;                 // Index in m_uLanes of the lane each channel reads
+    SidechainGainKernel::ComputeFunc m_computeGain = nullptr;
+    AkUInt32 m_uMonitorFrames = 0;                      // Frames rendered since the last monitor packet
+
+    // Multiband: the input is split at the crossovers and each band ducked by the same band
+    // of the sidechain, then summed back. m_uLanes holds the lanes of every band, band-major.
+    static const AkUInt32 kBandChunk = 64;              // Frames split at a time
+    AkUInt32 m_uNumBands = 1;
+    AkUInt32 m_uLanesPerBand = 0;                       // Band b's lanes are m_uLanes[b * m_uLanesPerBand ...]
+    SidechainCrossover m_crossover;
+    AkReal32* m_pBandBlock = nullptr;                   // kBandChunk frames of input, frame-major, then of the crossover's lanes
+    AkReal32 m_fLaneGain[SidechainSnapshot::kNumLanes] = {};    // Last gain of each of m_uLanes, held through the tail
+
+    // Lookahead: the input is delayed by m_uLookahead frames so the gain leads the audio
+    AkUInt32 m_uLookahead = 0;
+    AkUInt32 m_uDelayStride = 0;                        // m_uLookahead, aligned
+    AkUInt32 m_uDelayPos = 0;                           // Oldest frame of every channel's ring
+    AkUInt32 m_uTailRemaining = 0;                      // Delayed frames still to flush once the input ends
+    bool m_bDelayCleared = false;                       // Rings zeroed by TimeSkip and not written since
+    AkReal32* m_pDelay = nullptr;                       // Channel-major rings, m_uNumChannels * m_uDelayStride
+#ifndef AK_OPTIMIZED
+    static const AkUInt32 kMeterCapacity = 512;         // About 2.7 s of 256-frame blocks at 48 kHz
+    static const AkUInt32 kMeterWidth = 8;              // Partial min/max/sum per lane, one vector
+    SidechainSpscRing<SidechainMeterBlock, kMeterCapacity> m_meters;
+    AkUInt32 m_uMeterBlock = 0;
+#endif
+    void monitorData(const SidechainSnapshot& snapshot, AkReal32 in_fPercentile, AkReal32 in_fRatio, AkUInt32 in_uNumInstances, AkUInt32 in_uFrames);
+    void releaseGroups();
+    void updateChannelLanes();
+    void updateFollower();
+
+    // Parameter changes since the last Execute or TimeSkip
+    void applyParamChanges();
+
+    // Merged snapshot of every listened group, the strongest percentile and the instances ranked
+    void readSnapshot(SidechainSnapshot& out_snapshot, AkReal32& out_percentile, AkUInt32& out_uNumRanked) const;
+
+    // out = delayed in * gain, through the channel's lookahead ring, from m_uDelayPos. Without
+    // a gain, only delayed.
+    void applyDelayed(AkUInt32 channel, const AkReal32* in_pIn, AkReal32* out_pOut, const AkReal32* in_pGain, AkUInt32 uFrames);
+    void advanceDelay(AkUInt32 uFrames);
+
+    // Splits uFrames of each channel, delayed when there is a lookahead, and sums the bands back
+    // into the output at out_uOffset, each at its lane's gain. No input buffer is silence.
+    void applyBands(AkAudioBuffer* in_pBuffer, AkUInt32 in_uOffset, AkAudioBuffer* out_pBuffer, AkUInt32 out_uOffset, AkUInt32 uNumChannels, AkUInt32 uFrames);
+    void getCrossovers(AkReal32* out_pFrequencies) const;
+    SidechainKeyFilter::Settings getKeyFilter() const;
+
+    // Rebuilds m_curve if its inputs moved; true when it did and the block should ramp from the old one
+    bool updateCurve(AkReal32 in_fPercentile);
+
+    // Follower and gain of every lane for the uFrames from uPosition in the audio frame, into
+    // m_pGain. With bRampCurve, the curve moves from m_previousCurve to m_curve across the frames.
+    void computeGains(const SidechainSnapshot& snapshot, AkUInt32 uPosition, AkUInt32 uFrames, AkUInt32 uControlRate, bool bRampCurve);
+
+    // Levels to gains on m_curve, or m_previousCurve, through the table when there is one
+    void curveGains(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 uCount, bool bPrevious) const;
+
+    // Levels to gains in place on m_curve. With bRamp, gains are blended from m_previousCurve's
+    // by t = t0 + (i / uGroup) * dt for element i, up to 1.
+    void applyCurve(AkReal32* io_pLevel, AkUInt32 uCount, bool bRamp, AkUInt32 uGroup, AkReal32 t0, AkReal32 dt);
 
 };
 
@@ -56,6 +56,26 @@ AKRESULT SidechainCompressorFXParams::Init(AK::IAkPluginMemAlloc* in_pAllocator,
         RTPC.fThreshold = 0.0f;
         RTPC.fMaxRatio = 1.0f;
         RTPC.fPriorityRank = 1.0f;
+        RTPC.fAttack = 1.0f;
+        RTPC.fRelease = 20.0f;
+        NonRTPC.iControlRate = 1;
+        NonRTPC.fRMSWindow = 10.0f;
+        NonRTPC.iDetectorMode = 0;
+        NonRTPC.iChannelLink = 0;
+        NonRTPC.iFeedGroups = 1;
+        NonRTPC.iListenGroups = 1;
+        NonRTPC.iMonitorRate = 20;
+        NonRTPC.fLookahead = 0.0f;
+        NonRTPC.fCurveTableStep = 0.0f;
+        NonRTPC.iNumBands = 1;
+        NonRTPC.fCrossover1 = 250.0f;
+        NonRTPC.fCrossover2 = 2000.0f;
+        NonRTPC.fCrossover3 = 8000.0f;
+        NonRTPC.iKeyFilter = 0;
+        NonRTPC.fKeyFrequency = 200.0f;
+        NonRTPC.fKeyQ = 0.707f;
+        NonRTPC.fKeyGain = -12.0f;
+        NonRTPC.iContribution = 0;
         m_paramChangeHandler.SetAllParamChanges();
         return AK_Success;
     }
@@ -78,6 +98,26 @@ AKRESULT SidechainCompressorFXParams::SetParamsBlock(const void* in_pParamsBlock
     RTPC.fThreshold = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fMaxRatio = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fPriorityRank = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iControlRate = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fRMSWindow = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iDetectorMode = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iChannelLink = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iFeedGroups = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iListenGroups = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iMonitorRate = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fLookahead = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fAttack = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fRelease = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fCurveTableStep = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iNumBands = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fCrossover1 = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fCrossover2 = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fCrossover3 = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iKeyFilter = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fKeyFrequency = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fKeyQ = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fKeyGain = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.iContribution = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
     CHECKBANKDATASIZE(in_ulBlockSize, eResult);
     m_paramChangeHandler.SetAllParamChanges();
 
@@ -103,6 +143,86 @@ AKRESULT SidechainCompressorFXParams::SetParam(AkPluginParamID in_paramID, const
         RTPC.fPriorityRank = *((AkReal32*)in_pValue);
         m_paramChangeHandler.SetParamChange(PARAM_PRIORITYRANK_ID);
         break;
+    case PARAM_CONTROLRATE_ID:
+        NonRTPC.iControlRate = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CONTROLRATE_ID);
+        break;
+    case PARAM_RMSWINDOW_ID:
+        NonRTPC.fRMSWindow = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_RMSWINDOW_ID);
+        break;
+    case PARAM_DETECTORMODE_ID:
+        NonRTPC.iDetectorMode = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DETECTORMODE_ID);
+        break;
+    case PARAM_CHANNELLINK_ID:
+        NonRTPC.iChannelLink = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CHANNELLINK_ID);
+        break;
+    case PARAM_FEEDGROUPS_ID:
+        NonRTPC.iFeedGroups = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_FEEDGROUPS_ID);
+        break;
+    case PARAM_LISTENGROUPS_ID:
+        NonRTPC.iListenGroups = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_LISTENGROUPS_ID);
+        break;
+    case PARAM_MONITORRATE_ID:
+        NonRTPC.iMonitorRate = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_MONITORRATE_ID);
+        break;
+    case PARAM_LOOKAHEAD_ID:
+        NonRTPC.fLookahead = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_LOOKAHEAD_ID);
+        break;
+    case PARAM_ATTACK_ID:
+        RTPC.fAttack = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_ATTACK_ID);
+        break;
+    case PARAM_RELEASE_ID:
+        RTPC.fRelease = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_RELEASE_ID);
+        break;
+    case PARAM_CURVETABLESTEP_ID:
+        NonRTPC.fCurveTableStep = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CURVETABLESTEP_ID);
+        break;
+    case PARAM_NUMBANDS_ID:
+        NonRTPC.iNumBands = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_NUMBANDS_ID);
+        break;
+    case PARAM_CROSSOVER1_ID:
+        NonRTPC.fCrossover1 = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CROSSOVER1_ID);
+        break;
+    case PARAM_CROSSOVER2_ID:
+        NonRTPC.fCrossover2 = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CROSSOVER2_ID);
+        break;
+    case PARAM_CROSSOVER3_ID:
+        NonRTPC.fCrossover3 = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CROSSOVER3_ID);
+        break;
+    case PARAM_KEYFILTER_ID:
+        NonRTPC.iKeyFilter = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_KEYFILTER_ID);
+        break;
+    case PARAM_KEYFREQUENCY_ID:
+        NonRTPC.fKeyFrequency = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_KEYFREQUENCY_ID);
+        break;
+    case PARAM_KEYQ_ID:
+        NonRTPC.fKeyQ = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_KEYQ_ID);
+        break;
+    case PARAM_KEYGAIN_ID:
+        NonRTPC.fKeyGain = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_KEYGAIN_ID);
+        break;
+    case PARAM_CONTRIBUTION_ID:
+        NonRTPC.iContribution = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CONTRIBUTION_ID);
+        break;
     default:
         eResult = AK_InvalidParameter;
         break;
@@ -35,17 +35,57 @@ the specific language governing permissions and limitations under the License.
 static const AkPluginParamID PARAM_THRESHOLD_ID = 0;
 static const AkPluginParamID PARAM_MAXRATIO_ID = 1;
 static const AkPluginParamID PARAM_PRIORITYRANK_ID = 2;
-static const AkUInt32 NUM_PARAMS = 3;
+static const AkPluginParamID PARAM_CONTROLRATE_ID = 3;
+static const AkPluginParamID PARAM_RMSWINDOW_ID = 4;
+static const AkPluginParamID PARAM_DETECTORMODE_ID = 5;
+static const AkPluginParamID PARAM_CHANNELLINK_ID = 6;
+static const AkPluginParamID PARAM_FEEDGROUPS_ID = 7;
+static const AkPluginParamID PARAM_LISTENGROUPS_ID = 8;
+static const AkPluginParamID PARAM_MONITORRATE_ID = 9;
+static const AkPluginParamID PARAM_LOOKAHEAD_ID = 10;
+static const AkPluginParamID PARAM_ATTACK_ID = 11;
+static const AkPluginParamID PARAM_RELEASE_ID = 12;
+static const AkPluginParamID PARAM_CURVETABLESTEP_ID = 13;
+static const AkPluginParamID PARAM_NUMBANDS_ID = 14;
+static const AkPluginParamID PARAM_CROSSOVER1_ID = 15;
+static const AkPluginParamID PARAM_CROSSOVER2_ID = 16;
+static const AkPluginParamID PARAM_CROSSOVER3_ID = 17;
+static const AkPluginParamID PARAM_KEYFILTER_ID = 18;
+static const AkPluginParamID PARAM_KEYFREQUENCY_ID = 19;
+static const AkPluginParamID PARAM_KEYQ_ID = 20;
+static const AkPluginParamID PARAM_KEYGAIN_ID = 21;
+static const AkPluginParamID PARAM_CONTRIBUTION_ID = 22;
+static const AkUInt32 NUM_PARAMS = 23;
 
 struct SidechainCompressorRTPCParams
 {
     AkReal32 fThreshold;
     AkReal32 fMaxRatio;
     AkReal32 fPriorityRank;
+    AkReal32 fAttack;           // Detector follower time constant while the level rises, ms
+    AkReal32 fRelease;          // Detector follower time constant while the level falls, ms
 };
 
 struct SidechainCompressorNonRTPCParams
 {
+    AkInt32 iControlRate;       // Gain computed every N frames and interpolated in between; 1 = every frame
+    AkReal32 fRMSWindow;        // Sidechain detector window, ms
+    AkInt32 iDetectorMode;      // SidechainDetector::Mode: 0 = sliding window, 1 = one-pole
+    AkInt32 iChannelLink;       // SidechainChannelLink: 0 = unlinked, 1 = loudest channel, 2 = total power
+    AkInt32 iFeedGroups;        // Bit g set: this input is summed into sidechain group g. Applied at Init
+    AkInt32 iListenGroups;      // Bit g set: ducked by (and ranked in) sidechain group g. Applied at Init
+    AkInt32 iMonitorRate;       // Monitor packets posted per second to the authoring tool; 0 = none
+    AkReal32 fLookahead;        // Audio delay so the gain leads transients, ms, 0 - 10. Applied at Init
+    AkReal32 fCurveTableStep;   // Gain curve read from a table with entries this many dB apart; 0 = computed directly. Applied at Init
+    AkInt32 iNumBands;          // 1 = full band; 2 - 4 = each band ducked by the same band of the sidechain. Applied at Init
+    AkReal32 fCrossover1;       // Crossover frequencies between the bands, Hz, in any order; only the first iNumBands - 1 are used
+    AkReal32 fCrossover2;
+    AkReal32 fCrossover3;
+    AkInt32 iKeyFilter;         // SidechainKeyFilter::Type on the summed sidechain: 0 = off, 1 = high pass, 2 = band pass, 3 = low shelf, 4 = high shelf
+    AkReal32 fKeyFrequency;     // Key filter corner, centre or shelf frequency, Hz
+    AkReal32 fKeyQ;             // Key filter Q, high and band pass
+    AkReal32 fKeyGain;          // Key filter shelf gain, dB
+    AkInt32 iContribution;      // SidechainContribution fed to the groups: 0 = samples, 1 = block energy. Applied at Init
 };
 
 struct SidechainCompressorFXParams
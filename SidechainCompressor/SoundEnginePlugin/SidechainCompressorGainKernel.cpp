@@ -0,0 +1,478 @@
+#include "SidechainCompressorGainKernel.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SC_GAINKERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SC_TARGET_SSE2
+#define SC_TARGET_AVX2
+#define SC_TARGET_AVX512
+#else
+#define SC_TARGET_SSE2 __attribute__((target("sse2")))
+#define SC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SC_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+#endif
+
+namespace
+{
+    const AkReal32 kMinLevel = 1.0e-12f;            // -240 dB
+    const AkReal32 kDBPerOctave = 6.02059991f;      // 20 * log10(2)
+    const AkReal32 kOctavesPerDB = 0.166096404f;    // log2(10) / 20
+    const AkReal32 kMinExponent = -126.0f;
+
+    // log2(m) ~= t * (L1 + t * (L2 + t * (L3 + t * (L4 + t * L5)))), t = m - 1, m in [1, 2). |error| < 1.5e-5
+    const AkReal32 L1 = 1.44196557f;
+    const AkReal32 L2 = -0.709662369f;
+    const AkReal32 L3 = 0.417594419f;
+    const AkReal32 L4 = -0.196268011f;
+    const AkReal32 L5 = 0.0463846917f;
+
+    // 2^f ~= 1 + f * (E1 + f * (E2 + f * (E3 + f * (E4 + f * E5)))), f in [0, 1). |error| < 1.2e-7
+    const AkReal32 E1 = 0.693152472f;
+    const AkReal32 E2 = 0.240152807f;
+    const AkReal32 E3 = 0.0558359295f;
+    const AkReal32 E4 = 0.00897337577f;
+    const AkReal32 E5 = 0.00188529851f;
+
+    inline AkReal32 levelToDBScalar(AkReal32 level)
+    {
+        level = level > kMinLevel ? level : kMinLevel;
+
+        AkUInt32 bits;
+        memcpy(&bits, &level, sizeof(bits));
+        AkReal32 exponent = (AkReal32)((AkInt32)(bits >> 23) - 127);
+        bits = (bits & 0x007FFFFF) | 0x3F800000;
+        AkReal32 m;
+        memcpy(&m, &bits, sizeof(m));
+        AkReal32 t = m - 1.0f;
+        return (exponent + t * (L1 + t * (L2 + t * (L3 + t * (L4 + t * L5))))) * kDBPerOctave;
+    }
+
+    inline AkReal32 gainScalar(AkReal32 level, const SidechainGainCurve& curve)
+    {
+        AkReal32 x = levelToDBScalar(level);
+
+        AkReal32 over = x - curve.threshold;
+        AkReal32 d = over + curve.halfKnee;
+        d = d < 0.0f ? 0.0f : (d > 2.0f * curve.halfKnee ? 2.0f * curve.halfKnee : d);
+        AkReal32 above = over - curve.halfKnee;
+        above = above > 0.0f ? above : 0.0f;
+        AkReal32 y = curve.slope * (d * d * curve.halfInvKnee + above) * kOctavesPerDB;
+
+        y = y > kMinExponent ? y : kMinExponent;
+        AkInt32 i = (AkInt32)y;
+        i -= (AkReal32)i > y ? 1 : 0;
+        AkReal32 f = y - (AkReal32)i;
+        AkUInt32 scaleBits = (AkUInt32)(i + 127) << 23;
+        AkReal32 scale;
+        memcpy(&scale, &scaleBits, sizeof(scale));
+        return scale * (1.0f + f * (E1 + f * (E2 + f * (E3 + f * (E4 + f * E5)))));
+    }
+
+    void computeScalar(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainCurve& in_curve)
+    {
+        for (AkUInt32 frame = 0; frame < in_uFrames; ++frame)
+        {
+            out_pGain[frame] = gainScalar(in_pLevel[frame], in_curve);
+        }
+    }
+
+    // Position in the table, clamped to [0, numEntries - 1]: entry i and i + 1 always exist
+    inline AkReal32 lookupScalar(AkReal32 level, const SidechainGainTable& table, AkReal32 last)
+    {
+        AkReal32 position = (levelToDBScalar(level) - SidechainGainTable::kMinDb) * table.entriesPerDb;
+        position = position > 0.0f ? position : 0.0f;
+        position = position < last ? position : last;
+        const AkInt32 i = (AkInt32)position;
+        const AkReal32 f = position - (AkReal32)i;
+        return table.gains[i] + f * (table.gains[i + 1] - table.gains[i]);
+    }
+
+    void lookupScalar(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainTable& in_table)
+    {
+        const AkReal32 last = (AkReal32)(in_table.numEntries - 1);
+        for (AkUInt32 frame = 0; frame < in_uFrames; ++frame)
+        {
+            out_pGain[frame] = lookupScalar(in_pLevel[frame], in_table, last);
+        }
+    }
+
+#ifdef SC_GAINKERNEL_X86
+    SC_TARGET_SSE2 void computeSSE2(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainCurve& in_curve)
+    {
+        const __m128 minLevel = _mm_set1_ps(kMinLevel);
+        const __m128i mantissaMask = _mm_set1_epi32(0x007FFFFF);
+        const __m128i one = _mm_set1_epi32(0x3F800000);
+        const __m128i bias = _mm_set1_epi32(127);
+        const __m128 threshold = _mm_set1_ps(in_curve.threshold);
+        const __m128 halfKnee = _mm_set1_ps(in_curve.halfKnee);
+        const __m128 knee = _mm_set1_ps(2.0f * in_curve.halfKnee);
+        const __m128 halfInvKnee = _mm_set1_ps(in_curve.halfInvKnee);
+        const __m128 slope = _mm_set1_ps(in_curve.slope * kOctavesPerDB);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 fone = _mm_set1_ps(1.0f);
+
+        AkUInt32 frame = 0;
+        for (; frame + 4 <= in_uFrames; frame += 4)
+        {
+            __m128 level = _mm_max_ps(_mm_loadu_ps(in_pLevel + frame), minLevel);
+
+            __m128i bits = _mm_castps_si128(level);
+            __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+            __m128 t = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissaMask), one)), fone);
+            __m128 p = _mm_add_ps(_mm_set1_ps(L4), _mm_mul_ps(t, _mm_set1_ps(L5)));
+            p = _mm_add_ps(_mm_set1_ps(L3), _mm_mul_ps(t, p));
+            p = _mm_add_ps(_mm_set1_ps(L2), _mm_mul_ps(t, p));
+            p = _mm_add_ps(_mm_set1_ps(L1), _mm_mul_ps(t, p));
+            __m128 x = _mm_mul_ps(_mm_add_ps(exponent, _mm_mul_ps(t, p)), _mm_set1_ps(kDBPerOctave));
+
+            __m128 over = _mm_sub_ps(x, threshold);
+            __m128 d = _mm_min_ps(_mm_max_ps(_mm_add_ps(over, halfKnee), zero), knee);
+            __m128 above = _mm_max_ps(_mm_sub_ps(over, halfKnee), zero);
+            __m128 y = _mm_mul_ps(slope, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(d, d), halfInvKnee), above));
+
+            y = _mm_max_ps(y, _mm_set1_ps(kMinExponent));
+            __m128i i = _mm_cvttps_epi32(y);
+            __m128 fi = _mm_cvtepi32_ps(i);
+            __m128 adjust = _mm_and_ps(_mm_cmpgt_ps(fi, y), fone);
+            fi = _mm_sub_ps(fi, adjust);
+            i = _mm_cvtps_epi32(fi);
+            __m128 f = _mm_sub_ps(y, fi);
+            __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i, bias), 23));
+            __m128 e = _mm_add_ps(_mm_set1_ps(E4), _mm_mul_ps(f, _mm_set1_ps(E5)));
+            e = _mm_add_ps(_mm_set1_ps(E3), _mm_mul_ps(f, e));
+            e = _mm_add_ps(_mm_set1_ps(E2), _mm_mul_ps(f, e));
+            e = _mm_add_ps(_mm_set1_ps(E1), _mm_mul_ps(f, e));
+            e = _mm_add_ps(fone, _mm_mul_ps(f, e));
+
+            _mm_storeu_ps(out_pGain + frame, _mm_mul_ps(scale, e));
+        }
+
+        computeScalar(in_pLevel + frame, out_pGain + frame, in_uFrames - frame, in_curve);
+    }
+
+    SC_TARGET_AVX2 void computeAVX2(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainCurve& in_curve)
+    {
+        const __m256 minLevel = _mm256_set1_ps(kMinLevel);
+        const __m256i mantissaMask = _mm256_set1_epi32(0x007FFFFF);
+        const __m256i one = _mm256_set1_epi32(0x3F800000);
+        const __m256i bias = _mm256_set1_epi32(127);
+        const __m256 threshold = _mm256_set1_ps(in_curve.threshold);
+        const __m256 halfKnee = _mm256_set1_ps(in_curve.halfKnee);
+        const __m256 knee = _mm256_set1_ps(2.0f * in_curve.halfKnee);
+        const __m256 halfInvKnee = _mm256_set1_ps(in_curve.halfInvKnee);
+        const __m256 slope = _mm256_set1_ps(in_curve.slope * kOctavesPerDB);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 fone = _mm256_set1_ps(1.0f);
+
+        AkUInt32 frame = 0;
+        for (; frame + 8 <= in_uFrames; frame += 8)
+        {
+            __m256 level = _mm256_max_ps(_mm256_loadu_ps(in_pLevel + frame), minLevel);
+
+            __m256i bits = _mm256_castps_si256(level);
+            __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), bias));
+            __m256 t = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, mantissaMask), one)), fone);
+            __m256 p = _mm256_fmadd_ps(t, _mm256_set1_ps(L5), _mm256_set1_ps(L4));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(L3));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(L2));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(L1));
+            __m256 x = _mm256_mul_ps(_mm256_fmadd_ps(t, p, exponent), _mm256_set1_ps(kDBPerOctave));
+
+            __m256 over = _mm256_sub_ps(x, threshold);
+            __m256 d = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(over, halfKnee), zero), knee);
+            __m256 above = _mm256_max_ps(_mm256_sub_ps(over, halfKnee), zero);
+            __m256 y = _mm256_mul_ps(slope, _mm256_fmadd_ps(_mm256_mul_ps(d, d), halfInvKnee, above));
+
+            y = _mm256_max_ps(y, _mm256_set1_ps(kMinExponent));
+            __m256 fi = _mm256_floor_ps(y);
+            __m256 f = _mm256_sub_ps(y, fi);
+            __m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(fi), bias), 23));
+            __m256 e = _mm256_fmadd_ps(f, _mm256_set1_ps(E5), _mm256_set1_ps(E4));
+            e = _mm256_fmadd_ps(f, e, _mm256_set1_ps(E3));
+            e = _mm256_fmadd_ps(f, e, _mm256_set1_ps(E2));
+            e = _mm256_fmadd_ps(f, e, _mm256_set1_ps(E1));
+            e = _mm256_fmadd_ps(f, e, fone);
+
+            _mm256_storeu_ps(out_pGain + frame, _mm256_mul_ps(scale, e));
+        }
+
+        computeScalar(in_pLevel + frame, out_pGain + frame, in_uFrames - frame, in_curve);
+    }
+
+    SC_TARGET_AVX512 void computeAVX512(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainCurve& in_curve)
+    {
+        const __m512 minLevel = _mm512_set1_ps(kMinLevel);
+        const __m512i mantissaMask = _mm512_set1_epi32(0x007FFFFF);
+        const __m512i one = _mm512_set1_epi32(0x3F800000);
+        const __m512i bias = _mm512_set1_epi32(127);
+        const __m512 threshold = _mm512_set1_ps(in_curve.threshold);
+        const __m512 halfKnee = _mm512_set1_ps(in_curve.halfKnee);
+        const __m512 knee = _mm512_set1_ps(2.0f * in_curve.halfKnee);
+        const __m512 halfInvKnee = _mm512_set1_ps(in_curve.halfInvKnee);
+        const __m512 slope = _mm512_set1_ps(in_curve.slope * kOctavesPerDB);
+        const __m512 zero = _mm512_setzero_ps();
+        const __m512 fone = _mm512_set1_ps(1.0f);
+
+        for (AkUInt32 frame = 0; frame < in_uFrames; frame += 16)
+        {
+            // Masked tail instead of a scalar remainder loop
+            const AkUInt32 remaining = in_uFrames - frame;
+            const __mmask16 mask = remaining >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << remaining) - 1);
+            __m512 level = _mm512_max_ps(_mm512_mask_loadu_ps(minLevel, mask, in_pLevel + frame), minLevel);
+
+            __m512i bits = _mm512_castps_si512(level);
+            __m512 exponent = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), bias));
+            __m512 t = _mm512_sub_ps(_mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, mantissaMask), one)), fone);
+            __m512 p = _mm512_fmadd_ps(t, _mm512_set1_ps(L5), _mm512_set1_ps(L4));
+            p = _mm512_fmadd_ps(t, p, _mm512_set1_ps(L3));
+            p = _mm512_fmadd_ps(t, p, _mm512_set1_ps(L2));
+            p = _mm512_fmadd_ps(t, p, _mm512_set1_ps(L1));
+            __m512 x = _mm512_mul_ps(_mm512_fmadd_ps(t, p, exponent), _mm512_set1_ps(kDBPerOctave));
+
+            __m512 over = _mm512_sub_ps(x, threshold);
+            __m512 d = _mm512_min_ps(_mm512_max_ps(_mm512_add_ps(over, halfKnee), zero), knee);
+            __m512 above = _mm512_max_ps(_mm512_sub_ps(over, halfKnee), zero);
+            __m512 y = _mm512_mul_ps(slope, _mm512_fmadd_ps(_mm512_mul_ps(d, d), halfInvKnee, above));
+
+            y = _mm512_max_ps(y, _mm512_set1_ps(kMinExponent));
+            __m512 fi = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+            __m512 f = _mm512_sub_ps(y, fi);
+            __m512 scale = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(fi), bias), 23));
+            __m512 e = _mm512_fmadd_ps(f, _mm512_set1_ps(E5), _mm512_set1_ps(E4));
+            e = _mm512_fmadd_ps(f, e, _mm512_set1_ps(E3));
+            e = _mm512_fmadd_ps(f, e, _mm512_set1_ps(E2));
+            e = _mm512_fmadd_ps(f, e, _mm512_set1_ps(E1));
+            e = _mm512_fmadd_ps(f, e, fone);
+
+            _mm512_mask_storeu_ps(out_pGain + frame, mask, _mm512_mul_ps(scale, e));
+        }
+    }
+
+    // SSE2 has no gather: positions are vector, the reads are scalar
+    SC_TARGET_SSE2 void lookupSSE2(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainTable& in_table)
+    {
+        const __m128 minLevel = _mm_set1_ps(kMinLevel);
+        const __m128i mantissaMask = _mm_set1_epi32(0x007FFFFF);
+        const __m128i one = _mm_set1_epi32(0x3F800000);
+        const __m128i bias = _mm_set1_epi32(127);
+        const __m128 fone = _mm_set1_ps(1.0f);
+        const __m128 minDb = _mm_set1_ps(SidechainGainTable::kMinDb);
+        const __m128 entriesPerDb = _mm_set1_ps(in_table.entriesPerDb);
+        const __m128 last = _mm_set1_ps((AkReal32)(in_table.numEntries - 1));
+        const AkReal32* AK_RESTRICT pGains = in_table.gains;
+
+        AkUInt32 frame = 0;
+        for (; frame + 4 <= in_uFrames; frame += 4)
+        {
+            __m128 level = _mm_max_ps(_mm_loadu_ps(in_pLevel + frame), minLevel);
+
+            __m128i bits = _mm_castps_si128(level);
+            __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+            __m128 t = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissaMask), one)), fone);
+            __m128 p = _mm_add_ps(_mm_set1_ps(L4), _mm_mul_ps(t, _mm_set1_ps(L5)));
+            p = _mm_add_ps(_mm_set1_ps(L3), _mm_mul_ps(t, p));
+            p = _mm_add_ps(_mm_set1_ps(L2), _mm_mul_ps(t, p));
+            p = _mm_add_ps(_mm_set1_ps(L1), _mm_mul_ps(t, p));
+            __m128 x = _mm_mul_ps(_mm_add_ps(exponent, _mm_mul_ps(t, p)), _mm_set1_ps(kDBPerOctave));
+
+            __m128 position = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(x, minDb), entriesPerDb), _mm_setzero_ps()), last);
+            __m128i i = _mm_cvttps_epi32(position);
+            __m128 f = _mm_sub_ps(position, _mm_cvtepi32_ps(i));
+
+            alignas(16) AkInt32 index[4];
+            _mm_store_si128((__m128i*)index, i);
+            __m128 g0 = _mm_setr_ps(pGains[index[0]], pGains[index[1]], pGains[index[2]], pGains[index[3]]);
+            __m128 g1 = _mm_setr_ps(pGains[index[0] + 1], pGains[index[1] + 1], pGains[index[2] + 1], pGains[index[3] + 1]);
+            _mm_storeu_ps(out_pGain + frame, _mm_add_ps(g0, _mm_mul_ps(f, _mm_sub_ps(g1, g0))));
+        }
+
+        lookupScalar(in_pLevel + frame, out_pGain + frame, in_uFrames - frame, in_table);
+    }
+
+    SC_TARGET_AVX2 void lookupAVX2(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainTable& in_table)
+    {
+        const __m256 minLevel = _mm256_set1_ps(kMinLevel);
+        const __m256i mantissaMask = _mm256_set1_epi32(0x007FFFFF);
+        const __m256i one = _mm256_set1_epi32(0x3F800000);
+        const __m256i bias = _mm256_set1_epi32(127);
+        const __m256 fone = _mm256_set1_ps(1.0f);
+        const __m256 minDb = _mm256_set1_ps(SidechainGainTable::kMinDb);
+        const __m256 entriesPerDb = _mm256_set1_ps(in_table.entriesPerDb);
+        const __m256 last = _mm256_set1_ps((AkReal32)(in_table.numEntries - 1));
+        const __m256i ione = _mm256_set1_epi32(1);
+
+        AkUInt32 frame = 0;
+        for (; frame + 8 <= in_uFrames; frame += 8)
+        {
+            __m256 level = _mm256_max_ps(_mm256_loadu_ps(in_pLevel + frame), minLevel);
+
+            __m256i bits = _mm256_castps_si256(level);
+            __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), bias));
+            __m256 t = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, mantissaMask), one)), fone);
+            __m256 p = _mm256_fmadd_ps(t, _mm256_set1_ps(L5), _mm256_set1_ps(L4));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(L3));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(L2));
+            p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(L1));
+            __m256 x = _mm256_mul_ps(_mm256_fmadd_ps(t, p, exponent), _mm256_set1_ps(kDBPerOctave));
+
+            __m256 position = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(x, minDb), entriesPerDb), _mm256_setzero_ps()), last);
+            __m256i i = _mm256_cvttps_epi32(position);
+            __m256 f = _mm256_sub_ps(position, _mm256_cvtepi32_ps(i));
+            __m256 g0 = _mm256_i32gather_ps(in_table.gains, i, 4);
+            __m256 g1 = _mm256_i32gather_ps(in_table.gains, _mm256_add_epi32(i, ione), 4);
+            _mm256_storeu_ps(out_pGain + frame, _mm256_fmadd_ps(f, _mm256_sub_ps(g1, g0), g0));
+        }
+
+        lookupScalar(in_pLevel + frame, out_pGain + frame, in_uFrames - frame, in_table);
+    }
+
+    bool cpuSupports(SidechainGainKernel::Isa isa)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool sse2 = (info[3] & (1 << 26)) != 0;
+        const bool fma = (info[2] & (1 << 12)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        const bool avxState = (xcr0 & 0x6) == 0x6;
+        const bool avx512State = (xcr0 & 0xE6) == 0xE6;
+        int ext[4] = { 0, 0, 0, 0 };
+        if (maxLeaf >= 7)
+        {
+            __cpuidex(ext, 7, 0);
+        }
+        const bool avx2 = (ext[1] & (1 << 5)) != 0;
+        const bool avx512f = (ext[1] & (1 << 16)) != 0;
+
+        switch (isa)
+        {
+        case SidechainGainKernel::Isa_SSE2: return sse2;
+        case SidechainGainKernel::Isa_AVX2: return avx2 && fma && avxState;
+        case SidechainGainKernel::Isa_AVX512: return avx512f && avx512State;
+        default: return true;
+        }
+#else
+        __builtin_cpu_init();
+        switch (isa)
+        {
+        case SidechainGainKernel::Isa_SSE2: return __builtin_cpu_supports("sse2");
+        case SidechainGainKernel::Isa_AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case SidechainGainKernel::Isa_AVX512: return __builtin_cpu_supports("avx512f");
+        default: return true;
+        }
+#endif
+    }
+#endif // SC_GAINKERNEL_X86
+}
+
+SidechainGainCurve SidechainGainCurve::make(AkReal32 threshold, AkReal32 ratio, AkReal32 knee)
+{
+    SidechainGainCurve curve;
+    curve.threshold = threshold;
+    curve.halfKnee = knee > 0.0f ? knee * 0.5f : 0.0f;
+    curve.halfInvKnee = knee > 0.0f ? 0.5f / knee : 0.0f;
+    curve.slope = (1.0f / (ratio > 1.0f ? ratio : 1.0f)) - 1.0f;
+    return curve;
+}
+
+AkUInt32 SidechainGainTable::getNumEntries(AkReal32 stepDb)
+{
+    if (!(stepDb > 0.0f))
+    {
+        return 0;
+    }
+    stepDb = stepDb < kMinStepDb ? kMinStepDb : (stepDb > kMaxStepDb ? kMaxStepDb : stepDb);
+    return (AkUInt32)ceilf((kMaxDb - kMinDb) / stepDb) + 1;
+}
+
+void SidechainGainTable::fillLevels(AkReal32* out_pLevels, AkUInt32 numEntries)
+{
+    const double step = (double)(kMaxDb - kMinDb) / (double)(numEntries - 1);
+    for (AkUInt32 i = 0; i < numEntries; ++i)
+    {
+        out_pLevels[i] = (AkReal32)pow(10.0, ((double)kMinDb + step * (double)i) / 20.0);
+    }
+    out_pLevels[numEntries] = out_pLevels[numEntries - 1];
+}
+
+void SidechainGainTable::init(const AkReal32* in_pLevels, AkReal32* in_pGains, AkUInt32 in_numEntries)
+{
+    numEntries = in_numEntries;
+    entriesPerDb = (AkReal32)(in_numEntries - 1) / (kMaxDb - kMinDb);
+    levels = in_pLevels;
+    gains = in_pGains;
+}
+
+void SidechainGainTable::build(const SidechainGainCurve& curve, void (*compute)(const AkReal32*, AkReal32*, AkUInt32, const SidechainGainCurve&))
+{
+    compute(levels, gains, numEntries + 1, curve);
+}
+
+SidechainGainKernel::Isa SidechainGainKernel::detectIsa()
+{
+#ifdef SC_GAINKERNEL_X86
+    static const Isa s_isa = []()
+    {
+        for (AkInt32 isa = Isa_Count - 1; isa > Isa_Scalar; --isa)
+        {
+            if (cpuSupports((Isa)isa))
+            {
+                return (Isa)isa;
+            }
+        }
+        return Isa_Scalar;
+    }();
+    return s_isa;
+#else
+    return Isa_Scalar;
+#endif
+}
+
+SidechainGainKernel::ComputeFunc SidechainGainKernel::getCompute(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa_Scalar: return computeScalar;
+#ifdef SC_GAINKERNEL_X86
+    case Isa_SSE2: return computeSSE2;
+    case Isa_AVX2: return computeAVX2;
+    case Isa_AVX512: return computeAVX512;
+#endif
+    default: return nullptr;
+    }
+}
+
+SidechainGainKernel::LookupFunc SidechainGainKernel::getLookup(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa_Scalar: return lookupScalar;
+#ifdef SC_GAINKERNEL_X86
+    case Isa_SSE2: return lookupSSE2;
+    case Isa_AVX2:
+    case Isa_AVX512: return lookupAVX2;
+#endif
+    default: return nullptr;
+    }
+}
+
+const char* SidechainGainKernel::getIsaName(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa_Scalar: return "scalar";
+    case Isa_SSE2: return "SSE2";
+    case Isa_AVX2: return "AVX2";
+    case Isa_AVX512: return "AVX-512";
+    default: return "unknown";
+    }
+}
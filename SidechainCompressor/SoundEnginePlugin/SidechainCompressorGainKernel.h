@@ -0,0 +1,87 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+// Static gain curve, with everything the kernel needs derived up front.
+struct SidechainGainCurve
+{
+    AkReal32 threshold = 0.0f;      // dB
+    AkReal32 halfKnee = 0.0f;       // dB
+    AkReal32 halfInvKnee = 0.0f;    // 1 / (2 * knee), 0 for a hard knee
+    AkReal32 slope = 0.0f;          // (1 / ratio) - 1, the gain change per dB above the knee
+
+    static SidechainGainCurve make(AkReal32 threshold, AkReal32 ratio, AkReal32 knee);
+};
+
+// The static curve sampled in the dB domain, kMinDb to kMaxDb, as linear gains, for curves
+// the kernel has no closed form for. Levels outside the range take the gain at its end.
+// Storage belongs to the owner: levels and gains each hold numEntries + 1 values, the last
+// repeated so interpolating at the top of the range never reads past it.
+struct SidechainGainTable
+{
+    static constexpr AkReal32 kMinDb = -120.0f;
+    static constexpr AkReal32 kMaxDb = 12.0f;
+    static constexpr AkReal32 kMinStepDb = 0.01f;
+    static constexpr AkReal32 kMaxStepDb = 6.0f;
+
+    AkUInt32 numEntries = 0;
+    AkReal32 entriesPerDb = 0.0f;
+    const AkReal32* levels = nullptr;   // Linear level of each entry, shared by tables of one resolution
+    AkReal32* gains = nullptr;
+
+    // Entries for a step in dB, clamped to kMinStepDb - kMaxStepDb; 0 for no table
+    static AkUInt32 getNumEntries(AkReal32 stepDb);
+
+    // Linear level of every entry of a table with numEntries, into out_pLevels (numEntries + 1)
+    static void fillLevels(AkReal32* out_pLevels, AkUInt32 numEntries);
+
+    void init(const AkReal32* in_pLevels, AkReal32* in_pGains, AkUInt32 in_numEntries);
+
+    // Samples curve at every entry with compute. Touches only this table's storage.
+    void build(const SidechainGainCurve& curve, void (*compute)(const AkReal32*, AkReal32*, AkUInt32, const SidechainGainCurve&));
+};
+
+// Block gain computer: detector level (linear) in, gain (linear) out.
+//
+//   x = 20 * log10(level)
+//   gain dB = slope * (d * d / (2 * knee) + max(x - threshold - knee / 2, 0)),  d = clamp(x - threshold + knee / 2, 0, knee)
+//
+// which is the soft-knee curve Execute used to evaluate with branches and powf. log2 and
+// exp2 are degree-5 polynomials; against a double-precision reference the gain is within
+// 2e-4 dB for levels from -240 dB to +24 dB (the SidechainCompressorBenchmark kernel
+// section reports the measured error per ISA). Levels below -240 dB are treated as -240 dB,
+// so silence gives unity gain instead of the NaN that log10(0) produced.
+class SidechainGainKernel
+{
+public:
+    enum Isa
+    {
+        Isa_Scalar = 0,
+        Isa_SSE2,
+        Isa_AVX2,
+        Isa_AVX512,
+        Isa_Count
+    };
+
+    typedef void (*ComputeFunc)(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainCurve& in_curve);
+
+    // Same, through a table: the level's dB position is interpolated linearly between the two
+    // nearest entries, without branches. The cost does not depend on the curve.
+    typedef void (*LookupFunc)(const AkReal32* in_pLevel, AkReal32* out_pGain, AkUInt32 in_uFrames, const SidechainGainTable& in_table);
+
+    // Best variant this CPU and OS can run. Detected once, cached.
+    static Isa detectIsa();
+
+    // Variant for isa, or nullptr when it is not compiled for this platform.
+    static ComputeFunc getCompute(Isa isa);
+
+    static ComputeFunc getBestCompute() { return getCompute(detectIsa()); }
+
+    // Lookup variant for isa, or nullptr when it is not compiled for this platform. AVX-512
+    // uses the AVX2 lookup: the work is in the gathers, which are no wider.
+    static LookupFunc getLookup(Isa isa);
+
+    static LookupFunc getBestLookup() { return getLookup(detectIsa()); }
+
+    static const char* getIsaName(Isa isa);
+};
@@ -0,0 +1,99 @@
+#include "SidechainCompressorKeyFilter.h"
+#include "SidechainCompressorDetector.h"
+
+AKRESULT SidechainKeyFilter::init(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_maxChannels)
+{
+    term();
+
+    allocator = in_pAllocator;
+    maxChannels = AkMax(in_maxChannels, (AkUInt32)1);
+    lanes = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(AkReal32) * kChunk * SidechainBiquadBank::getLaneCount(maxChannels), SidechainDetector::kAlignment);
+    if (lanes == nullptr || bank.init(allocator, maxChannels) != AK_Success)
+    {
+        term();
+        return AK_InsufficientMemory;
+    }
+    return AK_Success;
+}
+
+void SidechainKeyFilter::term()
+{
+    if (lanes)
+    {
+        AK_PLUGIN_FREE_ALIGN(allocator, lanes);
+        lanes = nullptr;
+    }
+    bank.term();
+}
+
+void SidechainKeyFilter::setFilter(const Settings& in_settings, AkUInt32 in_sampleRate)
+{
+    const bool bNewType = in_settings.type != settings.type;
+    settings = in_settings;
+    sampleRate = AkMax(in_sampleRate, (AkUInt32)1);
+    if (bNewType)
+    {
+        bank.reset();
+    }
+    updateSections();
+}
+
+void SidechainKeyFilter::updateSections()
+{
+    const double rate = (double)sampleRate;
+    const double frequency = AkMin(AkMax((double)settings.frequency, (double)kMinFrequency), AkMin((double)kMaxFrequency, rate * 0.45));
+    const double q = AkMin(AkMax((double)settings.q, (double)kMinQ), (double)kMaxQ);
+    const double gainDb = AkMin(AkMax((double)settings.gainDb, (double)-kMaxGainDb), (double)kMaxGainDb);
+    switch (settings.type)
+    {
+    case Type_HighPass: section = SidechainBiquad::highPass(frequency, rate, q); break;
+    case Type_BandPass: section = SidechainBiquad::bandPass(frequency, rate, q); break;
+    case Type_LowShelf: section = SidechainBiquad::lowShelf(frequency, rate, gainDb); break;
+    case Type_HighShelf: section = SidechainBiquad::highShelf(frequency, rate, gainDb); break;
+    default: section = SidechainBiquad(); break;
+    }
+
+    for (AkUInt32 lane = 0; lane < bank.getNumUsed(); ++lane)
+    {
+        bank.setSection(lane, 0, section);
+    }
+}
+
+void SidechainKeyFilter::process(AkReal32* io_pFrames, AkUInt32 numChannels, AkUInt32 in_uNumFrames)
+{
+    if (!isActive() || lanes == nullptr)
+    {
+        return;
+    }
+
+    numChannels = AkMin(numChannels, maxChannels);
+    if (numChannels != bank.getNumUsed())
+    {
+        bank.setLayout(numChannels, 1);
+        for (AkUInt32 channel = 0; channel < numChannels; ++channel)
+        {
+            bank.setInput(channel, channel);
+            bank.setSection(channel, 0, section);
+        }
+    }
+    if (numChannels == 0)
+    {
+        return;
+    }
+
+    // A chunk at a time through the lanes, then back over the input
+    const AkUInt32 uLanes = bank.getNumLanes();
+    for (AkUInt32 start = 0; start < in_uNumFrames; start += kChunk)
+    {
+        const AkUInt32 length = AkMin(kChunk, in_uNumFrames - start);
+        AkReal32* pFrames = io_pFrames + (size_t)start * numChannels;
+        bank.process(pFrames, numChannels, lanes, length);
+        for (AkUInt32 frame = 0; frame < length; ++frame)
+        {
+            for (AkUInt32 channel = 0; channel < numChannels; ++channel)
+            {
+                pFrames[(size_t)frame * numChannels + channel] = lanes[(size_t)frame * uLanes + channel];
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+#include "SidechainCompressorBiquad.h"
+
+// Key filter for the summed sidechain: shapes what the detector hears, not what is ducked, so
+// music rumble can be kept from pumping the bus while speech still drives it.
+//
+// One 2nd-order section per channel, every channel a lane of a SidechainBiquadBank. It runs
+// once per bus per audio frame, on the sum, so its cost does not grow with the voices.
+class SidechainKeyFilter
+{
+public:
+    enum Type
+    {
+        Type_Off = 0,
+        Type_HighPass = 1,
+        Type_BandPass = 2,
+        Type_LowShelf = 3,
+        Type_HighShelf = 4
+    };
+
+    static constexpr AkReal32 kMinFrequency = 20.0f;
+    static constexpr AkReal32 kMaxFrequency = 20000.0f;
+    static constexpr AkReal32 kMinQ = 0.1f;
+    static constexpr AkReal32 kMaxQ = 10.0f;
+    static constexpr AkReal32 kMaxGainDb = 24.0f;      // Shelves, either way
+
+    struct Settings
+    {
+        Type type = Type_Off;
+        AkReal32 frequency = 200.0f;    // Hz: corner, centre or shelf midpoint
+        AkReal32 q = 0.707f;            // High and band pass
+        AkReal32 gainDb = -12.0f;       // Shelves
+
+        bool operator==(const Settings& other) const
+        {
+            return type == other.type && frequency == other.frequency && q == other.q && gainDb == other.gainDb;
+        }
+        bool operator!=(const Settings& other) const { return !(*this == other); }
+    };
+
+    SidechainKeyFilter() = default;
+    SidechainKeyFilter(const SidechainKeyFilter&) = delete;
+    SidechainKeyFilter& operator=(const SidechainKeyFilter&) = delete;
+    ~SidechainKeyFilter() { term(); }
+
+    // Allocates the filter state and a chunk of scratch for up to maxChannels channels.
+    AKRESULT init(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 maxChannels);
+    void term();
+
+    // Frequency clamped to kMinFrequency - kMaxFrequency and below Nyquist, Q and gain to their
+    // ranges. A new type restarts from silence; new values only replace the coefficients.
+    void setFilter(const Settings& in_settings, AkUInt32 sampleRate);
+
+    // Filters in_uNumFrames frame-major frames of numChannels samples in place. A new channel
+    // count restarts from silence. Does nothing while the filter is off.
+    void process(AkReal32* io_pFrames, AkUInt32 numChannels, AkUInt32 in_uNumFrames);
+
+    bool isActive() const { return settings.type != Type_Off; }
+    const Settings& getSettings() const { return settings; }
+
+private:
+    static const AkUInt32 kChunk = 256;
+
+    void updateSections();
+
+    AK::IAkPluginMemAlloc* allocator = nullptr;
+    AkUInt32 maxChannels = 0;
+    AkUInt32 sampleRate = 48000;
+    Settings settings;
+    SidechainBiquad section;                    // Designed from settings
+
+    SidechainBiquadBank bank;                   // Lane c: channel c
+    AkReal32* lanes = nullptr;                  // kChunk frames of the bank's lanes
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <atomic>
+
+// Metering is a development aid: the ring, the per-block statistics and the consumer API
+// are all compiled out of AK_OPTIMIZED builds.
+#ifndef AK_OPTIMIZED
+
+// What one instance did during one Execute call, across all of its channels.
+// Gains are linear (1 = no reduction); convert on the consumer side.
+struct SidechainMeterBlock
+{
+    AkUInt32 uBlock;            // Execute and TimeSkip calls since Init, so a consumer can see what it missed
+    AkUInt32 uFrames;
+    AkReal32 fMinGain;          // Deepest reduction in the block
+    AkReal32 fMaxGain;          // Lightest reduction in the block
+    AkReal32 fMeanGain;         // Mean over frames and channels
+    AkReal32 fDetector;         // Loudest sidechain level the channels were ducked by, linear
+};
+
+// Wait-free single-producer single-consumer ring of fixed capacity (a power of two).
+// The producer is the audio thread and never waits: when the consumer falls behind, new
+// entries are dropped and counted rather than overwriting what the consumer may be reading.
+template <typename T, AkUInt32 Capacity>
+class SidechainSpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side
+    bool push(const T& in_item)
+    {
+        const AkUInt32 head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[head & (Capacity - 1)] = in_item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: copies out up to in_uMaxItems entries, oldest first; returns how many
+    AkUInt32 drain(T* out_pItems, AkUInt32 in_uMaxItems)
+    {
+        AkUInt32 tail = m_tail.load(std::memory_order_relaxed);
+        const AkUInt32 head = m_head.load(std::memory_order_acquire);
+        AkUInt32 count = 0;
+        while (tail != head && count < in_uMaxItems)
+        {
+            out_pItems[count++] = m_items[tail & (Capacity - 1)];
+            ++tail;
+        }
+        m_tail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    // Entries the producer could not push since the ring was created
+    AkUInt32 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Producer and consumer indices a cache line apart. Padded rather than alignas, since
+    // plug-in objects come from the sound engine allocator with its default alignment.
+    std::atomic<AkUInt32> m_head{ 0 };
+    std::atomic<AkUInt32> m_dropped{ 0 };
+    AkUInt8 m_producerPad[64 - 2 * sizeof(std::atomic<AkUInt32>)];
+    std::atomic<AkUInt32> m_tail{ 0 };
+    AkUInt8 m_consumerPad[64 - sizeof(std::atomic<AkUInt32>)];
+    T m_items[Capacity];
+};
+
+#endif // !AK_OPTIMIZED
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include <type_traits>
+
+// Monitor packet posted by SidechainCompressorFX to the authoring tool.
+//
+// Plain data with fixed-width fields and no pointers, so it survives the trip from the
+// sound engine to Wwise Authoring (possibly another process or machine) as raw bytes.
+// Levels and gains are linear; all formatting happens on the authoring side.
+//
+// Readers must check uVersion and uSize: fields are only ever appended, so a newer packet
+// can be read as an older version by ignoring the bytes past the fields it knows.
+struct SidechainMonitorPacket
+{
+    static const AkUInt16 kVersion = 2;
+    static const AkUInt32 kMaxChannels = 16;
+
+    AkUInt16 uVersion;
+    AkUInt16 uSize;                             // sizeof(SidechainMonitorPacket) of the writer
+    AkUInt16 uNumChannels;                      // Channels of the instance, capped to kMaxChannels
+    AkUInt16 uNumInstances;                     // Instances ranked in the groups this one listens to
+    AkReal32 fPercentile;                       // This instance's rank as a fraction, 1 = ducked hardest
+    AkReal32 fRatio;                            // Ratio the percentile gave, 1 to Max Ratio
+    AkReal32 fSidechainRMS[kMaxChannels];       // Sidechain level each channel is ducked by, linear
+    AkReal32 fGain[kMaxChannels];               // Gain applied to each channel at the end of the block, linear
+    AkUInt32 uLatencyFrames;                    // Lookahead delay of the output (version 2)
+
+    // The packet at in_pData, or nullptr when it is too short or of an unknown version
+    static const SidechainMonitorPacket* read(const void* in_pData, AkUInt32 in_uDataSize)
+    {
+        if (in_pData == nullptr || in_uDataSize < sizeof(SidechainMonitorPacket))
+            return nullptr;
+
+        const SidechainMonitorPacket* pPacket = (const SidechainMonitorPacket*)in_pData;
+        if (pPacket->uVersion < kVersion || pPacket->uSize < sizeof(SidechainMonitorPacket) || pPacket->uSize > in_uDataSize)
+            return nullptr;
+        return pPacket;
+    }
+};
+
+static_assert(std::is_trivially_copyable<SidechainMonitorPacket>::value, "SidechainMonitorPacket is sent as raw bytes");
+static_assert(sizeof(SidechainMonitorPacket) == 20 + 2 * 4 * SidechainMonitorPacket::kMaxChannels, "SidechainMonitorPacket layout changed; bump kVersion");
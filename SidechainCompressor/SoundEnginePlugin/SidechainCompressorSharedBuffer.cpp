@@ -1,241 +1,958 @@
 #include "SidechainCompressorSharedBuffer.h"
+#include "../SidechainCompressorConfig.h"
 
-SidechainCompressorSharedBuffer::SidechainCompressorSharedBuffer(std::map<AkUniqueID, AkReal32>& myPriorityMap)
-    : PriorityMap(myPriorityMap)
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// SSE2 is always there on x64; compilers will not vectorize the clamped conversion on their own
+#define SC_SHAREDBUFFER_SSE2
+#include <emmintrin.h>
+#endif
+
+AkReal32 SidechainRanks::getPercentile(AkReal32 PriorityRank) const
 {
+    // avoids dividing by zero when every instance has the same rank
+    if (numRanked == 0 || minRank == maxRank)
+    {
+        return numRanked == 0 ? 0.0f : 1 - (1.0f / numRanked);
+    }
+
+    // The rank may have moved since the snapshot was taken
+    AkReal32 percentile = 1 - ((PriorityRank - minRank) / (maxRank - minRank));
+    return AkMin(AkMax(percentile, 0.0f), 1.0f);
 }
 
-SidechainCompressorSharedBuffer::~SidechainCompressorSharedBuffer()
+void SidechainSnapshot::mergeLoudest(const SidechainSnapshot& other)
 {
+    numChannels = AkMax(numChannels, other.numChannels);
+    numBands = AkMax(numBands, other.numBands);
+    for (AkUInt32 lane = 0; lane < kNumLanes; ++lane)
+    {
+        if (other.newbuffer_mRMS[lane] > newbuffer_mRMS[lane])
+        {
+            lastbuffer_mRMS[lane] = other.lastbuffer_mRMS[lane];
+            newbuffer_mRMS[lane] = other.newbuffer_mRMS[lane];
+        }
+    }
 }
 
+std::shared_ptr<SidechainCompressorSharedBuffer> GlobalManager::acquireBuffer(AK::IAkGlobalPluginContext* in_pGlobalContext, AkUInt32 in_uGroup)
+{
+    if (in_uGroup >= kMaxGroups)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(enginesMutex());
+    std::unique_ptr<Engine>& engine = engines()[in_pGlobalContext];
+    if (!engine)
+    {
+        engine.reset(new Engine);
+    }
+
+    if (engine->refCounts[in_uGroup] == 0)
+    {
+        // The bus and everything it holds come from the engine's allocator
+        AK::IAkPluginMemAlloc* pAllocator = in_pGlobalContext->GetAllocator();
+        SidechainCompressorSharedBuffer* pBuffer = AK_PLUGIN_NEW(pAllocator, SidechainCompressorSharedBuffer(pAllocator, in_pGlobalContext->GetSampleRate()));
+        std::shared_ptr<SidechainCompressorSharedBuffer> buffer;
+        if (pBuffer)
+        {
+            buffer.reset(pBuffer, [pAllocator](SidechainCompressorSharedBuffer* p) { AK_PLUGIN_DELETE(pAllocator, p); });
+        }
+        if (!buffer || buffer->Init() != AK_Success)
+        {
+            if (engine->totalRefCount == 0)
+            {
+                engines().erase(in_pGlobalContext);
+            }
+            return nullptr;
+        }
 
-void SidechainCompressorSharedBuffer::Init()
-{  
+        engine->buffers[in_uGroup] = buffer;
+        engine->live[in_uGroup].store(pBuffer, std::memory_order_release);
+    }
+    ++engine->refCounts[in_uGroup];
+    if (engine->totalRefCount++ == 0)
+    {
+        in_pGlobalContext->RegisterGlobalCallback(AkPluginTypeEffect, SidechainCompressorConfig::CompanyID, SidechainCompressorConfig::PluginID,
+            GlobalCallback, kCallbackLocations, engine.get());
+    }
+    return engine->buffers[in_uGroup];
 }
 
-void SidechainCompressorSharedBuffer::resizeSharedBuffer(AkAudioBuffer* sourceBuffer)
+void GlobalManager::releaseBuffer(AK::IAkGlobalPluginContext* in_pGlobalContext, AkUInt32 in_uGroup)
 {
-    std::lock_guard<std::mutex> lock(mtx);
+    if (in_uGroup >= kMaxGroups)
+    {
+        return;
+    }
 
-    if (sourceBuffer->NumChannels() != sharedBuffer.size() || sourceBuffer->uValidFrames != sharedBuffer[0].size())
+    std::lock_guard<std::mutex> lock(enginesMutex());
+    auto it = engines().find(in_pGlobalContext);
+    if (it == engines().end() || it->second->refCounts[in_uGroup] == 0)
     {
-        sharedBuffer.resize(sourceBuffer->NumChannels(), std::vector<AkReal32>(sourceBuffer->uValidFrames));
+        return;
+    }
+
+    Engine& engine = *it->second;
+    if (--engine.refCounts[in_uGroup] == 0)
+    {
+        engine.live[in_uGroup].store(nullptr, std::memory_order_release);
+        engine.buffers[in_uGroup].reset();
+    }
+    if (--engine.totalRefCount == 0)
+    {
+        in_pGlobalContext->UnregisterGlobalCallback(GlobalCallback, kCallbackLocations);
+        engines().erase(it);
     }
 }
 
+std::mutex& GlobalManager::enginesMutex()
+{
+    static std::mutex s_mutex;
+    return s_mutex;
+}
 
+std::map<AK::IAkGlobalPluginContext*, std::unique_ptr<GlobalManager::Engine>>& GlobalManager::engines()
+{
+    static std::map<AK::IAkGlobalPluginContext*, std::unique_ptr<Engine>> s_engines;
+    return s_engines;
+}
 
-void SidechainCompressorSharedBuffer::AddToSharedBuffer(AkAudioBuffer* sourceBuffer)
+void AKSOUNDENGINE_CALL GlobalManager::GlobalCallback(AK::IAkGlobalPluginContext* in_pContext, AkGlobalCallbackLocation in_eLocation, void* in_pCookie)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    AkUInt32 numChannels = sharedBuffer.size();
-    AkUInt32 numFrames = sharedBuffer[0].size();
+    if (in_eLocation == AkGlobalCallbackLocation_BeginRender)
+    {
+        // Nothing executes during BeginRender, so the buses are ours for the reduction.
+        // Each group only reduces its own slots.
+        Engine* engine = (Engine*)in_pCookie;
+        for (AkUInt32 group = 0; group < kMaxGroups; ++group)
+        {
+            if (SidechainCompressorSharedBuffer* buffer = engine->live[group].load(std::memory_order_acquire))
+            {
+                buffer->calculatedmRMS();
+            }
+        }
+    }
+    else if (in_eLocation == AkGlobalCallbackLocation_Term)
+    {
+        // The engine is going away; instances still holding a bus keep it alive
+        std::lock_guard<std::mutex> lock(enginesMutex());
+        engines().erase(in_pContext);
+    }
+}
 
+SidechainCompressorSharedBuffer::SidechainCompressorSharedBuffer(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_sampleRate)
+    : allocator(in_pAllocator)
+    , sampleRate(in_sampleRate)
+    , detectorWindowMs(SidechainDetector::kDefaultWindowMs)
+    , detectorMode(SidechainDetector::Mode_SlidingWindow)
+    , keyType(SidechainKeyFilter::Type_Off)
+    , keyFrequency(SidechainKeyFilter::Settings().frequency)
+    , keyQ(SidechainKeyFilter::Settings().q)
+    , keyGainDb(SidechainKeyFilter::Settings().gainDb)
+{
+    for (AkUInt32 i = 0; i + 1 < SidechainCrossover::kMaxBands; ++i)
+    {
+        requestedFrequencies[i].store(SidechainCrossover::kDefaultFrequencies[i], std::memory_order_relaxed);
+    }
+}
 
-    for (AkUInt32 channel = 0; channel < numChannels; channel++)
+SidechainCompressorSharedBuffer::~SidechainCompressorSharedBuffer()
+{
+    for (SlotChunk* chunk : chunks)
     {
-        AkUInt32 frame = 0;
-        numFrames = AkMin(sharedBuffer[channel].size(), sourceBuffer->uValidFrames);
-        auto& thisChannel = sharedBuffer[channel];
-        AkReal32* AK_RESTRICT sourceChannel = (AkReal32 * AK_RESTRICT)sourceBuffer->GetChannel(channel);
-        while (frame < numFrames)
+        if (chunk == nullptr)
+        {
+            break;
+        }
+        for (Slot& slot : chunk->slots)
+        {
+            if (slot.block)
             {
-                AkReal32 &thisSample = thisChannel[frame];
-
-                thisSample += sourceBuffer->GetChannel(channel)[frame];
-                
-                frame++;
+                AK_PLUGIN_FREE_ALIGN(allocator, slot.block);
             }
+        }
+        AK_PLUGIN_DELETE(allocator, chunk);
     }
-
-    numBuffersAdded++;
-   
+    for (Partial& partial : partials)
+    {
+        if (partial.block)
+        {
+            AK_PLUGIN_FREE_ALIGN(allocator, partial.block);
+        }
+    }
+    if (partialEnergy)
+    {
+        AK_PLUGIN_FREE_ALIGN(allocator, partialEnergy);
+    }
+    if (reduced)
+    {
+        AK_PLUGIN_FREE_ALIGN(allocator, reduced);
+    }
+    if (bandLanes)
+    {
+        AK_PLUGIN_FREE_ALIGN(allocator, bandLanes);
+    }
+    detector.term();
+    keyFilter.term();
+    bandDetector.term();
+    crossover.term();
 }
 
 
+AKRESULT SidechainCompressorSharedBuffer::Init()
+{
+    partialEnergy = (AkUInt64*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(AkUInt64) * kMaxWorkers * kMaxChannels, kAlignment);
+    if (partialEnergy == nullptr)
+    {
+        return AK_InsufficientMemory;
+    }
+    memset(partialEnergy, 0, sizeof(AkUInt64) * kMaxWorkers * kMaxChannels);
+    for (AkUInt32 worker = 0; worker < kMaxWorkers; ++worker)
+    {
+        partials[worker].energy = partialEnergy + (size_t)worker * kMaxChannels;
+    }
+
+    if (keyFilter.init(allocator, kMaxChannels) != AK_Success)
+    {
+        return AK_InsufficientMemory;
+    }
+    // No channels until a feeding slot arrives
+    return detector.init(allocator, 0, sampleRate);
+}
 
-void SidechainCompressorSharedBuffer::AddToPriorityMap(AkUniqueID objectID, AkReal32 PriorityRank)
+AkInt32 SidechainCompressorSharedBuffer::acquireSlot(AkUInt32 numChannels, AkUInt32 maxFrames, SidechainContribution contribution)
 {
     std::lock_guard<std::mutex> lock(mtx);
 
-   
-    PriorityMap.insert_or_assign(objectID, PriorityRank);
-  
+    numChannels = AkMin(numChannels, kMaxChannels);
+    maxFrames = AkMin(maxFrames, kMaxFrames);
+    const AkUInt32 channelStride = alignFrames(maxFrames);
+    const size_t sampleSize = (size_t)numChannels * channelStride;
+    const size_t blockSize = sampleSize + 2 * numChannels;     // Then one 64-bit energy per channel
+
+    // Released slots first, so the table stays as short as the most instances ever live. A
+    // new chunk is published before the high-water mark that lets readers reach it.
+    AkInt32 index;
+    if (numFreeSlots > 0)
+    {
+        index = getFreeSlot(numFreeSlots - 1);
+    }
+    else if (slotHighWater.load(std::memory_order_relaxed) < kMaxInstances)
+    {
+        index = (AkInt32)slotHighWater.load(std::memory_order_relaxed);
+        if (chunks[index / kChunkSlots] == nullptr)
+        {
+            chunks[index / kChunkSlots] = AK_PLUGIN_NEW(allocator, SlotChunk);
+            if (chunks[index / kChunkSlots] == nullptr)
+            {
+                return kInvalidSlot;
+            }
+        }
+    }
+    else
+    {
+        return kInvalidSlot;
+    }
+
+    if (growPartials(numChannels, channelStride) != AK_Success || growReduction(numChannels, channelStride) != AK_Success)
+    {
+        return kInvalidSlot;
+    }
+
+    // Storage is kept when a slot is released, only grow it.
+    Slot& slot = getSlot(index);
+    if (slot.blockSize < blockSize)
+    {
+        AkReal32* block = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(AkReal32) * blockSize, kAlignment);
+        if (block == nullptr)
+        {
+            return kInvalidSlot;
+        }
+        if (slot.block)
+        {
+            AK_PLUGIN_FREE_ALIGN(allocator, slot.block);
+        }
+        slot.block = block;
+        slot.blockSize = blockSize;
+    }
+    if (blockSize > 0)
+    {
+        memset(slot.block, 0, sizeof(AkReal32) * blockSize);
+    }
+    slot.numChannels = numChannels;
+    slot.maxFrames = maxFrames;
+    slot.channelStride = channelStride;
+    slot.numFrames = 0;
+    slot.energyFrames = 0;
+    slot.energy = (AkUInt64*)(slot.block + sampleSize);
+    slot.contribution = contribution;
+    slot.epoch = ~0u;
+    if (numChannels > channelHighWater.load(std::memory_order_relaxed))
+    {
+        channelHighWater.store(numChannels, std::memory_order_release);
+    }
+    slot.active = true;
 
+    if (numFreeSlots > 0)
+    {
+        --numFreeSlots;
+    }
+    else
+    {
+        slotHighWater.store(index + 1, std::memory_order_release);
+    }
+    return index;
 }
 
-void SidechainCompressorSharedBuffer::updatePriorityMap(AkUniqueID objectID, AkReal32 PriorityRank)
+void SidechainCompressorSharedBuffer::releaseSlot(AkInt32 slot)
 {
+    if (slot == kInvalidSlot)
+    {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mtx);
-    std::map<AkUniqueID, AkReal32>& m = PriorityMap;
-    if (m.find(objectID) != m.end())
+    if (getSlot(slot).active)
     {
-        m.insert_or_assign(objectID, PriorityRank);
+        getSlot(slot).active = false;
+        getRank(slot).store(NAN, std::memory_order_relaxed);
+        ranksChanged.store(true, std::memory_order_release);
+        getFreeSlot(numFreeSlots++) = slot;
     }
 }
 
-void SidechainCompressorSharedBuffer::removeFromPriorityMap(AkUniqueID objectID)
+AKRESULT SidechainCompressorSharedBuffer::growPartials(AkUInt32 numChannels, AkUInt32 stride)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    std::map<AkUniqueID, AkReal32>& m = PriorityMap;
+    if (numChannels <= partialChannels && stride <= partialStride)
+    {
+        return AK_Success;
+    }
 
-    if (m.find(objectID) != m.end())
+    // Every new block first, so a failure leaves the partials as they were
+    const AkUInt32 newChannels = AkMax(numChannels, partialChannels);
+    const AkUInt32 newStride = AkMax(stride, partialStride);
+    const size_t newSize = sizeof(AkReal64) * newChannels * newStride;
+    AkReal64* blocks[kMaxWorkers] = {};
+    for (AkUInt32 worker = 0; worker < kMaxWorkers; ++worker)
     {
-        m.erase(objectID);
+        blocks[worker] = (AkReal64*)AK_PLUGIN_ALLOC_ALIGN(allocator, newSize, kAlignment);
+        if (blocks[worker] == nullptr)
+        {
+            for (AkUInt32 allocated = 0; allocated < worker; ++allocated)
+            {
+                AK_PLUGIN_FREE_ALIGN(allocator, blocks[allocated]);
+            }
+            return AK_InsufficientMemory;
+        }
+        memset(blocks[worker], 0, newSize);
     }
+
+    // Instances may be contributing meanwhile: each partial is held while its sums move
+    for (AkUInt32 worker = 0; worker < kMaxWorkers; ++worker)
+    {
+        Partial& partial = partials[worker];
+        while (partial.busy.exchange(true, std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        for (AkUInt32 channel = 0; channel < partial.channels; ++channel)
+        {
+            memcpy(blocks[worker] + (size_t)channel * newStride, partial.block + (size_t)channel * partial.stride, sizeof(AkReal64) * partial.numFrames);
+        }
+        if (partial.block)
+        {
+            AK_PLUGIN_FREE_ALIGN(allocator, partial.block);
+        }
+        partial.block = blocks[worker];
+        partial.channels = newChannels;
+        partial.stride = newStride;
+        partial.busy.store(false, std::memory_order_release);
+    }
+    partialChannels = newChannels;
+    partialStride = newStride;
+    return AK_Success;
 }
 
-float SidechainCompressorSharedBuffer::getPercentile(AkUniqueID objectID)
+AKRESULT SidechainCompressorSharedBuffer::growReduction(AkUInt32 numChannels, AkUInt32 stride)
 {
-    std::shared_lock<std::shared_mutex> lock(s_mtx);
+    if (numChannels <= reducedChannels && stride <= reducedFrames)
+    {
+        return AK_Success;
+    }
 
-    using pairtype = std::pair<AkUniqueID, AkReal32>;
+    // The block first, so a failure leaves the reduction as it was
+    const AkUInt32 newChannels = AkMax(numChannels, reducedChannels);
+    const AkUInt32 newFrames = AkMax(stride, reducedFrames);
+    const size_t newSize = sizeof(AkReal32) * newChannels * newFrames;
+    AkReal32* block = nullptr;
+    if (newSize > 0)
+    {
+        block = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(allocator, newSize, kAlignment);
+        if (block == nullptr)
+        {
+            return AK_InsufficientMemory;
+        }
+        memset(block, 0, newSize);
+    }
+
+    // The render callback may be reducing meanwhile: it waits while the detector and the band
+    // split widen, once per wider slot. The detector keeps every level it has.
+    while (reducing.exchange(true, std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+    if (reduced)
+    {
+        AK_PLUGIN_FREE_ALIGN(allocator, reduced);
+    }
+    reduced = block;
+    AKRESULT result = detector.grow(newChannels);
+    if (result == AK_Success && newChannels > bandChannels && bandCapacity.load(std::memory_order_relaxed) > 0)
+    {
+        result = allocateBands(bandCapacity.load(std::memory_order_relaxed), newChannels);
+    }
+    reducing.store(false, std::memory_order_release);
 
-    // Find Minimum
-    pairtype min = *min_element(PriorityMap.begin(), PriorityMap.end(),
-        [](const pairtype& p1, const pairtype& p2)
-        { return p1.second < p2.second; });
-    AkReal32 minValue = min.second;
+    if (result == AK_Success)
+    {
+        reducedChannels = newChannels;
+        reducedFrames = newFrames;
+    }
+    return result;
+}
 
-    // Find Maximum
-    pairtype max = *max_element(PriorityMap.begin(), PriorityMap.end(),
-        [](const pairtype& p1, const pairtype& p2)
-        { return p1.second < p2.second; });
-    AkReal32 maxValue = max.second;
+SidechainCompressorSharedBuffer::Partial& SidechainCompressorSharedBuffer::claimPartial(AkUInt32 epoch)
+{
+    // Each rendering thread gets a home partial the first time it contributes to any bus
+    static std::atomic<AkUInt32> s_numWorkers(0);
+    static thread_local const AkUInt32 t_home = s_numWorkers.fetch_add(1, std::memory_order_relaxed) % kMaxWorkers;
 
+    for (AkUInt32 worker = t_home;; worker = (worker + 1) % kMaxWorkers)
+    {
+        Partial& partial = partials[worker];
+        if (!partial.busy.load(std::memory_order_relaxed) && !partial.busy.exchange(true, std::memory_order_acquire))
+        {
+            // Sums left from an earlier epoch are cleared by the first contributor of this one
+            if (partial.epoch != epoch)
+            {
+                for (AkUInt32 channel = 0; channel < partial.channels; ++channel)
+                {
+                    memset(partial.block + (size_t)channel * partial.stride, 0, sizeof(AkReal64) * partial.numFrames);
+                }
+                if (partial.energyFrames > 0)
+                {
+                    memset(partial.energy, 0, sizeof(AkUInt64) * kMaxChannels);
+                }
+                partial.numFrames = 0;
+                partial.energyFrames = 0;
+                partial.epoch = epoch;
+            }
+            return partial;
+        }
+    }
+}
 
-    // handles error and avoids dividing by zero
-     if (PriorityMap.find(objectID) == PriorityMap.end() || minValue == maxValue)
-     {
-         return 1 - (1.0 / PriorityMap.size());
-     }
-         
-     // Gives Percentile
-     return 1 - ((PriorityMap[objectID] - minValue) / (maxValue - minValue));
+void SidechainCompressorSharedBuffer::addToPartial(AkUInt32 epoch, const Slot& slot, AkUInt32 start, AkUInt32 numFrames)
+{
+    Partial& partial = claimPartial(epoch);
+    const AkUInt32 channels = AkMin(slot.numChannels, partial.channels);
 
+    for (AkUInt32 channel = 0; channel < channels; ++channel)
+    {
+        const AkReal32* AK_RESTRICT pSource = slot.block + (size_t)channel * slot.channelStride + start;
+        AkReal64* AK_RESTRICT pSum = partial.block + (size_t)channel * partial.stride + start;
+        AkUInt32 frame = 0;
+#ifdef SC_SHAREDBUFFER_SSE2
+        const __m128 scale = _mm_set1_ps(kFixedScale);
+        const __m128 lowest = _mm_set1_ps(-kFixedMax * kFixedScale);
+        const __m128 highest = _mm_set1_ps(kFixedMax * kFixedScale);
+        for (; frame + 4 <= numFrames; frame += 4)
+        {
+            const __m128 sample = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pSource + frame), scale), lowest), highest);
+            const __m128i quantized = _mm_cvttps_epi32(sample);
+            _mm_storeu_pd(pSum + frame, _mm_add_pd(_mm_loadu_pd(pSum + frame), _mm_cvtepi32_pd(quantized)));
+            _mm_storeu_pd(pSum + frame + 2, _mm_add_pd(_mm_loadu_pd(pSum + frame + 2), _mm_cvtepi32_pd(_mm_shuffle_epi32(quantized, _MM_SHUFFLE(1, 0, 3, 2)))));
+        }
+#endif
+        for (; frame < numFrames; ++frame)
+        {
+            AkReal32 sample = pSource[frame] * kFixedScale;
+            sample = sample > -kFixedMax * kFixedScale ? sample : -kFixedMax * kFixedScale;
+            sample = sample < kFixedMax * kFixedScale ? sample : kFixedMax * kFixedScale;
+            pSum[frame] += (AkReal64)(AkInt32)sample;
+        }
+    }
+    partial.numFrames = AkMax(partial.numFrames, start + numFrames);
+    partial.busy.store(false, std::memory_order_release);
 }
 
+void SidechainCompressorSharedBuffer::addEnergyToPartial(AkUInt32 epoch, const Slot& slot, const AkUInt64* in_pEnergy, AkUInt32 numFrames)
+{
+    Partial& partial = claimPartial(epoch);
+    for (AkUInt32 channel = 0; channel < slot.numChannels; ++channel)
+    {
+        partial.energy[channel] += in_pEnergy[channel];
+    }
+    partial.energyFrames = AkMax(partial.energyFrames, numFrames);
+    partial.busy.store(false, std::memory_order_release);
+}
 
-void SidechainCompressorSharedBuffer::populateRMSTable(AkUInt32 frames10ms)
+void SidechainCompressorSharedBuffer::openSlot(Slot& slot, AkUInt32 epoch)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    std::vector<AkReal32> currentRMS = { lastbuffer_mRMS[0], lastbuffer_mRMS[1] };
-    AkUInt16 numChannels = sharedBuffer.size();
-    AkUInt32 numFrames = sharedBuffer[0].size();
+    if (slot.epoch == epoch)
+    {
+        return;
+    }
+    if (slot.energyFrames > 0)
+    {
+        memset(slot.energy, 0, sizeof(AkUInt64) * slot.numChannels);
+    }
+    slot.numFrames = 0;
+    slot.energyFrames = 0;
+    slot.epoch = epoch;
+}
 
+void SidechainCompressorSharedBuffer::addEnergy(Slot& slot, AkUInt32 epoch, AkAudioBuffer* sourceBuffer, AkUInt32 offset, AkUInt32 numFrames, AkUInt32 position)
+{
+    openSlot(slot, epoch);
 
-    if (RMSTable.empty() && !sharedBuffer.empty())
+    // Each channel's sum of squares, in fixed point so the bus sums it exactly. Skipped frames
+    // and channels the source does not have add nothing.
+    AkUInt64 added[kMaxChannels] = {};
+    const AkUInt32 sourceChannels = AkMin(slot.numChannels, (AkUInt32)sourceBuffer->NumChannels());
+    for (AkUInt32 channel = 0; channel < sourceChannels; ++channel)
     {
-        if (RMSTable.size() < numChannels)
+        const AkReal32* AK_RESTRICT pSource = sourceBuffer->GetChannel(channel) + offset;
+        AkUInt32 frame = 0;
+        AkReal32 sum = 0.0f;
+#ifdef SC_SHAREDBUFFER_SSE2
+        __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+        for (; frame + 8 <= numFrames; frame += 8)
         {
-            RMSTable.resize(numChannels);
+            const __m128 x0 = _mm_loadu_ps(pSource + frame);
+            const __m128 x1 = _mm_loadu_ps(pSource + frame + 4);
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(x0, x0));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(x1, x1));
         }
-        
-        for (AkUInt16 channel = 0; channel < numChannels; ++channel)
+        AkReal32 partialSums[4];
+        _mm_storeu_ps(partialSums, _mm_add_ps(sum0, sum1));
+        sum = (partialSums[0] + partialSums[1]) + (partialSums[2] + partialSums[3]);
+#endif
+        for (; frame < numFrames; ++frame)
         {
-            AkUInt16 frame = 0;
-            std::vector<AkReal32>& currentChannel = sharedBuffer[channel];
-            std::vector<AkReal32>& RMSChannel = RMSTable[channel];
-            numFrames = currentChannel.size();
-            // Prepare columns/frames
-            if (RMSChannel.size() < numFrames)
-            {
-                RMSTable[channel].resize(numFrames);
-            }
-            
-            while (frame < numFrames)
-            {
+            sum += pSource[frame] * pSource[frame];
+        }
+        added[channel] = (AkUInt64)(AkMin((double)sum, kEnergyMax) * kEnergyScale + 0.5);
+        slot.energy[channel] += added[channel];
+    }
 
-                AkReal32& currentSample = currentChannel[frame];
-                currentRMS[channel] = sqrtf(
-                    (
-                        (powf(currentRMS[channel], 2) * ((frames10ms * numChannels) - 1)     // a fake sum of previous frames' squares
-                            ) + powf(currentSample, 2)                                      // add square of new sample
-                        ) / (frames10ms * numChannels)                                      // divide by frames to get new average of squares
-                );                                                                          // square root everything
+    slot.energyFrames = AkMax(slot.energyFrames, position + numFrames);
+    addEnergyToPartial(epoch, slot, added, slot.energyFrames);
+}
 
+void SidechainCompressorSharedBuffer::setDetector(AkReal32 windowMs, SidechainDetector::Mode mode)
+{
+    detectorWindowMs.store(windowMs, std::memory_order_relaxed);
+    detectorMode.store(mode, std::memory_order_relaxed);
+}
 
-                RMSChannel[frame] = currentRMS[channel];
-                frame++;
-            }
-        }
+void SidechainCompressorSharedBuffer::setKeyFilter(const SidechainKeyFilter::Settings& in_settings)
+{
+    keyType.store(in_settings.type, std::memory_order_relaxed);
+    keyFrequency.store(in_settings.frequency, std::memory_order_relaxed);
+    keyQ.store(in_settings.q, std::memory_order_relaxed);
+    keyGainDb.store(in_settings.gainDb, std::memory_order_relaxed);
+}
+
+AKRESULT SidechainCompressorSharedBuffer::reserveBands(AkUInt32 numBands)
+{
+    std::lock_guard<std::mutex> lock(mtx);
 
+    numBands = AkMin(numBands, SidechainCrossover::kMaxBands);
+    if (numBands <= bandCapacity.load(std::memory_order_relaxed))
+    {
+        return AK_Success;
+    }
+    while (reducing.exchange(true, std::memory_order_acquire))
+    {
+        std::this_thread::yield();
     }
+    const AKRESULT result = allocateBands(numBands, reducedChannels);
+    reducing.store(false, std::memory_order_release);
+    return result;
+}
 
-    // update lastbuffer_mRMS with above calculations
-    for (AkUInt16 i = 0; i < 2; i++)
+AKRESULT SidechainCompressorSharedBuffer::allocateBands(AkUInt32 numBands, AkUInt32 numChannels)
+{
+    // Under mtx with the reduction held. Either change of layout restarts the bands from
+    // silence, as it does in splitBands.
+    numChannels = AkMax(numChannels, (AkUInt32)1);
+    bandCapacity.store(0, std::memory_order_release);
+    if (bandLanes)
     {
+        AK_PLUGIN_FREE_ALIGN(allocator, bandLanes);
+    }
 
-        lastbuffer_mRMS[i] = currentRMS[i];
+    const AkUInt32 lanes = SidechainCrossover::getLaneCount(numBands, numChannels);
+    bandLanes = (AkReal32*)AK_PLUGIN_ALLOC_ALIGN(allocator, sizeof(AkReal32) * kBandChunk * lanes, kAlignment);
+    if (bandLanes == nullptr || crossover.init(allocator, numChannels, numBands) != AK_Success
+        || bandDetector.init(allocator, lanes, sampleRate) != AK_Success)
+    {
+        return AK_InsufficientMemory;
     }
+    bandChannels = numChannels;
+    bandCapacity.store(numBands, std::memory_order_release);
+    return AK_Success;
+}
 
+void SidechainCompressorSharedBuffer::setBands(AkUInt32 numBands, const AkReal32* in_pFrequencies)
+{
+    for (AkUInt32 i = 0; i + 1 < numBands && i + 1 < SidechainCrossover::kMaxBands; ++i)
+    {
+        requestedFrequencies[i].store(in_pFrequencies[i], std::memory_order_relaxed);
+    }
+    requestedBands.store(numBands, std::memory_order_relaxed);
 }
 
-void SidechainCompressorSharedBuffer::calculatedmRMS(AkUInt32 frames10ms)
+SidechainSnapshot SidechainCompressorSharedBuffer::getSnapshot() const
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    std::vector<AkReal32> currentRMS = { newbuffer_mRMS[0], newbuffer_mRMS[1] };
-    AkUInt16 numChannels = sharedBuffer.size();
-    AkUInt32 numFrames = sharedBuffer[0].size();
+    return snapshots[publishedSnapshot.load(std::memory_order_acquire)];
+}
 
-    // update lastbuffer_mRMS
-    lastbuffer_mRMS[0] = newbuffer_mRMS[0];
-    lastbuffer_mRMS[1] = newbuffer_mRMS[1];
-    
+void SidechainCompressorSharedBuffer::AddToSharedBuffer(AkInt32 slot, AkUInt32 epoch, AkAudioBuffer* sourceBuffer, AkUInt32 offset, AkUInt32 numFrames, AkUInt32 position)
+{
+    if (slot == kInvalidSlot)
+    {
+        return;
+    }
 
-    // calculated new mRMS
-    if (!sharedBuffer.empty())
+    Slot& mySlot = getSlot(slot);
+    if (position >= mySlot.maxFrames)
     {
-        for (AkUInt16 channel = 0; channel < numChannels; ++channel)
-        {
-            AkUInt16 frame = 0;
-            std::vector<AkReal32>& currentChannel = sharedBuffer[channel];
-            numFrames = currentChannel.size();
+        return;
+    }
+    numFrames = AkMin(numFrames, mySlot.maxFrames - position);
+    if (mySlot.contribution == SidechainContribution_BlockEnergy && !needsSamples())
+    {
+        addEnergy(mySlot, epoch, sourceBuffer, offset, numFrames, position);
+        return;
+    }
 
-            while (frame < numFrames)
-            {
+    // The slot keeps the epoch's contribution as a whole; only the new frames go to the sums
+    openSlot(mySlot, epoch);
+    const AkUInt32 written = mySlot.numFrames;
+    const AkUInt32 gapStart = AkMin(written, position);
+    const AkUInt32 sourceChannels = AkMin(mySlot.numChannels, (AkUInt32)sourceBuffer->NumChannels());
 
-                AkReal32& currentSample = currentChannel[frame];
-                currentRMS[channel] = sqrtf(
-                    (
-                        (powf(currentRMS[channel], 2) * ((frames10ms * numChannels) - 1)    // a fake sum of previous frames' squares
-                            ) + powf(currentSample, 2)                                      // add square of new sample
-                        ) / (frames10ms * numChannels)                                      // divide by frames to get new average of squares
-                );                                                                          // square root everything
+    for (AkUInt32 channel = 0; channel < mySlot.numChannels; channel++)
+    {
+        AkReal32* AK_RESTRICT thisChannel = mySlot.block + channel * mySlot.channelStride;
+        for (AkUInt32 frame = gapStart; frame < position; frame++)
+        {
+            thisChannel[frame] = 0.0f;
+        }
 
-                frame++;
+        // A source narrower than the slot leaves its remaining channels silent
+        if (channel >= sourceChannels)
+        {
+            for (AkUInt32 frame = 0; frame < numFrames; frame++)
+            {
+                thisChannel[position + frame] = 0.0f;
             }
+            continue;
+        }
+        const AkReal32* AK_RESTRICT sourceChannel = sourceBuffer->GetChannel(channel) + offset;
+        for (AkUInt32 frame = 0; frame < numFrames; frame++)
+        {
+            thisChannel[position + frame] = sourceChannel[frame];
         }
     }
 
-    // update newbuffer_mRMS
-    newbuffer_mRMS[0] = currentRMS[0];
-    newbuffer_mRMS[1] = currentRMS[1];
+    mySlot.numFrames = AkMax(written, position + numFrames);
+    addToPartial(epoch, mySlot, position, numFrames);
 }
 
-void SidechainCompressorSharedBuffer::resetSharedBuffer()
+void SidechainCompressorSharedBuffer::repeatContribution(AkInt32 slot, AkUInt32 epoch)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    if (numBuffersCalculated >= PriorityMap.size())
+    if (slot == kInvalidSlot)
+    {
+        return;
+    }
+
+    Slot& mySlot = getSlot(slot);
+    if (mySlot.epoch != epoch - 1)
+    {
+        return;
+    }
+    mySlot.epoch = epoch;
+    if (mySlot.numFrames > 0)
+    {
+        addToPartial(epoch, mySlot, 0, mySlot.numFrames);
+    }
+    if (mySlot.energyFrames > 0)
+    {
+        addEnergyToPartial(epoch, mySlot, mySlot.energy, mySlot.energyFrames);
+    }
+}
+
+void SidechainCompressorSharedBuffer::setRank(AkInt32 slot, AkReal32 PriorityRank)
+{
+    if (slot == kInvalidSlot)
     {
-        sharedBuffer.clear();
-        numBuffersCalculated.store(0, std::memory_order_relaxed);
+        return;
     }
-    
+    getRank(slot).store(PriorityRank, std::memory_order_relaxed);
+    ranksChanged.store(true, std::memory_order_release);
 }
 
+SidechainRanks SidechainCompressorSharedBuffer::scanRanks() const
+{
+    // Four independent chains kept in registers so the compares overlap, carried across the
+    // chunks. NaN fails every compare, so an unranked slot neither counts nor moves the spread.
+    const AkUInt32 numSlots = slotHighWater.load(std::memory_order_acquire);
+    AkReal32 lowest0 = INFINITY, lowest1 = INFINITY, lowest2 = INFINITY, lowest3 = INFINITY;
+    AkReal32 highest0 = -INFINITY, highest1 = -INFINITY, highest2 = -INFINITY, highest3 = -INFINITY;
+    AkUInt32 counted0 = 0, counted1 = 0;
+    for (AkUInt32 first = 0; first < numSlots; first += kChunkSlots)
+    {
+        const std::atomic<AkReal32>* ranks = chunks[first / kChunkSlots]->ranks;
+        const AkUInt32 count = AkMin(kChunkSlots, numSlots - first);
+        AkUInt32 index = 0;
+        for (; index + 4 <= count; index += 4)
+        {
+            const AkReal32 rank0 = ranks[index].load(std::memory_order_relaxed);
+            const AkReal32 rank1 = ranks[index + 1].load(std::memory_order_relaxed);
+            const AkReal32 rank2 = ranks[index + 2].load(std::memory_order_relaxed);
+            const AkReal32 rank3 = ranks[index + 3].load(std::memory_order_relaxed);
+            lowest0 = rank0 < lowest0 ? rank0 : lowest0;
+            lowest1 = rank1 < lowest1 ? rank1 : lowest1;
+            lowest2 = rank2 < lowest2 ? rank2 : lowest2;
+            lowest3 = rank3 < lowest3 ? rank3 : lowest3;
+            highest0 = rank0 > highest0 ? rank0 : highest0;
+            highest1 = rank1 > highest1 ? rank1 : highest1;
+            highest2 = rank2 > highest2 ? rank2 : highest2;
+            highest3 = rank3 > highest3 ? rank3 : highest3;
+            counted0 += (rank0 == rank0) + (rank1 == rank1);
+            counted1 += (rank2 == rank2) + (rank3 == rank3);
+        }
+        for (; index < count; ++index)
+        {
+            const AkReal32 rank0 = ranks[index].load(std::memory_order_relaxed);
+            lowest0 = rank0 < lowest0 ? rank0 : lowest0;
+            highest0 = rank0 > highest0 ? rank0 : highest0;
+            counted0 += rank0 == rank0;
+        }
+    }
+
+    SidechainRanks spread;
+    spread.numRanked = counted0 + counted1;
+    if (spread.numRanked > 0)
+    {
+        spread.minRank = AkMin(AkMin(lowest0, lowest1), AkMin(lowest2, lowest3));
+        spread.maxRank = AkMax(AkMax(highest0, highest1), AkMax(highest2, highest3));
+    }
+    return spread;
+}
 
-void SidechainCompressorSharedBuffer::resetRMSTable()
+void SidechainCompressorSharedBuffer::calculatedmRMS()
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    if (numBuffersCalculated >= PriorityMap.size())
+    // Only ever waits on a registration widening the reduction
+    while (reducing.exchange(true, std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    const AkUInt32 epoch = writeEpoch.load(std::memory_order_acquire);
+    const SidechainSnapshot& previous = snapshots[publishedSnapshot.load(std::memory_order_relaxed)];
+    AkUInt32 numFrames = 0;
+
+    // The detector is fed every channel any slot has ever had, so a channel that stops
+    // contributing decays instead of holding its last level.
+    const AkUInt32 numChannels = channelHighWater.load(std::memory_order_acquire);
+
+    // Nothing executes during BeginRender, so every partial of this epoch is complete. Each
+    // one merged is still held until the merge is done, so a slot registered meanwhile cannot
+    // move its block.
+    Partial* contributed[kMaxWorkers];
+    AkUInt32 numContributed = 0;
+    AkUInt64 energy[kMaxChannels] = {};
+    AkUInt32 energyFrames = 0;
+    for (AkUInt32 worker = 0; worker < kMaxWorkers; ++worker)
     {
-        RMSTable.clear();
+        Partial& partial = partials[worker];
+        if (partial.epoch != epoch)
+        {
+            continue;
+        }
+        if (partial.numFrames > 0)
+        {
+            while (partial.busy.exchange(true, std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            contributed[numContributed++] = &partial;
+            numFrames = AkMax(numFrames, partial.numFrames);
+        }
+        if (partial.energyFrames > 0)
+        {
+            for (AkUInt32 channel = 0; channel < kMaxChannels; ++channel)
+            {
+                energy[channel] += partial.energy[channel];
+            }
+            energyFrames = AkMax(energyFrames, partial.energyFrames);
+        }
     }
-    
 
+    // Block energies spread evenly over the frame, as a mean square under every frame's sum
+    AkReal32 energyMeanSquare[kMaxChannels];
+    const AkReal32* pEnergyMeanSquare = nullptr;
+    if (energyFrames > 0)
+    {
+        numFrames = AkMax(numFrames, energyFrames);
+        for (AkUInt32 channel = 0; channel < kMaxChannels; ++channel)
+        {
+            energyMeanSquare[channel] = (AkReal32)((double)energy[channel] / kEnergyScale / numFrames);
+        }
+        pEnergyMeanSquare = energyMeanSquare;
+    }
+
+    // Merged frame-major, numChannels per frame, so the detector runs across channels.
+    // Exact sums: the total is the same whatever the order.
+    AkReal32* AK_RESTRICT pSum = reduced;
+    const AkReal32 fromFixed = 1.0f / kFixedScale;
+    const AkReal64* rows[kMaxWorkers];
+    for (AkUInt32 channel = 0; channel < numChannels; ++channel)
+    {
+        AkUInt32 numRows = 0;
+        for (AkUInt32 i = 0; i < numContributed; ++i)
+        {
+            if (channel < contributed[i]->channels)
+            {
+                rows[numRows++] = contributed[i]->block + (size_t)channel * contributed[i]->stride;
+            }
+        }
+        for (AkUInt32 frame = 0; frame < numFrames; ++frame)
+        {
+            AkReal64 total = 0.0;
+            for (AkUInt32 i = 0; i < numRows; ++i)
+            {
+                total += rows[i][frame];
+            }
+            pSum[(size_t)frame * numChannels + channel] = (AkReal32)total * fromFixed;
+        }
+    }
+    for (AkUInt32 i = 0; i < numContributed; ++i)
+    {
+        contributed[i]->busy.store(false, std::memory_order_release);
+    }
+
+    SidechainSnapshot& next = snapshots[(publishedSnapshot.load(std::memory_order_relaxed) + 1) & 1];
+
+    // The key filter shapes the sum in place, so the full band and every split band hear it
+    SidechainKeyFilter::Settings key;
+    key.type = (SidechainKeyFilter::Type)keyType.load(std::memory_order_relaxed);
+    key.frequency = keyFrequency.load(std::memory_order_relaxed);
+    key.q = keyQ.load(std::memory_order_relaxed);
+    key.gainDb = keyGainDb.load(std::memory_order_relaxed);
+    if (key != keyFilter.getSettings())
+    {
+        keyFilter.setFilter(key, sampleRate);
+    }
+    keyFilter.process(pSum, numChannels, numFrames);
+
+    detector.setWindow(detectorWindowMs.load(std::memory_order_relaxed), (SidechainDetector::Mode)detectorMode.load(std::memory_order_relaxed));
+    detector.process(pSum, numChannels, numFrames, pEnergyMeanSquare);
+
+    // Per-channel lanes, then the linked lanes from the same mean squares
+    AkReal32 current[SidechainSnapshot::kNumLanes] = {};
+    AkReal32 loudest = 0.0f;
+    AkReal32 totalMeanSquare = 0.0f;
+    for (AkUInt32 channel = 0; channel < SidechainSnapshot::kMaxChannels; ++channel)
+    {
+        const AkReal32 meanSquare = channel < numChannels ? detector.getMeanSquare(channel) : 0.0f;
+        current[channel] = sqrtf(meanSquare);
+        loudest = AkMax(loudest, current[channel]);
+        totalMeanSquare += meanSquare;
+    }
+    current[SidechainSnapshot::kLane_LinkedMax] = loudest;
+    current[SidechainSnapshot::kLane_LinkedSum] = sqrtf(totalMeanSquare);
+    const AkUInt32 numBands = splitBands(pSum, numChannels, numFrames, current);
+
+    next.epoch = epoch;
+    next.numChannels = numChannels;
+    next.numBands = numBands;
+    for (AkUInt32 lane = 0; lane < SidechainSnapshot::kNumLanes; ++lane)
+    {
+        next.lastbuffer_mRMS[lane] = previous.newbuffer_mRMS[lane];
+        next.newbuffer_mRMS[lane] = current[lane];
+    }
+
+    // Ranks rarely move: the table is only scanned again when one did
+    next.ranks = ranksChanged.exchange(false, std::memory_order_acquire) ? scanRanks() : previous.ranks;
+
+    // Publish, then open the next epoch for the producers.
+    publishedSnapshot.store((publishedSnapshot.load(std::memory_order_relaxed) + 1) & 1, std::memory_order_release);
+    writeEpoch.store(epoch + 1, std::memory_order_release);
+    reducing.store(false, std::memory_order_release);
 }
 
+AkUInt32 SidechainCompressorSharedBuffer::splitBands(const AkReal32* in_pSum, AkUInt32 numChannels, AkUInt32 numFrames, AkReal32* out_pLanes)
+{
+    const AkUInt32 numBands = AkMin(requestedBands.load(std::memory_order_relaxed), bandCapacity.load(std::memory_order_acquire));
+    if (numBands < 2 || numChannels == 0)
+    {
+        return 0;
+    }
+
+    // New frequencies only move the coefficients; a new layout restarts the bands from silence
+    AkReal32 frequencies[SidechainCrossover::kMaxBands - 1];
+    for (AkUInt32 i = 0; i + 1 < SidechainCrossover::kMaxBands; ++i)
+    {
+        frequencies[i] = requestedFrequencies[i].load(std::memory_order_relaxed);
+    }
+    if (numBands != crossover.getNumBands() || numChannels != crossover.getNumChannels())
+    {
+        bandDetector.reset();
+        crossover.setBands(numBands, numChannels, frequencies, sampleRate);
+        memcpy(appliedFrequencies, frequencies, sizeof(frequencies));
+    }
+    else if (memcmp(frequencies, appliedFrequencies, sizeof(frequencies)) != 0)
+    {
+        crossover.setBands(numBands, numChannels, frequencies, sampleRate);
+        memcpy(appliedFrequencies, frequencies, sizeof(frequencies));
+    }
 
+    // Split a chunk at a time; every band's channels go through the one detector
+    const AkUInt32 lanes = crossover.getNumLanes();
+    bandDetector.setWindow(detectorWindowMs.load(std::memory_order_relaxed), (SidechainDetector::Mode)detectorMode.load(std::memory_order_relaxed));
+    for (AkUInt32 start = 0; start < numFrames; start += kBandChunk)
+    {
+        const AkUInt32 length = AkMin(kBandChunk, numFrames - start);
+        crossover.process(in_pSum + (size_t)start * numChannels, numChannels, bandLanes, length);
+        bandDetector.process(bandLanes, lanes, length);
+    }
 
+    // Each band's lanes as the full band's
+    for (AkUInt32 band = 0; band < numBands; ++band)
+    {
+        AkReal32 loudest = 0.0f;
+        AkReal32 totalMeanSquare = 0.0f;
+        for (AkUInt32 channel = 0; channel < numChannels; ++channel)
+        {
+            const AkReal32 meanSquare = bandDetector.getMeanSquare(band * numChannels + channel);
+            const AkReal32 level = sqrtf(meanSquare);
+            out_pLanes[SidechainSnapshot::getBandLane(band, channel)] = level;
+            loudest = AkMax(loudest, level);
+            totalMeanSquare += meanSquare;
+        }
+        out_pLanes[SidechainSnapshot::getBandLane(band, SidechainSnapshot::kLane_LinkedMax)] = loudest;
+        out_pLanes[SidechainSnapshot::getBandLane(band, SidechainSnapshot::kLane_LinkedSum)] = sqrtf(totalMeanSquare);
+    }
+    return numBands;
+}
@@ -1,111 +1,359 @@
 #pragma once
 
-#include <vector>
-#include <mutex>
-#include <iostream>
-#include <map>
-#include <future>
-#include <chrono>
 #include <atomic>
-#include <string>
-#include <sstream>
-#include <iomanip>
-#include <shared_mutex>
-#include <algorithm>
-#include <thread>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <AK/SoundEngine/Common/AkCommonDefs.h>
 #include <AK/SoundEngine/Common/IAkPlugin.h>
 #include <AK/SoundEngine/Common/AkSoundEngine.h>
 #include <AK/SoundEngine/Common/AkCallback.h>
+#include "SidechainCompressorDetector.h"
+#include "SidechainCompressorCrossover.h"
+#include "SidechainCompressorKeyFilter.h"
+
+
+// How an instance turns the sidechain's channels into detector levels for its own channels.
+enum SidechainChannelLink
+{
+    SidechainChannelLink_Unlinked = 0,  // Channel i is ducked by sidechain channel i
+    SidechainChannelLink_Max = 1,       // Every channel is ducked by the loudest sidechain channel
+    SidechainChannelLink_Sum = 2        // Every channel is ducked by the total power of the sidechain
+};
+
+// What a feeding instance publishes to the bus each audio frame.
+enum SidechainContribution
+{
+    SidechainContribution_Samples = 0,      // Every sample, summed with the other feeders' before detection
+    SidechainContribution_BlockEnergy = 1   // Each channel's sum of squares over the block, a few numbers per instance
+};
+
+// Spread of the priority ranks of every registered instance; enough to turn any rank into
+// a percentile in O(1).
+struct SidechainRanks
+{
+    AkReal32 minRank = 0.0f;
+    AkReal32 maxRank = 0.0f;
+    AkUInt32 numRanked = 0;
+
+    AkReal32 getPercentile(AkReal32 PriorityRank) const; // returns percentile in decimal form. (1.00 = 100%)
+};
+
+// Immutable view of the shared detector, published once per audio frame by the
+// BeginRender callback. epoch is the frame whose contributions were reduced into it:
+// every instance rendering frame N reads the sidechain of frame N - 1, whatever
+// order the instances are rendered in (a constant one-frame latency).
+//
+// Levels are stored per lane: one lane per sidechain channel, then the two linked lanes.
+// The full-band lanes come first, then the same lanes for each band the bus is split into.
+struct SidechainSnapshot
+{
+    static const AkUInt32 kMaxChannels = 16;            // 7.1.4, 3rd order ambisonics
+    static const AkUInt32 kLane_LinkedMax = kMaxChannels;
+    static const AkUInt32 kLane_LinkedSum = kMaxChannels + 1;
+    static const AkUInt32 kLanesPerBand = kMaxChannels + 2;
+    static const AkUInt32 kMaxBands = SidechainCrossover::kMaxBands;
+    static const AkUInt32 kNumLanes = kLanesPerBand * (kMaxBands + 1);
+
+    AkUInt32 epoch = 0;
+    AkUInt32 numChannels = 0;                           // Sidechain channels in use
+    AkUInt32 numBands = 0;                              // Bands split; the lanes of the others are silent
+    AkReal32 lastbuffer_mRMS[kNumLanes] = {};           // The moving RMS at the end of the frame before epoch
+    AkReal32 newbuffer_mRMS[kNumLanes] = {};            // The moving RMS at the end of epoch
 
+    // Priority ranks of the registered instances, taken at the same time, so every
+    // instance rendering this frame ranks itself against the same spread
+    SidechainRanks ranks;
 
+    AkReal32 getPercentile(AkReal32 PriorityRank) const { return ranks.getPercentile(PriorityRank); }
+
+    // Takes, lane by lane, whichever of the two snapshots is louder at the end of its frame
+    void mergeLoudest(const SidechainSnapshot& other);
+
+    // Lane an instance channel reads. Unlinked channels past kMaxChannels fall back to the loudest channel.
+    static AkUInt32 getLane(AkUInt32 channel, SidechainChannelLink link)
+    {
+        if (link == SidechainChannelLink_Sum)
+            return kLane_LinkedSum;
+        if (link == SidechainChannelLink_Max || channel >= kMaxChannels)
+            return kLane_LinkedMax;
+        return channel;
+    }
+
+    // The same lane of one band of a split bus
+    static AkUInt32 getBandLane(AkUInt32 band, AkUInt32 lane) { return (band + 1) * kLanesPerBand + lane; }
+};
+
+// All storage comes from the sound engine's allocator, on the Init/Term path: a few fixed
+// blocks in Init, then in acquireSlot the instance table a chunk at a time, slot contributions,
+// and the partial sums, reduction block and detector history, sized for the widest and longest
+// slot so far. Rendering (AddToSharedBuffer, setRank, calculatedmRMS, getSnapshot) never
+// allocates or searches; stale data is cleared by zeroing.
 class SidechainCompressorSharedBuffer
 {
 public:
-    SidechainCompressorSharedBuffer(std::map<AkUniqueID, AkReal32>& myPriorityMap);
+    SidechainCompressorSharedBuffer(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 sampleRate);
 	~SidechainCompressorSharedBuffer();
 
-    void Init();
+    // Allocates the partial energies, the key filter and an empty detector; everything sized by
+    // the slots is allocated as they arrive.
+    AKRESULT Init();
 
-    std::vector<std::vector<AkReal32>> sharedBuffer;    // 2-d array of Channels (outer vector) and Frames (inner vector)
-    AkUInt16 numBuffersAdded = 0;
-    
-    
-    std::atomic<AkInt16> numBuffersCalculated = 0;
-    std::map<AkUniqueID, AkReal32> PriorityMap;
-    std::vector<std::vector<AkReal32>> RMSTable;        //This is a 2d-array. The outer vector (rows) is numChannels.  The inner vector (columns) is numSamples.
+    static const AkUInt32 kMaxInstances = 16384;
+    static const AkUInt32 kMaxChannels = SidechainSnapshot::kMaxChannels;
+    static const AkUInt32 kMaxFrames = 4096;
+    static const AkInt32 kInvalidSlot = -1;
+    static const AkUInt32 kAlignment = SidechainDetector::kAlignment;
 
+    // Every instance on the bus holds a slot, its handle into the instance table, claimed in
+    // Init and released in Term, never on the audio path. A listener that does not feed asks
+    // for no channels. Each slot has its own contribution block, kept when the slot is
+    // released and only reallocated when a later owner needs more; the partial sums grow
+    // with the widest slot. Channels past kMaxChannels do not feed the sidechain.
+    //
+    // A block energy slot is summed as power: the bus adds its mean square to every frame's
+    // detector input instead of adding its samples to the sum, so sources are taken as
+    // uncorrelated and the level is steady over each block. While the bus needs the summed
+    // samples (needsSamples), it contributes samples like any other slot.
+    AkInt32 acquireSlot(AkUInt32 numChannels, AkUInt32 maxFrames, SidechainContribution contribution = SidechainContribution_Samples);
+    void releaseSlot(AkInt32 slot);
 
-    std::string errorMsg = "Default Error Message";
-    AkReal32 lastbuffer_mRMS[2] = { 0.0f, 0.0f };       // The moving RMS of the last L and R samples of the previous buffer
-    AkReal32 newbuffer_mRMS[2] = { 0.0f, 0.0f };
-    AkReal32 diff_mRMS[2] = { 0.0f, 0.0f };
-    AkReal32 lastRMSAdded[2] = { 0.1f, 0.1f };
+    // Detector window for the whole bus. Instances push their setting on Init and when it
+    // changes; the last one written is applied by the next reduction.
+    void setDetector(AkReal32 windowMs, SidechainDetector::Mode mode);
 
-    void resizeSharedBuffer(AkAudioBuffer* sourceBuffer);
+    // Key filter over the summed sidechain, ahead of the detector and the band split. Pushed
+    // like the detector window: the next reduction applies the last one written.
+    void setKeyFilter(const SidechainKeyFilter::Settings& in_settings);
 
+    // Band split for listeners ducked per band. reserveBands allocates the crossover and the
+    // band detector on the Init path, for up to numBands of the channels registered so far,
+    // and acquireSlot widens them with the widest slot; the split itself is pushed like the
+    // detector window, and the next reduction applies the last one written, up to what was
+    // reserved. Listeners of one group are expected to agree on it.
+    AKRESULT reserveBands(AkUInt32 numBands);
+    void setBands(AkUInt32 numBands, const AkReal32* in_pFrequencies);
 
-    void AddToSharedBuffer(AkAudioBuffer* sourceBuffer);
-
-    void AddToPriorityMap(AkUniqueID objectID, AkReal32 PriorityRank);
+    // True while a key filter or a band split is asked for: both work on the summed samples,
+    // which block energy does not give them.
+    bool needsSamples() const
+    {
+        return keyType.load(std::memory_order_relaxed) != SidechainKeyFilter::Type_Off
+            || AkMin(requestedBands.load(std::memory_order_relaxed), bandCapacity.load(std::memory_order_relaxed)) > 1;
+    }
 
-    void updatePriorityMap(AkUniqueID objectID, AkReal32 PriorityRank);
+    AkUInt32 getWriteEpoch() const { return writeEpoch.load(std::memory_order_acquire); }
 
-    void removeFromPriorityMap(AkUniqueID objectID);
+    // The engine's rate; the detector and every instance on the bus must run at it
+    AkUInt32 getSampleRate() const { return sampleRate; }
 
+    SidechainSnapshot getSnapshot() const;
 
+    // Copies numFrames of this instance's input, from offset, into its own slot for the given
+    // epoch, at position frames into the audio frame. An instance may contribute any length,
+    // in several calls per epoch; frames it skipped over are silence, so a partial or late
+    // buffer sums time-aligned with the others. A block energy slot only adds up the squares.
+    // Safe from any number of worker threads.
+    void AddToSharedBuffer(AkInt32 slot, AkUInt32 epoch, AkAudioBuffer* sourceBuffer, AkUInt32 offset, AkUInt32 numFrames, AkUInt32 position);
 
-    float getPercentile(AkUniqueID objectID);           // returns percentile in decimal form. (1.00 = 100%)
+    // Contributes the slot's previous epoch again, for an instance whose voice is virtual.
+    // Does nothing if the slot did not contribute to the previous epoch.
+    void repeatContribution(AkInt32 slot, AkUInt32 epoch);
 
-    void populateRMSTable(AkUInt32 frames10ms);         // Intended to be used per buffer. frames10ms is 10 ms worth of frames. RMS is in linear
+    // Ranks the slot's instance on the bus, or moves its rank. A single store, safe from the
+    // audio thread; the next reduction takes it. A released slot is unranked.
+    void setRank(AkInt32 slot, AkReal32 PriorityRank);
 
-    void calculatedmRMS(AkUInt32 frames10ms);
+    // Merges the partial sums of the current epoch, runs the detector over the total,
+    // publishes the result and the priority ranks as the next snapshot and opens the next epoch.
+    // Called once per audio frame from GlobalManager's BeginRender callback.
+    void calculatedmRMS();
 
-    void resetRMSTable();
-    void resetSharedBuffer();
+    // Frames rounded up so every channel of a block starts on kAlignment
+    static AkUInt32 alignFrames(AkUInt32 numFrames)
+    {
+        const AkUInt32 align = kAlignment / sizeof(AkReal32);
+        return (numFrames + align - 1) / align * align;
+    }
 
 private:
-    
-    std::mutex mtx; 
-    std::shared_mutex s_mtx;
-  
-};
+    // An instance's latest contribution, kept so TimeSkip can contribute it again. Only its
+    // owner touches it once acquired.
+    struct Slot
+    {
+        bool active = false;
+        AkUInt32 epoch = ~0u;                           // Epoch the block holds
+        AkUInt32 numChannels = 0;
+        AkUInt32 maxFrames = 0;
+        AkUInt32 channelStride = 0;                     // maxFrames, aligned
+        AkUInt32 numFrames = 0;                         // End of the last frame written
+        AkUInt32 energyFrames = 0;                      // End of the last frame contributed as energy
+        SidechainContribution contribution = SidechainContribution_Samples;
+        AkReal32* block = nullptr;                      // Channel-major, numChannels * channelStride
+        AkUInt64* energy = nullptr;                     // Per channel, fixed point, the epoch's so far; after the samples in block
+        size_t blockSize = 0;                           // Floats allocated, may exceed what the owner uses
+    };
 
-class GlobalManager
-{
-public:
+    static const AkUInt32 kMaxWorkers = 16;
 
-    static std::shared_ptr<SidechainCompressorSharedBuffer>& getGlobalBuffer(std::map<AkUniqueID, AkReal32>& myPriorityMap)
+    // Per-worker partial sums of one epoch's contributions. A contributor claims whichever
+    // partial is free, starting from its thread's own, so with up to kMaxWorkers rendering
+    // threads nobody waits; the render callback merges the partials of the epoch. Samples
+    // are quantized to a fixed-point grid and summed as integer-valued doubles, which is
+    // exact, so the total is the same whichever worker summed what, in whichever order.
+    //
+    // Block energies are summed the same way, as fixed-point integers: unsigned sums wrap
+    // instead of rounding, so they are exact in any order too.
+    //
+    // Each partial carries its own layout, replaced together with its block while it is
+    // held, so whoever holds it reads a block and a layout that belong together.
+    struct Partial
     {
-        static std::shared_ptr<SidechainCompressorSharedBuffer> g_ptr = std::make_shared<SidechainCompressorSharedBuffer>(myPriorityMap);
-        return g_ptr;
-    }
+        std::atomic<bool> busy = false;
+        AkUInt32 epoch = ~0u;                           // Epoch the sums belong to
+        AkUInt32 numFrames = 0;                         // Past it every sum is zero
+        AkUInt32 energyFrames = 0;                      // Frames the energies span
+        AkUInt32 channels = 0;                          // Rows in block
+        AkUInt32 stride = 0;                            // Doubles per row
+        AkReal64* block = nullptr;                      // Channel-major, channels * stride
+        AkUInt64* energy = nullptr;                     // kMaxChannels
+        AkUInt8 pad[64 - 5 * sizeof(AkUInt32) - 3 * sizeof(void*)];   // One cache line each
+    };
+    static constexpr AkReal32 kFixedScale = 1048576.0f; // 2^20: one step is -120 dBFS
+    static constexpr AkReal32 kFixedMax = 2047.0f;      // Samples are clamped so a quantized sample fits 32 bits
+    static constexpr double kEnergyScale = 4294967296.0;        // 2^32: a step is a mean square of -120 dBFS over 256 frames
+    static constexpr double kEnergyMax = 2147483648.0;          // A contribution is clamped so it fits 63 bits
 
-};
+    Partial& claimPartial(AkUInt32 epoch);
+    void addToPartial(AkUInt32 epoch, const Slot& slot, AkUInt32 start, AkUInt32 numFrames);
+    void addEnergyToPartial(AkUInt32 epoch, const Slot& slot, const AkUInt64* in_pEnergy, AkUInt32 numFrames);
 
-class SpinLock
-{
-private:
-    std::atomic_flag locked = ATOMIC_FLAG_INIT;
+    // Starts the slot's contributions over when epoch is a new one
+    void openSlot(Slot& slot, AkUInt32 epoch);
 
-public:
-    void timedLock() {
-        using namespace std::chrono;
-        auto startTime = steady_clock::now();
-        AkUInt16 timeout = 50; // timeout in miliseconds
+    // Sums the squares of numFrames of the source into the slot's energies, and the partials
+    void addEnergy(Slot& slot, AkUInt32 epoch, AkAudioBuffer* sourceBuffer, AkUInt32 offset, AkUInt32 numFrames, AkUInt32 position);
+    AKRESULT growPartials(AkUInt32 numChannels, AkUInt32 stride);
 
-        while (locked.test_and_set(std::memory_order_acquire)) 
-        {
-            std::this_thread::yield();
+    // Widens the reduction block, the detector and the band split for numChannels and
+    // lengthens the block for stride frames, holding the reduction while they move
+    AKRESULT growReduction(AkUInt32 numChannels, AkUInt32 stride);
+    AKRESULT allocateBands(AkUInt32 numBands, AkUInt32 numChannels);
+
+    AK::IAkPluginMemAlloc* allocator;
+    AkUInt32 sampleRate;
 
-            if (duration_cast<milliseconds>(steady_clock::now() - startTime).count() > timeout)
+    // Spread of the ranked slots, scanned by the reduction after any rank changed
+    SidechainRanks scanRanks() const;
+
+    // Instance table, indexed by slot, in chunks allocated under mtx as the table grows and
+    // never moved, so a handle stays valid on every thread while the table grows. Within a
+    // chunk the ranks are kept apart from the slots so the reduction scans contiguous arrays;
+    // an unranked slot holds NaN.
+    static const AkUInt32 kChunkSlots = 64;
+    struct SlotChunk
+    {
+        SlotChunk()
+        {
+            for (std::atomic<AkReal32>& rank : ranks)
             {
-                break;
+                rank.store(NAN, std::memory_order_relaxed);
             }
         }
-    }
 
-    void unlock() {
-        locked.clear(std::memory_order_release);
-    }
+        Slot slots[kChunkSlots];
+        std::atomic<AkReal32> ranks[kChunkSlots];
+        AkInt32 freeSlots[kChunkSlots];                 // This chunk's share of the stack of released slots
+    };
+    SlotChunk* chunks[kMaxInstances / kChunkSlots] = {};
+    AkUInt32 numFreeSlots = 0;                          // Under mtx
+
+    Slot& getSlot(AkInt32 slot) { return chunks[slot / kChunkSlots]->slots[slot % kChunkSlots]; }
+    std::atomic<AkReal32>& getRank(AkInt32 slot) { return chunks[slot / kChunkSlots]->ranks[slot % kChunkSlots]; }
+    AkInt32& getFreeSlot(AkUInt32 i) { return chunks[i / kChunkSlots]->freeSlots[i % kChunkSlots]; }
+    std::atomic<AkUInt32> slotHighWater = 0;            // Past it no slot was ever handed out
+    std::atomic<bool> ranksChanged = false;             // Set by every rank write, taken by the reduction
+
+    Partial partials[kMaxWorkers];
+    AkUInt64* partialEnergy = nullptr;                  // Every partial's energies, kMaxWorkers * kMaxChannels
+    AkUInt32 partialChannels = 0;                       // Layout the partials are grown to, under mtx
+    AkUInt32 partialStride = 0;
+    std::atomic<AkUInt32> channelHighWater = 0;         // Widest slot registered so far, never shrinks
+    std::atomic<AkUInt32> writeEpoch = 0;
+
+    // Held by the render callback for the whole reduction, and by acquireSlot while it widens
+    // what the reduction works on
+    std::atomic<bool> reducing = false;
+
+    AkReal32* reduced = nullptr;                        // Frame-major sum, reducedFrames * reducedChannels
+    AkUInt32 reducedChannels = 0;                       // Also the detector's, grown under mtx
+    AkUInt32 reducedFrames = 0;
+
+    SidechainDetector detector;                         // Only touched by the render callback
+    std::atomic<AkReal32> detectorWindowMs;
+    std::atomic<AkInt32> detectorMode;
+
+    SidechainKeyFilter keyFilter;                       // Only touched by the render callback
+    std::atomic<AkInt32> keyType;
+    std::atomic<AkReal32> keyFrequency;
+    std::atomic<AkReal32> keyQ;
+    std::atomic<AkReal32> keyGainDb;
+
+    // Band split of the sum, a chunk at a time, and every channel of every band as one
+    // detector's channels. Only touched by the render callback once reserved.
+    static const AkUInt32 kBandChunk = 256;
+    SidechainCrossover crossover;
+    SidechainDetector bandDetector;
+    AkReal32* bandLanes = nullptr;                      // kBandChunk frames of the crossover's lanes
+    std::atomic<AkUInt32> bandCapacity = 0;             // Bands reserved
+    AkUInt32 bandChannels = 0;                          // Channels reserved, under mtx
+    std::atomic<AkUInt32> requestedBands = 1;
+    std::atomic<AkReal32> requestedFrequencies[SidechainCrossover::kMaxBands - 1];
+    AkReal32 appliedFrequencies[SidechainCrossover::kMaxBands - 1] = {};
+
+    // Splits the frame-major sum and writes each band's lanes into out_pLanes; returns the bands split
+    AkUInt32 splitBands(const AkReal32* in_pSum, AkUInt32 numChannels, AkUInt32 numFrames, AkReal32* out_pLanes);
+
+    SidechainSnapshot snapshots[2];
+    std::atomic<AkUInt32> publishedSnapshot = 0;
+
+    std::mutex mtx;                                     // Slot registration only
+};
+
+// Owns the sidechain buses of each sound engine, one per group in use. Groups are
+// independent: an instance only contends with, sums with and ranks against the instances
+// of the groups it feeds or listens to. The first bus created on an engine registers the
+// per-frame reduction on its global context and the last one released unregisters it, so
+// the reduction runs exactly once per audio frame for every live group.
+class GlobalManager
+{
+public:
+    static const AkUInt32 kMaxGroups = 16;
+    static const AkUInt32 kAllGroups = (1u << kMaxGroups) - 1;
+
+    static std::shared_ptr<SidechainCompressorSharedBuffer> acquireBuffer(AK::IAkGlobalPluginContext* in_pGlobalContext, AkUInt32 in_uGroup);
+    static void releaseBuffer(AK::IAkGlobalPluginContext* in_pGlobalContext, AkUInt32 in_uGroup);
+
+private:
+    struct Engine
+    {
+        std::shared_ptr<SidechainCompressorSharedBuffer> buffers[kMaxGroups];
+        AkUInt32 refCounts[kMaxGroups] = {};
+        AkUInt32 totalRefCount = 0;
+
+        // What the render callback walks. Plug-in Init/Term and the global callbacks all run
+        // on the audio thread, so a bus is never retired while it is being reduced.
+        std::atomic<SidechainCompressorSharedBuffer*> live[kMaxGroups] = {};
+    };
+
+    static const AkUInt32 kCallbackLocations = AkGlobalCallbackLocation_BeginRender | AkGlobalCallbackLocation_Term;
+
+    static std::mutex& enginesMutex();
+    static std::map<AK::IAkGlobalPluginContext*, std::unique_ptr<Engine>>& engines();
+
+    static void AKSOUNDENGINE_CALL GlobalCallback(
+        AK::IAkGlobalPluginContext* in_pContext,
+        AkGlobalCallbackLocation in_eLocation,
+        void* in_pCookie);
 };
@@ -38,8 +38,30 @@ SidechainCompressorPlugin::~SidechainCompressorPlugin()
 
 bool SidechainCompressorPlugin::GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const
 {
-    // Write bank data here
-    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Placeholder"));
+    // Write bank data here, in the order SidechainCompressorFXParams::SetParamsBlock reads it
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Threshold"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "MaxRatio"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "PriorityRank"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "ControlRate"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "RMSWindow"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "DetectorMode"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "ChannelLink"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "FeedGroups"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "ListenGroups"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "MonitorRate"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Lookahead"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Attack"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Release"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CurveTableStep"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "NumBands"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Crossover1"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Crossover2"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Crossover3"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "KeyFilter"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "KeyFrequency"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "KeyQ"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "KeyGain"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "Contribution"));
 
     return true;
 }
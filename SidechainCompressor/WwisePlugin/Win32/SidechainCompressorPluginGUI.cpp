@@ -25,6 +25,8 @@ the specific language governing permissions and limitations under the License.
 *******************************************************************************/
 
 #include "SidechainCompressorPluginGUI.h"
+#include "../../SoundEnginePlugin/SidechainCompressorMonitorData.h"
+#include <cmath>
 
 SidechainCompressorPluginGUI::SidechainCompressorPluginGUI()
 {
@@ -62,19 +64,38 @@ bool SidechainCompressorPluginGUI::WindowProc(AK::Wwise::Plugin::eDialog in_eDia
 
 void SidechainCompressorPluginGUI::NotifyMonitorData(AkTimeMs in_iTimeStamp, const AK::Wwise::Plugin::MonitorData* in_pMonitorDataArray, unsigned int in_uMonitorDataArraySize, bool in_bIsRealtime)
 {
-    if (m_hwndPropView != NULL &&
-        in_pMonitorDataArray != nullptr)
+    if (m_hwndPropView == NULL || in_pMonitorDataArray == nullptr || in_uMonitorDataArraySize == 0)
     {
-        auto* serializedData = (std::string*) in_pMonitorDataArray->pData;
-
-        HWND DlgLabel1 = ::GetDlgItem(m_hwndPropView, IDC_DATA1);
-        ::SetWindowTextA(DlgLabel1, serializedData[0].c_str());
+        return;
+    }
 
-        HWND DlgLabel2 = ::GetDlgItem(m_hwndPropView, IDC_DATA2);
-        ::SetWindowTextA(DlgLabel2, serializedData[1].c_str());
+    // Several instances may share this GUI; show the last one posted
+    const AK::Wwise::Plugin::MonitorData& monitorData = in_pMonitorDataArray[in_uMonitorDataArraySize - 1];
+    const SidechainMonitorPacket* pPacket = SidechainMonitorPacket::read(monitorData.pData, monitorData.uDataSize);
+    if (pPacket == nullptr)
+    {
+        return;
+    }
 
+    auto toDB = [](AkReal32 lin) { return 20.0f * log10f(AkMax(lin, 1.0e-12f)); };
 
+    std::ostringstream data1, data2;
+    data1 << std::fixed << std::setprecision(2) << "Sidechain (dB): ";
+    data2 << std::fixed << std::setprecision(2) << "Gain (dB): ";
+    for (AkUInt32 i = 0; i < pPacket->uNumChannels; ++i)
+    {
+        data1 << (i > 0 ? ", " : "") << toDB(pPacket->fSidechainRMS[i]);
+        data2 << (i > 0 ? ", " : "") << toDB(pPacket->fGain[i]);
     }
+    data2 << "   Rank: " << std::setprecision(0) << pPacket->fPercentile * 100.0f << "% of " << pPacket->uNumInstances
+        << ", ratio " << std::setprecision(2) << pPacket->fRatio << ":1"
+        << "   Latency: " << pPacket->uLatencyFrames << " frames";
+
+    HWND DlgLabel1 = ::GetDlgItem(m_hwndPropView, IDC_DATA1);
+    ::SetWindowTextA(DlgLabel1, data1.str().c_str());
+
+    HWND DlgLabel2 = ::GetDlgItem(m_hwndPropView, IDC_DATA2);
+    ::SetWindowTextA(DlgLabel2, data2.str().c_str());
 }
 
 ADD_AUDIOPLUGIN_CLASS_TO_CONTAINER(